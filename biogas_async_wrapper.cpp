@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ * 
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/async_task.cpp"
+
+extern "C" {
+
+/**
+ * Getter method for the status of an asynchronous task
+ * 
+ * If the task finished succesfully, its result is published
+ * by this call and can be read with the usual getter methods.
+ * 
+ * @param ticket: Ticket returned by e.g. readOutputFilesAsync()
+ * @return 0: Running, 1: Done, 2: Failed, 3: Cancelled, -1: Unknown ticket
+ */
+int getAsyncStatus(int ticket)
+{
+	std::shared_ptr<AsyncTask> task = findAsyncTask(ticket);
+	if(task == nullptr)
+		return -1;
+	return task->getStatus();
+}
+
+/**
+ * Getter method for the progress of an asynchronous task
+ * 
+ * @param ticket: Ticket returned by e.g. readOutputFilesAsync()
+ * @return Progress in percent or -1 for an unknown ticket
+ */
+int getAsyncProgress(int ticket)
+{
+	std::shared_ptr<AsyncTask> task = findAsyncTask(ticket);
+	if(task == nullptr)
+		return -1;
+	return task->control.progress;
+}
+
+/**
+ * Cancels an asynchronous task
+ * 
+ * The task stops at its next step, the previous data stays available.
+ * 
+ * @param ticket: Ticket returned by e.g. readOutputFilesAsync()
+ */
+void cancelAsync(int ticket)
+{
+	std::shared_ptr<AsyncTask> task = findAsyncTask(ticket);
+	if(task != nullptr)
+		task->cancel();
+}
+
+/**
+ * Blocks until an asynchronous task is finished
+ * 
+ * @param ticket: Ticket returned by e.g. readOutputFilesAsync()
+ * @return The final status (see getAsyncStatus())
+ */
+int waitAsync(int ticket)
+{
+	std::shared_ptr<AsyncTask> task = findAsyncTask(ticket);
+	if(task == nullptr)
+		return -1;
+	task->wait();
+	return task->getStatus();
+}
+
+/**
+ * Releases an asynchronous task
+ * 
+ * A running task is cancelled first. The ticket is invalid afterwards.
+ * 
+ * @param ticket: Ticket returned by e.g. readOutputFilesAsync()
+ */
+void releaseAsync(int ticket)
+{
+	releaseAsyncTask(ticket);
+}
+
+} //end extern "C" 
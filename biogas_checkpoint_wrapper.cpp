@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/checkpoint_store.cpp"
+#include <memory>
+#include <algorithm>
+
+static std::shared_ptr<CheckpointStore> checkpointStore(new CheckpointStore());
+static std::string checkpointIds = "";
+
+extern "C" {
+
+/**
+ * Adds the ug4 checkpoints of a directory to its checkpoint store
+ *
+ * The store "myCheckpoint.ug4store" in the directory keeps every
+ * keyframeInterval-th checkpoint in full and the others as compressed
+ * difference to the previous ones. Checkpoints already in the store are
+ * skipped, so it can be called repeatedly while a run is writing new
+ * checkpoints. The store stays open for the functions below.
+ *
+ * @param directory: Directory of the myCheckpoint*.ug4vec files
+ * @param keyframeInterval: Number of checkpoints from one full vector to the next
+ * @param removeOriginals: Bool if the .ug4vec files are deleted once they are stored
+ * @return Number of added checkpoints or -1 if the store could not be opened
+ */
+int convertCheckpoints(const char* directory, int keyframeInterval, bool removeOriginals)
+{
+	checkpointStore.reset(new CheckpointStore());
+	checkpointStore->keyframeInterval = std::max(1, keyframeInterval);
+	return checkpointStore->convert(directory, removeOriginals);
+}
+
+/**
+ * Opens a checkpoint store
+ *
+ * @param filename: The store (e.g. "myCheckpoint.ug4store")
+ * @return Bool if the store could be read
+ */
+bool openCheckpointStore(const char* filename)
+{
+	checkpointStore.reset(new CheckpointStore());
+	return checkpointStore->open(filename, checkpointStore->keyframeInterval);
+}
+
+/**
+ * Getter method for the number of stored checkpoints
+ *
+ * @return Number of checkpoints
+ */
+int getCheckpointCount()
+{
+	return (int) checkpointStore->records.size();
+}
+
+/**
+ * Getter method for the ids of the stored checkpoints
+ *
+ * @return Ids of all checkpoints, one per line, in the order they were stored
+ */
+const char* getCheckpointIds()
+{
+	checkpointIds = "";
+	for(const CheckpointRecord& record : checkpointStore->records)
+		checkpointIds += record.id + "\n";
+	return checkpointIds.c_str();
+}
+
+/**
+ * Getter method for the size of a stored checkpoint
+ *
+ * @param index: Index of the checkpoint
+ * @return Number of doubles or -1 if there is no such checkpoint
+ */
+long long getCheckpointLength(int index)
+{
+	if(index < 0 || index >= (int) checkpointStore->records.size())
+		return -1;
+	return (long long) checkpointStore->records[index].size;
+}
+
+/**
+ * Reconstructs a stored checkpoint
+ *
+ * Reading checkpoints in ascending order is fastest.
+ *
+ * @param index: Index of the checkpoint
+ * @param values: Array for the values
+ * @param maxSize: Size of the array
+ * @return Number of values written or -1 if the checkpoint could not be read
+ */
+int readCheckpoint(int index, double* values, int maxSize)
+{
+	std::vector<double> vector;
+	if(!checkpointStore->read(index, vector))
+		return -1;
+	int size = std::min((int) vector.size(), maxSize);
+	std::copy(vector.begin(), vector.begin() + size, values);
+	return size;
+}
+
+/**
+ * Writes a stored checkpoint as myCheckpoint<id>.ug4vec and myCheckpoint.lua
+ *
+ * ug4 restarts from the written files as from its own checkpoints.
+ *
+ * @param index: Index of the checkpoint
+ * @param directory: Directory of the files
+ * @return Bool if the files could be written
+ */
+bool restoreCheckpoint(int index, const char* directory)
+{
+	return checkpointStore->restore(index, directory);
+}
+
+/**
+ * Getter method for the compression of the store
+ *
+ * @return Size of all checkpoints as .ug4vec files divided by the size of the store
+ */
+double getCheckpointCompression()
+{
+	return (double) checkpointStore->originalBytes() / checkpointStore->storedBytes();
+}
+
+} //end extern "C"
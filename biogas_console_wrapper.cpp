@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/console_capture.cpp"
+
+extern "C" {
+
+/**
+ * Starts a process and captures its console output
+ *
+ * Replaces reading the output of ugshell in LabView: stdout and
+ * stderr are read on a background thread into a ring of fixed size,
+ * so the memory stays constant for arbitrarily long runs. New lines
+ * are fetched with fetchConsoleLines().
+ *
+ * @param commandline: The command line (e.g. "ugshell -ex Biogas.lua -p spec.lua")
+ * @param workingDir: Working directory of the process ("" for the current one)
+ * @param capacityKB: Size of the ring in KB
+ * @param maxLines: Number of lines kept in the ring
+ * @param progressPattern: Text in front of the simulated time in the
+ * output (e.g. "current time:", "" to disable)
+ * @return Handle of the process or -1 if it could not be started
+ */
+int startConsoleProcess(const char* commandline, const char* workingDir, int capacityKB, int maxLines,
+	const char* progressPattern)
+{
+	ConsoleCapture* capture = new ConsoleCapture();
+	capture->progressPattern = progressPattern;
+	if(!capture->start(commandline, workingDir, capacityKB * 1024, maxLines))
+	{
+		delete capture;
+		return -1;
+	}
+	return addConsoleCapture(capture);
+}
+
+/**
+ * Fetches the lines written since a cursor
+ *
+ * The lines are read with getConsoleLines(). Lines which were
+ * dropped from the ring before they were fetched are skipped
+ * (see getConsoleLostLines()).
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @param cursor: 0 for the first call, afterwards the returned cursor
+ * @param maxLines: Maximal number of lines
+ * @return The cursor for the next call or -1 for an unknown handle
+ */
+long long fetchConsoleLines(int handle, long long cursor, int maxLines)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	if(capture == nullptr)
+		return -1;
+	return (long long) capture->fetchLines(cursor < 0 ? 0 : cursor, maxLines);
+}
+
+/**
+ * Getter method for the lines of the last fetchConsoleLines()
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return The lines, each terminated by '\n' (valid until the next
+ * fetchConsoleLines() or releaseConsoleProcess())
+ */
+const char* getConsoleLines(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	if(capture == nullptr)
+		return "";
+	return capture->lines.c_str();
+}
+
+/**
+ * Getter method for the number of lines written by the process
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return Number of complete lines since the start
+ */
+long long getConsoleLineCount(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	return capture == nullptr ? 0 : (long long) capture->lineCount();
+}
+
+/**
+ * Getter method for the number of lines never fetched
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return Number of lines dropped from the ring before they were fetched
+ */
+long long getConsoleLostLines(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	return capture == nullptr ? 0 : (long long) capture->lostLines();
+}
+
+/**
+ * Defines the simulated time span for getConsoleProgress()
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @param startTime: Start time of the simulation (sim_starttime)
+ * @param endTime: End time of the simulation (sim_endtime)
+ */
+void setConsoleTimeSpan(int handle, double startTime, double endTime)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	if(capture == nullptr)
+		return;
+	capture->startTime = startTime;
+	capture->endTime = endTime;
+}
+
+/**
+ * Getter method for the simulated time of the process
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return The time of the last progress line or NaN if there was none
+ */
+double getConsoleSimulatedTime(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	if(capture == nullptr)
+		return std::numeric_limits<double>::quiet_NaN();
+	return capture->getSimulatedTime();
+}
+
+/**
+ * Getter method for the progress of the process
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return Progress in percent (see setConsoleTimeSpan()) or -1 if unknown
+ */
+int getConsoleProgress(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	return capture == nullptr ? -1 : capture->getProgress();
+}
+
+/**
+ * Getter method for the exit code of the process
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ * @return -1 while running, the exit code or 128+n if it was killed by signal n
+ */
+int getConsoleExitCode(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	return capture == nullptr ? -1 : capture->getExitCode();
+}
+
+/**
+ * Terminates the process
+ *
+ * The output stays available until releaseConsoleProcess() is called.
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ */
+void stopConsoleProcess(int handle)
+{
+	std::shared_ptr<ConsoleCapture> capture = findConsoleCapture(handle);
+	if(capture != nullptr)
+		capture->stop();
+}
+
+/**
+ * Releases a process
+ *
+ * A running process is killed. The handle is invalid afterwards.
+ *
+ * @param handle: Handle returned by startConsoleProcess()
+ */
+void releaseConsoleProcess(int handle)
+{
+	removeConsoleCapture(handle);
+}
+
+} //end extern "C"
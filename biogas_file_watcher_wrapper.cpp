@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/file_watcher.cpp"
+#include "common/versioned_store.h"
+
+static VersionedStore<FileEvent> fileEvents;
+
+extern "C" {
+
+/**
+ * Starts watching a run directory
+ *
+ * Replaces polling: changes of the output files and of all loaded
+ * specification and validation files (see readLUATable()) are
+ * queued as events, so the data only has to be read again (e.g. with
+ * updateOutputData() or readLUATable()) when nextFileEvent() reports
+ * a change. A previous watcher is stopped.
+ *
+ * @param outputDir: The output directory of the run
+ * @param coalesceMs: Time to collect changes before they are queued in milliseconds
+ * @return Bool if the directory could be watched
+ */
+bool startFileWatcher(const char* outputDir, int coalesceMs)
+{
+	std::shared_ptr<FileWatcher> watcher(new FileWatcher());
+	watcher->coalesceTime = std::max(0, coalesceMs);
+	if(!watcher->start(outputDir))
+		return false;
+	setFileWatcher(watcher);
+	return true;
+}
+
+/**
+ * Watches an additional specification or validation file
+ *
+ * @param filename: The path to the file
+ * @return Bool if the file could be watched
+ */
+bool watchSpecFile(const char* filename)
+{
+	std::shared_ptr<FileWatcher> watcher = getFileWatcher();
+	return watcher && watcher->watchFile(filename);
+}
+
+/**
+ * Takes the oldest change
+ *
+ * The path of the file is read with getFileEventPath(). It stays
+ * available after the watcher is stopped.
+ *
+ * @return -1: No change, 0: Changes were lost (read everything again),
+ * 1: Rows appended to an output file, 2: Output file created,
+ * 3: Checkpoint written, 4: Specification or validation file modified
+ */
+int nextFileEvent()
+{
+	std::shared_ptr<FileWatcher> watcher = getFileWatcher();
+	std::shared_ptr<FileEvent> event = std::make_shared<FileEvent>();
+	int type = watcher ? watcher->next(*event) : -1;
+	if(type >= 0)
+		fileEvents.publish(event);
+	return type;
+}
+
+/**
+ * Getter method for the file of the last nextFileEvent()
+ *
+ * The string stays valid until the calling thread reads the path again.
+ *
+ * @return The absolute path to the file ("" if no event was taken)
+ */
+const char* getFileEventPath()
+{
+	return fileEvents.read().path.c_str();
+}
+
+/**
+ * Getter method for the number of changes of the last nextFileEvent()
+ *
+ * @return Number of changes merged into the event
+ */
+int getFileEventCount()
+{
+	return fileEvents.read().count;
+}
+
+/**
+ * Getter method for the number of queued changes
+ *
+ * @return Number of events
+ */
+int getPendingFileEvents()
+{
+	std::shared_ptr<FileWatcher> watcher = getFileWatcher();
+	return watcher ? watcher->pending() : 0;
+}
+
+/**
+ * Stops watching
+ */
+void stopFileWatcher()
+{
+	setFileWatcher(nullptr);
+}
+
+} //end extern "C"
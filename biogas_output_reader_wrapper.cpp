@@ -10,8 +10,66 @@
  */
 
 #include "output_reader/biogas_output_reader.cpp"
+#include "common/async_task.h"
+#include "common/versioned_store.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <limits>
 
 static BiogasOutputReader* biogasOutputReader;
+static std::mutex outputWriterMutex;
+static VersionedStore<OutputSnapshot> outputSnapshots;
+static std::shared_ptr<SteadyStateMonitor> steadyStateMonitor;
+static VersionedStore<RunAnalytics> runAnalytics;
+static VersionedStore<RunDensity> runDensity;
+static VersionedStore<SurrogateModel> surrogateModel;
+static VersionedStore<std::string> surrogateInputs;
+static VersionedStore<std::string> surrogateSuggestions;
+
+/**
+ * Publish the current data of "biogasOutputReader" as new version
+ *
+ * Has to be called with "outputWriterMutex" locked.
+ *
+ * @param request: Name of a series to add to the version ("" for none)
+ * @param keepSeries: Bool if the series of the previous version are kept
+ * @return The new version
+ */
+static std::shared_ptr<const OutputSnapshot> publishOutput(std::string request = "", bool keepSeries = true)
+{
+	std::shared_ptr<const OutputSnapshot> previous = outputSnapshots.snapshot();
+	std::shared_ptr<const OutputSnapshot> next = biogasOutputReader->createSnapshot(
+		keepSeries ? previous.get() : nullptr, request);
+	outputSnapshots.publish(next);
+	return next;
+}
+
+/**
+ * Getter method for a series of the latest version
+ *
+ * A series requested for the first time is added to a new version,
+ * afterwards it is updated with every published version.
+ *
+ * @param name: "group.name" of a parameter or name of a derived series
+ * @param snapshot: Holds the version of the series
+ * @return The series or nullptr if it does not exist
+ */
+static const OutputSeries* readOutputSeries(const std::string& name, std::shared_ptr<const OutputSnapshot>& snapshot)
+{
+	snapshot = outputSnapshots.snapshot();
+	const OutputSeries* series = snapshot->getSeries(name);
+	if(series != nullptr)
+		return series;
+
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	const std::vector<double>* x;
+	const std::vector<double>* y;
+	if(biogasOutputReader == nullptr || biogasOutputReader->getSeries(name, x, y) < 0)
+		return nullptr;
+	snapshot = publishOutput(name);
+	return snapshot->getSeries(name);
+}
 
 extern "C" {
 
@@ -23,8 +81,41 @@ extern "C" {
  */
 bool readOutputFiles(const char* path_to_outputFiles)
 {
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	delete biogasOutputReader;
 	biogasOutputReader = new BiogasOutputReader();
-	return biogasOutputReader->init(path_to_outputFiles);
+	bool success = biogasOutputReader->init(path_to_outputFiles);
+	publishOutput("", false);
+	return success;
+}
+
+/**
+ * Initialize the BiogasOutputReader on a worker thread
+ * 
+ * Returns immediately. The status can be polled with getAsyncStatus().
+ * As soon as it returns "Done" (1), the new data is available with
+ * getTreeString() and getPlotString(). Until then the previous data
+ * stays available.
+ * 
+ * @param path_to_outputFiles: The absolute path to the outputFiles.lua
+ * @return Ticket of the task
+ */
+int readOutputFilesAsync(const char* path_to_outputFiles)
+{
+	std::string path = path_to_outputFiles;
+	std::shared_ptr<BiogasOutputReader> reader(new BiogasOutputReader());
+	return startAsyncTask(
+		[reader, path](TaskControl* control)
+		{
+			return reader->init(path.c_str(), control);
+		},
+		[reader]()
+		{
+			std::lock_guard<std::mutex> lock(outputWriterMutex);
+			delete biogasOutputReader;
+			biogasOutputReader = new BiogasOutputReader(std::move(*reader));
+			publishOutput("", false);
+		});
 }
 
 /**
@@ -42,7 +133,7 @@ bool readOutputFiles(const char* path_to_outputFiles)
  */
 const char* getTreeString()
 {
-	return biogasOutputReader->outputFilesTreeString.c_str();
+	return outputSnapshots.read().outputFilesTreeString.c_str();
 }
 
 /**
@@ -64,7 +155,34 @@ const char* getTreeString()
  */
 const char* getPlotString()
 {
-	return biogasOutputReader->outputFilesPlotString.c_str();
+	return outputSnapshots.read().outputFilesPlotString.c_str();
+}
+
+/**
+ * Getter method for the Plot-Tree as result buffer
+ * 
+ * Same content as getTreeString() as an array of BiogasTreeRecord
+ * (see common/result_buffer.h). Names may contain whitespaces.
+ * 
+ * @return The buffer, has to be released with releaseResultBuffer()
+ */
+BiogasResultBuffer* getTreeBuffer()
+{
+	return outputSnapshots.read().createTreeBuffer();
+}
+
+/**
+ * Getter method for the plot information as result buffer
+ * 
+ * Same content as getPlotString() as an array of BiogasPlotRecord
+ * (see common/result_buffer.h). Names and units may contain whitespaces,
+ * the column numbers are integers.
+ * 
+ * @return The buffer, has to be released with releaseResultBuffer()
+ */
+BiogasResultBuffer* getPlotBuffer()
+{
+	return outputSnapshots.read().createPlotBuffer();
 }
 
 /**
@@ -74,7 +192,709 @@ const char* getPlotString()
  */
 int getNumberOfOutputLines()
 {
-	return biogasOutputReader->number_of_lines_output;
+	return outputSnapshots.read().number_of_lines_output;
+}
+
+/**
+ * Keeps the current version of the output data for the calling thread
+ * 
+ * The getters read the latest version published by readOutputFiles(),
+ * updateOutputData() and defineDerivedSeries() without waiting for
+ * them. Between pinOutputSnapshot() and unpinOutputSnapshot() all
+ * getters of the thread read the same version (e.g. tree string, plot
+ * string and series of one plot refresh).
+ */
+void pinOutputSnapshot()
+{
+	outputSnapshots.pin();
+}
+
+/**
+ * Reads the latest version of the output data again
+ */
+void unpinOutputSnapshot()
+{
+	outputSnapshots.unpin();
+}
+
+/**
+ * Getter method for the version of the output data
+ * 
+ * Increases with every published version, so a plot only has to be
+ * refreshed if the version changed.
+ * 
+ * @return Number of published versions
+ */
+unsigned long long getOutputVersion()
+{
+	return outputSnapshots.version();
+}
+
+/**
+ * Defines a derived series
+ * 
+ * The series is computed from the columns of the output files and
+ * added to the Plot-Tree (folder "derived"), so getTreeString() and
+ * getPlotString() need to be read again. Examples:
+ * 
+ *   rate(NormvolumeCumulative.Methane)
+ *   sum(allMass.*_gas)
+ *   NormvolumeCumulative.Methane / reactorState.COD
+ * 
+ * @param name: Name of the series
+ * @param expression: Expression of the series
+ * @param unit: Unit of the series
+ * @return Bool if the expression is valid and readOutputFiles() was called
+ */
+bool defineDerivedSeries(const char* name, const char* expression, const char* unit)
+{
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	if(biogasOutputReader == nullptr)
+		return false;
+	bool success = biogasOutputReader->defineDerivedSeries(name, expression, unit);
+	publishOutput();
+	return success;
+}
+
+/**
+ * Reads all rows appended to the output files
+ * 
+ * Only files which have been requested before are updated.
+ * 
+ * @return Number of new rows or -1 if readOutputFiles() was not called
+ */
+int updateOutputData()
+{
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	if(biogasOutputReader == nullptr)
+		return -1;
+	int rows = biogasOutputReader->updateData();
+	publishOutput();
+	return rows;
+}
+
+/**
+ * Getter method for the number of rows of a series
+ * 
+ * @param name: "group.name" of a parameter or name of a derived series
+ * @return Number of rows or -1 if the series does not exist
+ */
+int getSeriesLength(const char* name)
+{
+	std::shared_ptr<const OutputSnapshot> snapshot;
+	const OutputSeries* series = readOutputSeries(name, snapshot);
+	return (series == nullptr) ? -1 : series->size;
+}
+
+/**
+ * Copies the data of a series into two arrays
+ * 
+ * @param name: "group.name" of a parameter or name of a derived series
+ * @param x: Array for the x Values (at least "maxRows" elements)
+ * @param y: Array for the y Values (at least "maxRows" elements)
+ * @param maxRows: Size of the arrays
+ * @return Number of copied rows or -1 if the series does not exist
+ */
+int getSeriesData(const char* name, double* x, double* y, int maxRows)
+{
+	std::shared_ptr<const OutputSnapshot> snapshot;
+	const OutputSeries* series = readOutputSeries(name, snapshot);
+	if(series == nullptr)
+		return -1;
+
+	return series->copy(x, y, maxRows);
+}
+
+/**
+ * Opens an output file in windowed mode
+ * 
+ * For output files too large for the memory (e.g. dbg_* files of long
+ * runs). The file is indexed once and then read in chunks on demand,
+ * only the recently used chunks are kept (up to "memoryLimit").
+ * Parameters of the file are read with getWindowLength() and
+ * getWindowData() instead of getSeriesData().
+ * 
+ * @param filename: Name of the output file (e.g. dbg_reactionrates.txt)
+ * @param chunkSize: Size of a chunk in KB
+ * @param memoryLimit: Maximal memory of the cached chunks in MB
+ * @return Bool if the file could be read (false if readOutputFiles() was not called)
+ */
+bool openOutputFileWindowed(const char* filename, int chunkSize, int memoryLimit)
+{
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	if(biogasOutputReader == nullptr)
+		return false;
+	return biogasOutputReader->openWindowed(filename, 1024LL*chunkSize, 1024LL*1024*memoryLimit);
+}
+
+/**
+ * Getter method for the number of rows of a parameter within a time window
+ * 
+ * The file of the parameter has to be opened with openOutputFileWindowed().
+ * 
+ * @param name: "group.name" of the parameter
+ * @param start: Start of the window (x Value)
+ * @param end: End of the window (x Value)
+ * @return Number of rows or -1 if the parameter is not in a windowed file
+ */
+int getWindowLength(const char* name, double start, double end)
+{
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	if(biogasOutputReader == nullptr)
+		return -1;
+	long long rows = biogasOutputReader->getWindow(name, start, end, 0, nullptr, nullptr);
+	return (int) std::min(rows, (long long) std::numeric_limits<int>::max());
+}
+
+/**
+ * Copies a time window of a parameter into two arrays
+ * 
+ * If the window has more rows than "maxRows", it is downsampled to
+ * the minimum and maximum of maxRows/2 equal parts, so peaks stay
+ * visible.
+ * 
+ * @param name: "group.name" of the parameter
+ * @param start: Start of the window (x Value)
+ * @param end: End of the window (x Value)
+ * @param x: Array for the x Values (at least "maxRows" elements)
+ * @param y: Array for the y Values (at least "maxRows" elements)
+ * @param maxRows: Size of the arrays
+ * @return Number of copied rows or -1 if the parameter is not in a windowed file
+ */
+int getWindowData(const char* name, double start, double end, double* x, double* y, int maxRows)
+{
+	std::vector<double> xValues, yValues;
+	std::lock_guard<std::mutex> lock(outputWriterMutex);
+	if(biogasOutputReader == nullptr || biogasOutputReader->getWindow(name, start, end, maxRows, &xValues, &yValues) < 0)
+		return -1;
+
+	int rows = std::min((int) xValues.size(), maxRows);
+	std::copy(xValues.begin(), xValues.begin()+rows, x);
+	std::copy(yValues.begin(), yValues.begin()+rows, y);
+	return rows;
+}
+
+/**
+ * Initialize the steady state monitor for a simulation
+ * 
+ * Removes all criteria of a previous run. The criteria are
+ * added with addSteadyStateCriterion().
+ * 
+ * @param outputDirectory: Output directory of the simulation
+ */
+void initSteadyStateMonitor(const char* outputDirectory)
+{
+	std::shared_ptr<SteadyStateMonitor> monitor(new SteadyStateMonitor());
+	monitor->init(outputDirectory);
+	std::atomic_store(&steadyStateMonitor, monitor);
+}
+
+/**
+ * Adds a convergence criterion to the steady state monitor
+ * 
+ * The criterion holds as soon as the slope and the variance of the
+ * column over the last "window" hours are within their limits, e.g.
+ * 
+ *   reactorState.txt, pH, 48, 0.001, 0.0001
+ *   producedNormVolumeHourly.txt, Methane, 48, 0.01, -1
+ * 
+ * Must not be called while startSteadyStateMonitorAsync() is running.
+ * 
+ * @param filename: Output file
+ * @param column: Name of the column in the file header or its number (as in outputFiles.lua)
+ * @param window: Width of the window in hours
+ * @param maxSlope: Maximal absolute slope per hour (negative: not checked)
+ * @param maxVariance: Maximal variance (negative: not checked)
+ */
+void addSteadyStateCriterion(const char* filename, const char* column, double window, double maxSlope, double maxVariance)
+{
+	std::shared_ptr<SteadyStateMonitor> monitor = std::atomic_load(&steadyStateMonitor);
+	if(monitor)
+		monitor->addCriterion(filename, column, window, maxSlope, maxVariance);
+}
+
+/**
+ * Sets a process to signal as soon as the run has converged
+ * 
+ * May be called while startSteadyStateMonitorAsync() is running.
+ * 
+ * @param pid: Process id (e.g. of ugshell), 0 to signal no process
+ * @param signal: The signal (e.g. 15 for SIGTERM)
+ */
+void setSteadyStateProcess(int pid, int signal)
+{
+	std::shared_ptr<SteadyStateMonitor> monitor = std::atomic_load(&steadyStateMonitor);
+	if(!monitor)
+		return;
+	monitor->process = 0;
+	monitor->signal = signal;
+	monitor->process = pid;
+}
+
+/**
+ * Reads the new rows of the output files and checks all criteria
+ * 
+ * Must not be called while startSteadyStateMonitorAsync() is running.
+ * 
+ * @return 1 if the run has converged, 0 if not
+ */
+int updateSteadyState()
+{
+	std::shared_ptr<SteadyStateMonitor> monitor = std::atomic_load(&steadyStateMonitor);
+	return (monitor && monitor->update()) ? 1 : 0;
+}
+
+/**
+ * Follows the output files on a worker thread until the run has converged
+ * 
+ * The task is "Done" (see getAsyncStatus()) as soon as the run has
+ * converged, its progress is the percentage of criteria which hold.
+ * Cancel it with cancelAsync() when the simulation ends.
+ * 
+ * @param interval: Time between two updates in milliseconds
+ * @return Ticket of the task or -1 if initSteadyStateMonitor() was not called
+ */
+int startSteadyStateMonitorAsync(int interval)
+{
+	std::shared_ptr<SteadyStateMonitor> monitor = std::atomic_load(&steadyStateMonitor);
+	if(!monitor)
+		return -1;
+	return startAsyncTask(
+		[monitor, interval](TaskControl* control)
+		{
+			return monitor->run(control, interval);
+		},
+		[]() {});
+}
+
+/**
+ * Getter method for the time of convergence
+ * 
+ * @return Simulated time (in hours) at which the run converged or -1
+ */
+double getSteadyStateTime()
+{
+	std::shared_ptr<SteadyStateMonitor> monitor = std::atomic_load(&steadyStateMonitor);
+	if(!monitor)
+		return -1;
+	return monitor->convergenceTime;
+}
+
+/**
+ * Initialize the analytics over many runs
+ * 
+ * Removes all KPIs and parameters. They are added with addRunKpi()
+ * and addRunParameter().
+ * 
+ * @param specPattern: Name of the specification in a run directory (e.g. "problemSettings.lua", wildcards allowed)
+ */
+void initRunAnalytics(const char* specPattern)
+{
+	std::shared_ptr<RunAnalytics> analytics(new RunAnalytics());
+	analytics->init(specPattern);
+	runAnalytics.publish(analytics);
+}
+
+/**
+ * Adds a KPI computed for every run
+ * 
+ * One line "name reduction filename column [arguments]", e.g.
+ * 
+ *   methane last producedNormVolumeCumulative.txt Methane
+ *   meanPH mean reactorState.txt pH
+ *   peakFOSCOD maxratio reactorState.txt FOS COD
+ *   steadyPH steady reactorState.txt pH 48 0.001 -1
+ * 
+ * Reductions: first, last, min, max, sum, integral, mean, maxratio
+ * (column/second column) and steady (time to steady state with window,
+ * maxSlope and maxVariance as in addSteadyStateCriterion()).
+ * 
+ * @param definition: Definition of the KPI
+ * @return Bool if the definition is valid and initRunAnalytics() was called
+ */
+bool addRunKpi(const char* definition)
+{
+	return runAnalytics.version() > 0 && runAnalytics.update([&](RunAnalytics& analytics)
+	{
+		return analytics.addKpi(definition);
+	});
+}
+
+/**
+ * Adds a parameter of the specifications to the summary
+ * 
+ * Without parameters all parameters which differ between the
+ * runs are added.
+ * 
+ * @param path: Path of the parameter (e.g. pSettings.feeding.drymass)
+ */
+void addRunParameter(const char* path)
+{
+	if(runAnalytics.version() == 0)
+		return;
+	runAnalytics.update([&](RunAnalytics& analytics)
+	{
+		analytics.addParameter(path);
+		return true;
+	});
+}
+
+/**
+ * Splits a list of run directories
+ * 
+ * @param runDirs: The run directories (one per line)
+ * @return The run directories
+ */
+static std::vector<std::string> splitRunDirs(const char* runDirs)
+{
+	std::vector<std::string> dirs;
+	std::string list = runDirs;
+	std::string::size_type start = 0;
+	while(start < list.size())
+	{
+		std::string::size_type end = list.find('\n', start);
+		if(end == std::string::npos)
+			end = list.size();
+		if(end > start)
+			dirs.push_back(list.substr(start, end-start));
+		start = end+1;
+	}
+	return dirs;
+}
+
+/**
+ * Publish the summary of a batch
+ *
+ * Only the summary is replaced, KPIs and parameters added while the
+ * batch was running are kept.
+ *
+ * @param summary: The summary
+ */
+static void publishRunSummary(const std::string& summary)
+{
+	runAnalytics.update([&](RunAnalytics& analytics)
+	{
+		analytics.summary = summary;
+		return true;
+	});
+}
+
+/**
+ * Computes the KPIs of many runs
+ * 
+ * The runs are evaluated in parallel, only the columns needed by the
+ * KPIs are read. The summary (getRunAnalyticsTable()) has one row per
+ * run with the parameters of its specification and all KPIs.
+ * 
+ * @param runDirs: The run directories (one per line)
+ * @param outputFile: File to write the summary to (tab separated, "" for none)
+ * @return Bool if the summary could be written
+ */
+bool runBatchAnalytics(const char* runDirs, const char* outputFile)
+{
+	if(runAnalytics.version() == 0)
+		return false;
+	RunAnalytics analytics = *runAnalytics.snapshot();
+	bool success = analytics.run(splitRunDirs(runDirs), outputFile);
+	publishRunSummary(analytics.summary);
+	return success;
+}
+
+/**
+ * Computes the KPIs of many runs on a worker thread
+ * 
+ * Works like runBatchAnalytics(). As soon as getAsyncStatus() returns
+ * "Done" (1), the summary is available with getRunAnalyticsTable().
+ * 
+ * @param runDirs: The run directories (one per line)
+ * @param outputFile: File to write the summary to (tab separated, "" for none)
+ * @return Ticket of the task or -1 if initRunAnalytics() was not called
+ */
+int runBatchAnalyticsAsync(const char* runDirs, const char* outputFile)
+{
+	if(runAnalytics.version() == 0)
+		return -1;
+	std::vector<std::string> dirs = splitRunDirs(runDirs);
+	std::string file = outputFile;
+	std::shared_ptr<RunAnalytics> analytics(new RunAnalytics(*runAnalytics.snapshot()));
+	return startAsyncTask(
+		[analytics, dirs, file](TaskControl* control)
+		{
+			return analytics->run(dirs, file, control);
+		},
+		[analytics]()
+		{
+			publishRunSummary(analytics->summary);
+		});
+}
+
+/**
+ * Getter method for the summary of the analytics
+ * 
+ * Tab separated, the first line holds the column names:
+ * "run", the parameters and the names of the KPIs. The string stays
+ * valid until the calling thread reads the summary again.
+ * 
+ * @return The summary
+ */
+const char* getRunAnalyticsTable()
+{
+	return runAnalytics.read().summary.c_str();
+}
+
+/**
+ * Initialize the density image of a series over many runs
+ * 
+ * Overlaying the same series of hundreds of runs (e.g. of a parameter
+ * sweep) as separate traces is slow. The density image bins the curves
+ * of all runs into a grid of "width" x "height" cells, every cell
+ * counts the runs passing it. Display it in an intensity graph, its
+ * size does not depend on the number of runs.
+ * 
+ * The bounds are taken from the data unless they are set with
+ * setRunDensityRange(). Bands are added with addRunDensityPercentile().
+ * 
+ * @param filename: Output file (e.g. reactorState.txt)
+ * @param column: Name or number of the column (e.g. pH)
+ * @param width: Number of time columns of the image
+ * @param height: Number of value rows of the image
+ * @return Bool if the size is valid
+ */
+bool initRunDensity(const char* filename, const char* column, int width, int height)
+{
+	std::shared_ptr<RunDensity> density(new RunDensity());
+	bool success = density->init(filename, column, width, height);
+	runDensity.publish(density);
+	return success;
+}
+
+/**
+ * Sets the bounds of the density image
+ * 
+ * NaN takes the bound from the data of all runs. With all four bounds
+ * set, every run is binned right after it has been read (less memory).
+ * 
+ * @param timeMin: Lower bound of the time
+ * @param timeMax: Upper bound of the time
+ * @param valueMin: Lower bound of the values
+ * @param valueMax: Upper bound of the values
+ */
+void setRunDensityRange(double timeMin, double timeMax, double valueMin, double valueMax)
+{
+	if(runDensity.version() == 0)
+		return;
+	runDensity.update([&](RunDensity& density)
+	{
+		density.setRange(timeMin, timeMax, valueMin, valueMax);
+		return true;
+	});
+}
+
+/**
+ * Adds a percentile band to the density image
+ * 
+ * The band holds the percentile of the values of all runs at the
+ * center of every time column (e.g. 5, 50 and 95 for the median with
+ * a 90% band).
+ * 
+ * @param percentile: The percentile (0 to 100)
+ * @return Bool if the percentile is valid
+ */
+bool addRunDensityPercentile(double percentile)
+{
+	return runDensity.version() > 0 && runDensity.update([&](RunDensity& density)
+	{
+		return density.addPercentile(percentile);
+	});
+}
+
+/**
+ * Publish the density image of a computation
+ *
+ * Only the image is replaced, bounds and bands set while it was
+ * computed apply to the next computation.
+ *
+ * @param result: The computation
+ */
+static void publishRunDensity(const RunDensity& result)
+{
+	runDensity.update([&](RunDensity& density)
+	{
+		density.data = result.data;
+		density.range = result.range;
+		density.runs = result.runs;
+		return true;
+	});
+}
+
+/**
+ * Computes the density image of many runs
+ * 
+ * The runs are read and binned in parallel, only the time and the
+ * chosen column of the output file are parsed.
+ * 
+ * @param runDirs: The run directories (one per line)
+ * @return Number of runs with data (0 if none has data) or -1 if initRunDensity() was not called
+ */
+int computeRunDensity(const char* runDirs)
+{
+	if(runDensity.version() == 0)
+		return -1;
+	RunDensity density = *runDensity.snapshot();
+	density.run(splitRunDirs(runDirs));
+	publishRunDensity(density);
+	return density.runs;
+}
+
+/**
+ * Computes the density image of many runs on a worker thread
+ * 
+ * Works like computeRunDensity(). As soon as getAsyncStatus() returns
+ * "Done" (1), the image is available with getRunDensityData().
+ * 
+ * @param runDirs: The run directories (one per line)
+ * @return Ticket of the task or -1 if initRunDensity() was not called
+ */
+int computeRunDensityAsync(const char* runDirs)
+{
+	if(runDensity.version() == 0)
+		return -1;
+	std::vector<std::string> dirs = splitRunDirs(runDirs);
+	std::shared_ptr<RunDensity> density(new RunDensity(*runDensity.snapshot()));
+	return startAsyncTask(
+		[density, dirs](TaskControl* control)
+		{
+			return density->run(dirs, control);
+		},
+		[density]()
+		{
+			publishRunDensity(*density);
+		});
+}
+
+/**
+ * Getter method for the size of the density image
+ * 
+ * @return Number of elements of getRunDensityData(): width*height
+ * plus width per percentile band (0 if no image has been computed)
+ */
+int getRunDensityLength()
+{
+	return (int) runDensity.read().data.size();
+}
+
+/**
+ * Copies the density image into an array
+ * 
+ * The array holds the counts column wise, element x*height+y is the
+ * number of runs passing cell y (0 is the lowest value) of time column
+ * x. It can be reshaped into a 2D array [width][height] for an
+ * intensity graph. Then follow the percentile bands (in the order they
+ * were added), "width" values each (NaN where no run has data).
+ * 
+ * @param data: Array for the image (at least "maxSize" elements)
+ * @param range: Array for the bounds of the image (4 elements: timeMin, timeMax, valueMin, valueMax)
+ * @param maxSize: Size of the array "data"
+ * @return Number of copied elements
+ */
+int getRunDensityData(double* data, double* range, int maxSize)
+{
+	const RunDensity& density = runDensity.read();
+	int size = std::min((int) density.data.size(), maxSize);
+	std::copy(density.data.begin(), density.data.begin()+size, data);
+	if(density.range.size() == 4)
+		std::copy(density.range.begin(), density.range.end(), range);
+	return size;
+}
+
+/**
+ * Trains a surrogate model on the summary of the run analytics
+ * 
+ * Predicts the KPIs (addRunKpi()) from the parameters of the runs, so
+ * runs whose outcome is predicted well enough need not be simulated.
+ * Call runBatchAnalytics() first, all numerical parameters of the
+ * summary which differ between the runs are the inputs
+ * (getSurrogateInputs()).
+ * 
+ * Methods: "kriging" (Gaussian process, best for few runs and smooth
+ * KPIs), "linear" and "quadratic" (polynomial least squares).
+ * 
+ * @param method: The method
+ * @param smoothing: Relative noise of the KPIs (0: the model reproduces the training runs)
+ * @return Bool if the model could be trained
+ */
+bool trainSurrogateModel(const char* method, double smoothing)
+{
+	if(runAnalytics.version() == 0)
+		return false;
+	std::shared_ptr<const RunAnalytics> analytics = runAnalytics.snapshot();
+	std::vector<std::string> kpis;
+	for(const RunKpi& kpi : analytics->kpis)
+		kpis.push_back(kpi.name);
+	std::shared_ptr<SurrogateModel> model(new SurrogateModel());
+	bool success = model->train(analytics->summary, kpis, method, smoothing);
+
+	std::shared_ptr<std::string> list = std::make_shared<std::string>();
+	for(const std::string& name : model->inputs)
+		*list += name + "\n";
+	surrogateModel.publish(model);
+	surrogateInputs.publish(list);
+	return success;
+}
+
+/**
+ * Getter method for the inputs of the surrogate model
+ * 
+ * The string stays valid until the calling thread reads the inputs again.
+ * 
+ * @return Paths of the parameters (one per line)
+ */
+const char* getSurrogateInputs()
+{
+	return surrogateInputs.read().c_str();
+}
+
+/**
+ * Predicts the KPIs of a run with the surrogate model
+ * 
+ * @param inputs: Values of the parameters (in the order of getSurrogateInputs())
+ * @param mean: Array for the predicted KPIs (in the order of addRunKpi())
+ * @param stddev: Array for the standard deviations of the predictions
+ * @return Bool if the model is trained and the inputs are valid
+ */
+bool predictSurrogate(const double* inputs, double* mean, double* stddev)
+{
+	return surrogateModel.snapshot()->predict(inputs, mean, stddev);
+}
+
+/**
+ * Predicts the KPIs of a specification with the surrogate model
+ * 
+ * @param filename: The specification file
+ * @param mean: Array for the predicted KPIs (in the order of addRunKpi())
+ * @param stddev: Array for the standard deviations of the predictions
+ * @return Bool if the file holds all inputs of the model
+ */
+bool predictSurrogateForSpec(const char* filename, double* mean, double* stddev)
+{
+	return surrogateModel.snapshot()->predictSpec(filename, mean, stddev);
+}
+
+/**
+ * Suggests the next parameter points to simulate
+ * 
+ * The points within the range of the training runs where the
+ * prediction is most uncertain, spread over the parameter space. The
+ * string stays valid until the calling thread asks for points again.
+ * 
+ * @param count: Number of points
+ * @return Table (tab separated, header line) with the parameters, the
+ * predicted KPIs and their standard deviations ("<KPI>_stddev")
+ */
+const char* suggestSurrogatePoints(int count)
+{
+	std::shared_ptr<const std::string> table = std::make_shared<const std::string>(surrogateModel.snapshot()->suggest(count));
+	return surrogateSuggestions.publishAndRead(table).c_str();
 }
 
 } //end extern "C" 
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ * 
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/result_buffer.h"
+
+extern "C" {
+
+/**
+ * Releases a result buffer
+ * 
+ * Has to be called once for every buffer returned by e.g.
+ * getTreeBuffer(), getPlotBuffer() or getValiBuffer().
+ * 
+ * @param buffer: The buffer (may be NULL)
+ */
+void releaseResultBuffer(BiogasResultBuffer* buffer)
+{
+	std::free(buffer);
+}
+
+/**
+ * Getter method for a string of a result buffer
+ * 
+ * @param buffer: The buffer
+ * @param offset: Offset of the string in the arena (see BiogasStringRef)
+ * @return The '\0' terminated string
+ */
+const char* getResultBufferString(const BiogasResultBuffer* buffer, uint32_t offset)
+{
+	return (const char*) buffer + buffer->arenaOffset + offset;
+}
+
+} //end extern "C" 
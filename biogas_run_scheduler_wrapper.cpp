@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/run_scheduler.cpp"
+#include <memory>
+
+static std::shared_ptr<RunScheduler> runScheduler(new RunScheduler());
+
+extern "C" {
+
+/**
+ * Initialize the scheduler of a batch of simulations
+ *
+ * Terminates the jobs of a previous batch. The jobs are added with
+ * addRunJob() and run by updateRunScheduler(), longest predicted
+ * runtime first, so long runs do not start last and dominate the time
+ * of the batch. The runtimes are predicted from the specifications
+ * and the runtimes of past runs, which are read from and appended to
+ * the history file.
+ *
+ * @param slots: Number of simulations running at the same time
+ * @param historyFile: File of recorded runtimes ("" for none)
+ */
+void initRunScheduler(int slots, const char* historyFile)
+{
+	runScheduler.reset(new RunScheduler());
+	runScheduler->init(slots, historyFile);
+}
+
+/**
+ * Adds a simulation to the batch
+ *
+ * @param commandline: The command line (e.g. "ugshell -ex Biogas.lua -p spec.lua")
+ * @param workingDir: Working directory of the process ("" for the current one)
+ * @param specFile: The specification of the run
+ * @return Number of the job (line in getRunSchedule())
+ */
+int addRunJob(const char* commandline, const char* workingDir, const char* specFile)
+{
+	return runScheduler->addJob(commandline, workingDir, specFile);
+}
+
+/**
+ * Predicts the runtime of a specification
+ *
+ * Without recorded runtimes the prediction only serves to compare
+ * specifications (simulated hours as seconds).
+ *
+ * @param specFile: The specification file
+ * @return The runtime in seconds or -1 if the file could not be read
+ */
+double predictRunTime(const char* specFile)
+{
+	return runScheduler->predict(specFile);
+}
+
+/**
+ * Records the runtime of a simulation run outside the scheduler
+ *
+ * @param specFile: The specification of the run
+ * @param seconds: The runtime
+ * @return Bool if the specification could be read
+ */
+bool addRunTime(const char* specFile, double seconds)
+{
+	return runScheduler->record(specFile, seconds);
+}
+
+/**
+ * Collects finished simulations and starts waiting ones
+ *
+ * Call it periodically (e.g. every second). The runtimes of finished
+ * simulations improve the predictions of the waiting ones.
+ *
+ * @return Number of waiting and running simulations
+ */
+int updateRunScheduler()
+{
+	return runScheduler->update();
+}
+
+/**
+ * Getter method for the schedule of the batch
+ *
+ * One line per job, tab separated, the first line holds the column
+ * names: job, state (waiting, running, done, failed, cancelled), slot,
+ * predicted runtime, start and end (planned for waiting and running
+ * jobs) in seconds since initRunScheduler() and the specification.
+ *
+ * @return The schedule
+ */
+const char* getRunSchedule()
+{
+	return runScheduler->schedule.c_str();
+}
+
+/**
+ * Getter method for the predicted end of the batch
+ *
+ * @return Predicted seconds until all simulations are finished
+ */
+double getRunScheduleFinish()
+{
+	return runScheduler->makespan;
+}
+
+/**
+ * Terminates all running simulations and cancels the waiting ones
+ */
+void stopRunScheduler()
+{
+	runScheduler->stop();
+}
+
+} //end extern "C"
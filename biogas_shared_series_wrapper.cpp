@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "common/shared_series.cpp"
+#include <atomic>
+#include <memory>
+
+/**
+ * Container for all opened series by their handle
+ *
+ * The slots are accessed atomically, so looking up a handle never
+ * waits for a lock. A call keeps its own reference, so a series
+ * released by another thread stays mapped until the call returns.
+ */
+static const int maxSharedSeries = 64;
+static std::shared_ptr<SharedSeries> sharedSeriesSlots[maxSharedSeries];
+
+/**
+ * Add an opened series
+ *
+ * @param series: The series (owned by the container afterwards)
+ * @return Handle of the series or -1 if all slots are used
+ */
+static int addSharedSeries(SharedSeries* series)
+{
+	std::shared_ptr<SharedSeries> owned(series);
+	for(int i=0; i<maxSharedSeries; i++)
+	{
+		std::shared_ptr<SharedSeries> empty;
+		if(std::atomic_compare_exchange_strong(&sharedSeriesSlots[i], &empty, owned))
+			return i+1;
+	}
+	return -1;
+}
+
+/**
+ * Find a series by its handle
+ *
+ * @param handle: The handle
+ * @return The series or nullptr
+ */
+static std::shared_ptr<SharedSeries> findSharedSeries(int handle)
+{
+	if(handle < 1 || handle > maxSharedSeries)
+		return nullptr;
+	return std::atomic_load(&sharedSeriesSlots[handle-1]);
+}
+
+/**
+ * Remove a series
+ *
+ * The producer closes the series, both sides unmap it as soon as no
+ * other thread uses it any more.
+ *
+ * @param handle: The handle
+ */
+static void removeSharedSeries(int handle)
+{
+	if(handle < 1 || handle > maxSharedSeries)
+		return;
+	std::atomic_exchange(&sharedSeriesSlots[handle-1], std::shared_ptr<SharedSeries>());
+}
+
+extern "C" {
+
+/**
+ * Creates a shared series (producer side)
+ *
+ * Called by the simulation (or a stand-in process) to publish rows
+ * of a named series through shared memory. A series of a previous
+ * run with the same name is replaced.
+ *
+ * @param name: Name of the series (e.g. "reactorState")
+ * @param columns: Number of doubles per row, the first one is the time
+ * @param capacity: Number of rows kept for a slow consumer
+ * @return Handle of the series or -1 if it could not be created
+ */
+int createSharedSeries(const char* name, int columns, int capacity)
+{
+	SharedSeries* series = new SharedSeries();
+	if(!series->create(name, columns, capacity))
+	{
+		delete series;
+		return -1;
+	}
+	return addSharedSeries(series);
+}
+
+/**
+ * Publishes one row of a shared series (producer side)
+ *
+ * Never blocks. If the consumer falls behind, its oldest rows are overwritten.
+ *
+ * @param handle: Handle returned by createSharedSeries()
+ * @param values: "columns" doubles (time first)
+ * @return Bool if the row was published
+ */
+bool publishSharedRow(int handle, const double* values)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	return series != nullptr && series->publish(values);
+}
+
+/**
+ * Marks a shared series as complete (producer side)
+ *
+ * @param handle: Handle returned by createSharedSeries()
+ */
+void closeSharedSeries(int handle)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	if(series != nullptr)
+		series->close();
+}
+
+/**
+ * Attaches to a shared series (consumer side)
+ *
+ * @param name: Name of the series
+ * @return Handle of the series or -1 if it does not exist (yet)
+ */
+int attachSharedSeries(const char* name)
+{
+	SharedSeries* series = new SharedSeries();
+	if(!series->attach(name))
+	{
+		delete series;
+		return -1;
+	}
+	return addSharedSeries(series);
+}
+
+/**
+ * Getter method for the new rows of a shared series (consumer side)
+ *
+ * The rows are not copied: "rows" points directly into the shared
+ * memory ("columns" doubles per row, time first) and stays valid
+ * until releaseSharedRows() or releaseSharedSeries() is called. Has to be called repeatedly
+ * until it returns 0, as the rows at the end of the ring and the
+ * rows at its start are returned separately.
+ *
+ * @param handle: Handle returned by attachSharedSeries()
+ * @param rows: Pointer to the first row
+ * @return Number of rows
+ */
+int acquireSharedRows(int handle, const double** rows)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	*rows = nullptr;
+	if(series == nullptr)
+		return 0;
+	return series->acquire(*rows);
+}
+
+/**
+ * Releases the rows returned by acquireSharedRows() (consumer side)
+ *
+ * @param handle: Handle returned by attachSharedSeries()
+ * @param count: Number of rows read
+ * @return k if the producer overwrote the first k rows while they were read
+ */
+int releaseSharedRows(int handle, int count)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	if(series == nullptr)
+		return 0;
+	return series->release(count);
+}
+
+/**
+ * Getter method for the number of doubles per row of a shared series
+ *
+ * @param handle: Handle of the series
+ * @return Number of columns (0 for an unknown handle)
+ */
+int getSharedSeriesColumns(int handle)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	return series == nullptr ? 0 : series->columns();
+}
+
+/**
+ * Whether the producer completed a shared series
+ *
+ * After the remaining rows are read, the consumer may attach
+ * again to follow the next run.
+ *
+ * @param handle: Handle of the series
+ * @return Bool if the series is complete
+ */
+bool isSharedSeriesClosed(int handle)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	return series == nullptr || series->isClosed();
+}
+
+/**
+ * Getter method for the number of rows the consumer missed
+ *
+ * @param handle: Handle returned by attachSharedSeries()
+ * @return Number of rows overwritten before they were read
+ */
+long long getSharedSeriesLostRows(int handle)
+{
+	std::shared_ptr<SharedSeries> series = findSharedSeries(handle);
+	return series == nullptr ? 0 : (long long) series->lostRows();
+}
+
+/**
+ * Releases a handle of a shared series (both sides)
+ *
+ * A producer marks the series as complete. The shared memory stays
+ * available for consumers until unlinkSharedSeries() is called.
+ *
+ * @param handle: Handle of the series
+ */
+void releaseSharedSeries(int handle)
+{
+	removeSharedSeries(handle);
+}
+
+/**
+ * Removes the shared memory of a series
+ *
+ * Attached consumers can read their remaining rows.
+ *
+ * @param name: Name of the series
+ */
+void unlinkSharedSeries(const char* name)
+{
+	shm_unlink(sharedSeriesSegment(name).c_str());
+}
+
+} //end extern "C"
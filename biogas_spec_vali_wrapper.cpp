@@ -12,9 +12,18 @@
 #include "spec_vali_reader/biogas_spec_vali_reader.cpp"
 #include "spec_vali_reader/biogas_spec_writer.cpp"
 #include "spec_vali_reader/biogas_spec_validation.cpp"
+#include "spec_vali_reader/biogas_spec_batch.cpp"
 #include "spec_vali_reader/biogas_spec_vali_reader.h"
+#include "common/async_task.h"
+#include "common/file_watcher.h"
+#include "common/versioned_store.h"
+#include <algorithm>
+#include <memory>
 
-static BiogasSpecValiReader* biogasReader;
+static VersionedStore<BiogasSpecValiReader> specSnapshots;
+static VersionedStore<std::string> childrenStrings;
+static VersionedStore<std::string> cachedRunDirs;
+static VersionedStore<std::string> specHistoryStrings;
 
 extern "C" {
 	
@@ -22,7 +31,7 @@ extern "C" {
  * Creates a new BiogasSpecValiReader object
  */
 void readLUATableInit(){
-	biogasReader = new BiogasSpecValiReader();
+	specSnapshots.publish(std::make_shared<const BiogasSpecValiReader>());
 }
 
 /**
@@ -30,7 +39,8 @@ void readLUATableInit(){
  * 
  * Method receives the absolute path to a validation or specification file
  * and an indicator "Spec" or "Vali" to call the corresponding
- * init function.
+ * init function. The file is watched for changes while a file
+ * watcher runs (see startFileWatcher()).
  * 
  * @param vali_or_spec: Chooses between validation files or specifications
  * @param filename: The absolute path to the file
@@ -38,12 +48,93 @@ void readLUATableInit(){
  */
 bool readLUATable(const char* filename, const char* vali_or_spec)
 {
-	if(((std::string) vali_or_spec) == "Vali")
-		return biogasReader->init_Vali(filename);
-	else if(((std::string) vali_or_spec) == "Spec")
-		return biogasReader->init_Spec(filename);
+	bool success = specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		if(((std::string) vali_or_spec) == "Vali")
+			return reader.init_Vali(filename);
+		else if(((std::string) vali_or_spec) == "Spec")
+			return reader.init_Spec(filename);
+		return false;
+	});
 
-	return false;
+	if(success)
+		watchLoadedFile(filename);
+	return success;
+}
+
+/**
+ * Initialize the BiogasSpecValiReader on a worker thread
+ * 
+ * Works like readLUATable() and returns immediately: the file is read
+ * into a separate reader. The status can be polled with getAsyncStatus().
+ * As soon as it returns "Done" (1), the loaded data is applied to the
+ * current data and is available with the getter methods (e.g.
+ * getValiString(), getSpecString()). Until then the previous data stays
+ * available. Changes made in the meantime (e.g. editSpecValue()) are kept,
+ * a specification file is applied on top of them.
+ * 
+ * @param filename: The absolute path to the file
+ * @param vali_or_spec: Chooses between validation files or specifications
+ * @return Ticket of the task
+ */
+int readLUATableAsync(const char* filename, const char* vali_or_spec)
+{
+	std::string path = filename;
+	std::string type = vali_or_spec;
+	std::shared_ptr<BiogasSpecValiReader> loaded(new BiogasSpecValiReader());
+	return startAsyncTask(
+		[loaded, path, type](TaskControl* control)
+		{
+			if(type == "Vali")
+				return loaded->init_Vali(path.c_str(), control);
+			else if(type == "Spec")
+				return loaded->parse_Spec(path.c_str(), control);
+			return false;
+		},
+		[loaded, path, type]()
+		{
+			specSnapshots.update([&](BiogasSpecValiReader& current)
+			{
+				if(type == "Vali")
+					current.adoptVali(*loaded);
+				else
+					current.adoptSpec(*loaded, path);
+				return true;
+			});
+			watchLoadedFile(path);
+		});
+}
+
+/**
+ * Keeps the current version of the loaded data for the calling thread
+ * 
+ * Every call which changes the data (e.g. readLUATable(), getValidation(),
+ * setTimeTableData()) publishes a new version, the getters read the
+ * latest version without waiting for them. Between pinSpecSnapshot()
+ * and unpinSpecSnapshot() all getters of the thread read the same
+ * version.
+ */
+void pinSpecSnapshot()
+{
+	specSnapshots.pin();
+}
+
+/**
+ * Reads the latest version of the loaded data again
+ */
+void unpinSpecSnapshot()
+{
+	specSnapshots.unpin();
+}
+
+/**
+ * Getter method for the version of the loaded data
+ * 
+ * @return Number of published versions
+ */
+unsigned long long getSpecVersion()
+{
+	return specSnapshots.version();
 }
 
 /**
@@ -63,7 +154,21 @@ bool readLUATable(const char* filename, const char* vali_or_spec)
  */
 const char* getValiString()
 {	
-	return biogasReader->valiString.c_str();
+	return specSnapshots.read().valiString.c_str();
+}
+
+/**
+ * Getter method for the validation data as result buffer
+ * 
+ * Same content as getValiString() (plus ranges) as an array of
+ * BiogasValiRecord (see common/result_buffer.h). Names may contain
+ * whitespaces.
+ * 
+ * @return The buffer, has to be released with releaseResultBuffer()
+ */
+BiogasResultBuffer* getValiBuffer()
+{
+	return specSnapshots.read().createValiBuffer();
 }
 
 /**
@@ -75,7 +180,7 @@ const char* getValiString()
  */
 const char* getSpecString()
 {	
-	return biogasReader->specString.c_str();
+	return specSnapshots.read().specString.c_str();
 }
 
 /**
@@ -86,7 +191,30 @@ const char* getSpecString()
  */
 bool getValidation(const char* specs)
 {
-	return biogasReader->validateSpecs((std::string) specs);
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.validateSpecs((std::string) specs);
+	});
+}
+
+/**
+ * Getter method for the validation after editing one parameter
+ * 
+ * Only the constraints of the validation file which depend on the
+ * edited parameter are checked again, all other results are kept
+ * from the last getValidation() call. The validation message and
+ * the error parameters are updated.
+ * 
+ * @param index: Index of the edited parameter in the LabView Tree
+ * @param spec: The new specification of the parameter
+ * @return Bool if specification is valid
+ */
+bool getValidationEdit(int index, const char* spec)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.validateSpecEdit(index, (std::string) spec);
+	});
 }
 
 /**
@@ -98,7 +226,7 @@ bool getValidation(const char* specs)
  */
 const char* getValidationMessage()
 {
-	return biogasReader->validationMessage.c_str();
+	return specSnapshots.read().validationMessage.c_str();
 }
 
 /**
@@ -111,7 +239,7 @@ const char* getValidationMessage()
  */
 const char* getValidationErrorParams()
 {
-	return biogasReader->validationErrorParams.c_str();
+	return specSnapshots.read().validationErrorParams.c_str();
 }
 
 /**
@@ -125,7 +253,10 @@ const char* getValidationErrorParams()
  */
 bool getOutputSpecs(const char* specs)
 {
-	return biogasReader->writeOutputSpecs((std::string) specs);
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.writeOutputSpecs((std::string) specs);
+	});
 }
 
 /**
@@ -137,7 +268,7 @@ bool getOutputSpecs(const char* specs)
  */
 const char* getOutputString()
 {
-	return biogasReader->outputSpecs.c_str();
+	return specSnapshots.read().outputSpecs.c_str();
 }
 
 /**
@@ -147,7 +278,579 @@ const char* getOutputString()
  */
 int getNumberOfLines()
 {
-	return biogasReader->number_of_entries;
+	return specSnapshots.read().number_of_entries;
+}
+
+/**
+ * Getter method for the time table String
+ * 
+ * One line per time table of the specification.
+ * The columns are as follows:
+ * 
+ * Col1: Index of the time table (folder) in the tree
+ * Col2: Number of rows
+ * Col3: LeftCell
+ *
+ * @return All time tables as String
+ */
+const char* getTimeTableString()
+{
+	return specSnapshots.read().timeTableString.c_str();
+}
+
+/**
+ * Getter method for the number of rows of a time table
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @return Number of rows or -1 if there is no such table
+ */
+int getTimeTableSize(int index)
+{
+	const TimeTable* table = specSnapshots.read().getTimeTable(index);
+	if(table == nullptr)
+		return -1;
+	return table->size();
+}
+
+/**
+ * Copies a time table into two arrays
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @param time: Array for the times (at least "maxRows" elements)
+ * @param value: Array for the values (at least "maxRows" elements)
+ * @param maxRows: Size of the arrays
+ * @return Number of copied rows or -1 if there is no such table
+ */
+int getTimeTableData(int index, double* time, double* value, int maxRows)
+{
+	const TimeTable* table = specSnapshots.read().getTimeTable(index);
+	if(table == nullptr)
+		return -1;
+
+	int rows = std::min(table->size(), maxRows);
+	std::copy(table->time.begin(), table->time.begin()+rows, time);
+	std::copy(table->value.begin(), table->value.begin()+rows, value);
+	return rows;
+}
+
+/**
+ * Replaces a time table with two arrays
+ * 
+ * The tree rows of the table are adjusted to the new number of rows,
+ * so getValiString() and getSpecString() need to be read again.
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @param time: Array of times
+ * @param value: Array of values
+ * @param rows: Number of rows
+ * @return Bool if the table exists and all times and values are finite
+ */
+bool setTimeTableData(int index, const double* time, const double* value, int rows)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.setTimeTable(index, time, value, rows);
+	});
+}
+
+/**
+ * Imports a time table from a CSV file
+ * 
+ * One row "time,value" per line (',', ';', tabs or whitespaces),
+ * comments start with '#'. Only one header line is skipped.
+ * The tree rows of the table are adjusted to the new number of rows,
+ * so getValiString() and getSpecString() need to be read again.
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @param filename: The absolute path to the CSV file
+ * @return Bool if the file could be read and all rows are valid
+ */
+bool importTimeTable(int index, const char* filename)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.importTimeTableCSV(index, (std::string) filename);
+	});
+}
+
+/**
+ * Exports a time table into a CSV file
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @param filename: The absolute path to the CSV file
+ * @return Bool if the method was succesfull
+ */
+bool exportTimeTable(int index, const char* filename)
+{
+	return specSnapshots.read().exportTimeTableCSV(index, (std::string) filename);
+}
+
+/**
+ * Validates a single time table
+ * 
+ * Checks types, range and increasing times of all rows. The messages
+ * are available with getValidationMessage() and getValidationErrorParams().
+ * 
+ * @param index: Index of the time table (folder) in the tree
+ * @return Bool if the time table is valid
+ */
+bool getTimeTableValidation(int index)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.validateTimeTable(index);
+	});
+}
+
+/**
+ * Computes the hash of a specification file
+ * 
+ * The specification is brought into a normalized form which does not
+ * depend on whitespaces, comments, the order of the parameters or the
+ * notation of numbers. Missing parameters get the defaults of the loaded
+ * validation file. Two specifications with the same hash lead to the
+ * same simulation.
+ * 
+ * @param filename: The absolute path to the specification file
+ * @return Bool if the file could be parsed
+ */
+bool computeSpecHash(const char* filename)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.canonicalizeSpec((std::string) filename);
+	});
+}
+
+/**
+ * Getter method for the hash of the specification
+ * 
+ * The computeSpecHash() method needs to be called first.
+ * 
+ * @return The hash (16 hexadecimal digits)
+ */
+const char* getSpecHash()
+{
+	return specSnapshots.read().specHash.c_str();
+}
+
+/**
+ * Getter method for the normalized specification
+ * 
+ * The computeSpecHash() method needs to be called first.
+ * 
+ * @return One line "path=value" per parameter
+ */
+const char* getCanonicalSpec()
+{
+	return specSnapshots.read().canonicalSpec.c_str();
+}
+
+/**
+ * Stores the hash of the specification with the output of a run
+ * 
+ * Writes "specHash.txt" into the output directory. The computeSpecHash()
+ * method needs to be called first.
+ * 
+ * @param outputDir: The output directory of the run
+ * @return Bool if the file could be written
+ */
+bool storeSpecHash(const char* outputDir)
+{
+	return specSnapshots.read().writeSpecHash((std::string) outputDir);
+}
+
+/**
+ * Searches a finished run with the same specification
+ * 
+ * The directory and all its direct subdirectories are searched for a
+ * stored hash of the specification (see storeSpecHash()). The
+ * computeSpecHash() method needs to be called first.
+ * 
+ * @param runsDir: Directory holding the output directories of all runs
+ * @return The run directory or an empty string if there is none
+ */
+const char* findCachedRun(const char* runsDir)
+{
+	cachedRunDirs.publish(std::make_shared<const std::string>(specSnapshots.read().findRunBySpecHash((std::string) runsDir)));
+	return cachedRunDirs.read().c_str();
+}
+
+/**
+ * Splits a list of specification files
+ * 
+ * @param specFiles: The paths to the specification files (one per line)
+ * @return The paths
+ */
+static std::vector<std::string> splitSpecFiles(const char* specFiles)
+{
+	std::vector<std::string> files;
+	std::string list = specFiles;
+	std::string::size_type start = 0;
+	while(start < list.size())
+	{
+		std::string::size_type end = list.find('\n', start);
+		if(end == std::string::npos)
+			end = list.size();
+		if(end > start)
+			files.push_back(list.substr(start, end-start));
+		start = end+1;
+	}
+	return files;
+}
+
+/**
+ * Plans a parameter sweep with a common warm-up
+ * 
+ * The common prefix of all variants (equal parameters, time tables
+ * equal up to their first differing row) is simulated once. Writes
+ * the specification of this warm-up run and the specifications of
+ * all variants, which restart from its checkpoint, into "sweepDir".
+ * The runs are listed by getSweepPlan().
+ * 
+ * @param specFiles: The absolute paths to the specifications of all variants (one per line)
+ * @param sweepDir: Directory for the generated specifications
+ * @return Bool if the variants have a common prefix
+ */
+bool planSweep(const char* specFiles, const char* sweepDir)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.planSweep(splitSpecFiles(specFiles), (std::string) sweepDir);
+	});
+}
+
+/**
+ * Getter method for the planned sweep
+ * 
+ * The warm-up run has to finish before the variants are started.
+ * The columns are as follows:
+ * 
+ * Col1: Name of the run (warmup, variant_1, variant_2, ...)
+ * Col2: Path to the specification
+ * Col3: Start time
+ * Col4: End time
+ * 
+ * @return One line per run
+ */
+const char* getSweepPlan()
+{
+	return specSnapshots.read().sweepPlan.c_str();
+}
+
+/**
+ * Compares two specification files parameter by parameter
+ * 
+ * Subtrees with equal hashes are skipped, rows of time tables are
+ * matched by their time. The differences are returned by getSpecDiff().
+ * 
+ * @param filenameA: The absolute path to the first specification
+ * @param filenameB: The absolute path to the second specification
+ * @return Bool if both files could be parsed
+ */
+bool diffSpecFiles(const char* filenameA, const char* filenameB)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.diffSpecFiles((std::string) filenameA, (std::string) filenameB);
+	});
+}
+
+/**
+ * Loads the specifications of all runs for diffSpecCatalog()
+ * 
+ * @param runsDir: Directory holding the output directories of all runs
+ * @param pattern: Name of the specification in a run directory (e.g. "problemSettings.lua", wildcards allowed)
+ * @return Number of runs loaded
+ */
+int loadSpecCatalog(const char* runsDir, const char* pattern)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.loadSpecCatalog((std::string) runsDir, (std::string) pattern);
+	});
+}
+
+/**
+ * Compares a specification with all runs loaded by loadSpecCatalog()
+ * 
+ * The differences are returned by getSpecDiff().
+ * 
+ * @param filename: The absolute path to the specification
+ * @return Bool if the file could be parsed
+ */
+bool diffSpecCatalog(const char* filename)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.diffSpecCatalog((std::string) filename);
+	});
+}
+
+/**
+ * Getter method for the differences of specifications
+ * 
+ * One line per changed parameter or row of a time table
+ * (e.g. "problem.feeding.timetable[t=24]"). The columns are as follows:
+ * 
+ * Col1: Path of the parameter
+ * Col2: Value in the first specification (empty if added)
+ * Col3: Value in the second specification (empty if removed)
+ * 
+ * After diffSpecCatalog() every run starts with a line
+ * "runDir\tnumberOfChanges", followed by its differences (each line
+ * starting with a tab).
+ * 
+ * @return The differences
+ */
+const char* getSpecDiff()
+{
+	return specSnapshots.read().specDiff.c_str();
+}
+
+/**
+ * Getter method for the number of children of a tree item
+ * 
+ * Together with getChildren() the tree can be built while folders
+ * are expanded instead of from the whole getValiString().
+ * 
+ * @param index: Index of the entry (-1 for the top level)
+ * @return Number of children or -1 for an invalid index
+ */
+int getChildCount(int index)
+{
+	return specSnapshots.read().childCount(index);
+}
+
+/**
+ * Whether a tree item has children
+ * 
+ * @param index: Index of the entry (-1 for the top level)
+ * @return Bool if the entry is a folder with at least one child
+ */
+bool hasChildren(int index)
+{
+	return specSnapshots.read().childCount(index) > 0;
+}
+
+/**
+ * Collect the children of a tree item
+ * 
+ * The children are read with getChildrenString().
+ * 
+ * @param index: Index of the entry (-1 for the top level)
+ * @param first: Position of the first child (e.g. 0)
+ * @param maxChildren: Maximal number of children (-1 for all)
+ * @return Number of children or -1 for an invalid index
+ */
+int getChildren(int index, int first, int maxChildren)
+{
+	std::shared_ptr<std::string> children = std::make_shared<std::string>();
+	int count = specSnapshots.read().generateChildrenString(index, first, maxChildren, *children);
+	childrenStrings.publish(children);
+	return count;
+}
+
+/**
+ * Getter method for the children of the last getChildren()
+ * 
+ * One line per child, the columns are tab separated as follows:
+ * 
+ * Col1: Index of the entry (for getChildren() and the line in getSpecString())
+ * Col2: Number of children (0 for parameters)
+ * Col3: Indentation
+ * Col4: Glyph
+ * Col5: LeftCell
+ * Col6: Type
+ * Col7: Default
+ * Col8: Value of the specification
+ * 
+ * @return The children
+ */
+const char* getChildrenString()
+{
+	return childrenStrings.read().c_str();
+}
+
+/**
+ * Validates many specification files against the loaded validation file
+ * 
+ * The validation file is parsed once (readLUATable(..., "Vali")), the
+ * specification files are checked in parallel. The loaded
+ * specification stays unchanged. The report is read with getBatchReport().
+ * 
+ * @param specFiles: The paths to the specification files (one per line)
+ * @param reportFile: File to write the report to ("" for none)
+ * @return Bool if all files are valid
+ */
+bool validateSpecBatch(const char* specFiles, const char* reportFile)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.validateSpecBatch(splitSpecFiles(specFiles), (std::string) reportFile);
+	});
+}
+
+/**
+ * Validates many specification files on a worker thread
+ * 
+ * Works like validateSpecBatch() and returns immediately. As soon as
+ * getAsyncStatus() returns "Done" (1), the report is available with
+ * getBatchReport() (also if some files are not valid).
+ * 
+ * @param specFiles: The paths to the specification files (one per line)
+ * @param reportFile: File to write the report to ("" for none)
+ * @return Ticket of the task
+ */
+int validateSpecBatchAsync(const char* specFiles, const char* reportFile)
+{
+	std::vector<std::string> files = splitSpecFiles(specFiles);
+	std::string file = reportFile;
+	std::shared_ptr<BiogasSpecValiReader> reader(new BiogasSpecValiReader(*specSnapshots.snapshot()));
+	return startAsyncTask(
+		[reader, files, file](TaskControl* control)
+		{
+			reader->validateSpecBatch(files, file, control);
+			return !control->cancelled;
+		},
+		[reader]()
+		{
+			specSnapshots.update([&](BiogasSpecValiReader& current)
+			{
+				current.batchReport = reader->batchReport;
+				return true;
+			});
+		});
+}
+
+/**
+ * Getter method for the report of the last batch validation
+ * 
+ * One line per specification file, followed by one line per error
+ * (starting with a tab). The columns are tab separated as follows:
+ * 
+ * File:  Path, status (valid, invalid, unreadable or failed), number of errors
+ * Error: Index of the parameter, path of the parameter, message (as in getValidationMessage())
+ * 
+ * @return The report
+ */
+const char* getBatchReport()
+{
+	return specSnapshots.read().batchReport.c_str();
+}
+
+/**
+ * Changes the specification of one parameter
+ * 
+ * The change is recorded in the edit history, getSpecString() returns
+ * the new specifications. Every edit, committed specification, time
+ * table change and loaded specification is one version of the history.
+ * 
+ * @param index: Index of the parameter
+ * @param spec: The new specification
+ * @return The new version or -1 for an invalid index
+ */
+int editSpecValue(int index, const char* spec)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.editSpec(index, (std::string) spec);
+	});
+}
+
+/**
+ * Records the specifications edited in LabView
+ * 
+ * All changed lines are one version of the edit history.
+ * 
+ * @param specs: The specifications (one line per entry as in getSpecString())
+ * @return The new version or -1 if the number of lines does not match
+ */
+int commitSpecValues(const char* specs)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.commitSpecs((std::string) specs);
+	});
+}
+
+/**
+ * Goes back to the previous version of the specifications
+ * 
+ * All getters (e.g. getSpecString(), getValiString(), getTimeTableString())
+ * return the data of the version afterwards.
+ * 
+ * @return The current version or -1 if there is nothing to undo
+ */
+int undoSpecEdit()
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.undoSpec();
+	});
+}
+
+/**
+ * Goes forward to the last undone version of the specifications
+ * 
+ * @return The current version or -1 if there is nothing to redo
+ */
+int redoSpecEdit()
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.redoSpec();
+	});
+}
+
+/**
+ * Goes to any version of the specifications
+ * 
+ * Versions undone and replaced by a new edit stay available.
+ * 
+ * @param version: The version (see getSpecHistory())
+ * @return Bool if the version exists
+ */
+bool checkoutSpecVersion(int version)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.checkoutSpec(version);
+	});
+}
+
+/**
+ * Getter method for the edit history
+ * 
+ * One line per version with the tab separated columns: version,
+ * version it was derived from (-1 for the first), 1 for the current
+ * version (else 0) and a description of the edit.
+ * 
+ * @return The history
+ */
+const char* getSpecHistory()
+{
+	std::shared_ptr<const std::string> history = std::make_shared<const std::string>(specSnapshots.read().specHistoryText());
+	return specHistoryStrings.publishAndRead(history).c_str();
+}
+
+/**
+ * Writes a version of the specifications into a file
+ * 
+ * The version is validated first, getValidationMessage() explains
+ * why an invalid version was not written. getOutputString() returns
+ * the written specification.
+ * 
+ * @param version: The version (see getSpecHistory())
+ * @param filename: The specification file
+ * @return Bool if the version is valid and the file could be written
+ */
+bool exportSpecVersion(int version, const char* filename)
+{
+	return specSnapshots.update([&](BiogasSpecValiReader& reader)
+	{
+		return reader.exportSpecVersion(version, (std::string) filename);
+	});
 }
 
 } //end extern "C" 
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "async_task.h"
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * Stop the task
+ *
+ * A running task is cancelled and joined.
+ */
+AsyncTask::
+~AsyncTask()
+{
+	this->cancel();
+	if(this->worker.joinable())
+		this->worker.join();
+}
+
+/**
+ * Start the task on a worker thread
+ *
+ * @param work: The method to run, returns whether it was succesfull
+ * @param publish: Method to publish the result
+ */
+void AsyncTask::
+start(std::function<bool(TaskControl*)> work, std::function<void()> publish)
+{
+	this->work = work;
+	this->publish = publish;
+	this->worker = std::thread([this]()
+	{
+		bool success = this->work(&this->control);
+		if(this->control.cancelled)
+			this->status = Cancelled;
+		else if(success)
+		{
+			this->control.progress = 100;
+			this->status = Done;
+		}
+		else
+			this->status = Failed;
+		this->finished = true;
+	});
+}
+
+/**
+ * Getter method for the status
+ *
+ * If the task finished succesfully, the result is published
+ * on the calling thread before "Done" is returned.
+ *
+ * @return The status (see AsyncTask::Status)
+ */
+int AsyncTask::
+getStatus()
+{
+	if(!this->finished)
+		return Running;
+
+	this->wait();
+	return this->status;
+}
+
+/**
+ * Request to cancel the task
+ */
+void AsyncTask::
+cancel()
+{
+	this->control.cancelled = true;
+}
+
+/**
+ * Block until the task is finished
+ *
+ * Joins the worker thread and publishes the result
+ * (only once, even if called from several threads).
+ */
+void AsyncTask::
+wait()
+{
+	std::call_once(this->finishOnce, [this]()
+	{
+		this->worker.join();
+		if(this->status == Done)
+			this->publish();
+	});
+}
+
+/**
+ * Container for all tasks by their ticket
+ */
+static std::mutex asyncTasksMutex;
+static std::map<int, std::shared_ptr<AsyncTask>> asyncTasks;
+static int lastTicket = 0;
+
+/**
+ * Start a new task
+ *
+ * @param work: The method to run
+ * @param publish: Method to publish the result
+ * @return Ticket of the task
+ */
+int startAsyncTask(std::function<bool(TaskControl*)> work, std::function<void()> publish)
+{
+	std::lock_guard<std::mutex> lock(asyncTasksMutex);
+	int ticket = ++lastTicket;
+	asyncTasks[ticket].reset(new AsyncTask());
+	asyncTasks[ticket]->start(work, publish);
+	return ticket;
+}
+
+/**
+ * Find a task by its ticket
+ *
+ * The caller shares the ownership, so the task stays valid while it
+ * is used even if it is released by another thread meanwhile.
+ *
+ * @param ticket: The ticket
+ * @return The task or nullptr
+ */
+static std::shared_ptr<AsyncTask> findAsyncTask(int ticket)
+{
+	std::lock_guard<std::mutex> lock(asyncTasksMutex);
+	std::map<int, std::shared_ptr<AsyncTask>>::iterator it = asyncTasks.find(ticket);
+	if(it == asyncTasks.end())
+		return nullptr;
+	return it->second;
+}
+
+/**
+ * Remove a task
+ *
+ * A running task is cancelled. It is joined and deleted as soon as
+ * no other thread uses it anymore.
+ *
+ * @param ticket: The ticket
+ */
+static void releaseAsyncTask(int ticket)
+{
+	std::shared_ptr<AsyncTask> task;
+	{
+		std::lock_guard<std::mutex> lock(asyncTasksMutex);
+		std::map<int, std::shared_ptr<AsyncTask>>::iterator it = asyncTasks.find(ticket);
+		if(it == asyncTasks.end())
+			return;
+		task = std::move(it->second);
+		asyncTasks.erase(it);
+	}
+	task->cancel();
+}
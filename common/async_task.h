@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "task_control.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+
+/**
+ * Class to run one method on a worker thread
+ *
+ * The method runs on its own thread and reports its progress
+ * through a TaskControl. The result is published by a second
+ * method which is called on the thread that first observes
+ * the finished task (see "getStatus()"), so results are never
+ * exchanged while LabView reads them.
+ *
+ * @param control: Progress and cancellation of the method
+ * @param status: Current status (see AsyncTask::Status)
+ * @param work: The method to run
+ * @param publish: Method to publish the result (called once on success)
+ */
+class AsyncTask {
+	public:
+		enum Status {Running = 0, Done = 1, Failed = 2, Cancelled = 3};
+
+		AsyncTask(){};
+		~AsyncTask();
+
+		TaskControl control;
+
+		void start(std::function<bool(TaskControl*)>, std::function<void()>);
+		int getStatus();
+		void cancel();
+		void wait();
+
+	private:
+		std::atomic<int> status{Running};
+		std::atomic<bool> finished{false};
+		std::once_flag finishOnce;
+		std::function<bool(TaskControl*)> work;
+		std::function<void()> publish;
+		std::thread worker;
+};
+
+int startAsyncTask(std::function<bool(TaskControl*)>, std::function<void()>);
@@ -0,0 +1,647 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "checkpoint_store.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <dirent.h>
+#include <unistd.h>
+
+static const char checkpointStoreMagic[8] = {'U', 'G', '4', 'C', 'K', 'P', 'T', 'S'};
+static const char checkpointRecordMagic[4] = {'C', 'K', 'P', 'T'};
+static const std::size_t checkpointHeaderBytes = 16;
+static const std::size_t checkpointRecordBytes = 32;
+static const std::size_t checkpointBlock = 4096;
+static const unsigned char checkpointZeroRun = 0xF0;
+
+/**
+ * Open a store
+ *
+ * Creates the file if it does not exist. An incomplete last checkpoint
+ * (e.g. of a crash while writing) is removed.
+ *
+ * @param path: The store file
+ * @param interval: Number of checkpoints from one keyframe to the next
+ * @return Bool if the file could be read or created
+ */
+bool CheckpointStore::
+open(std::string path, int interval)
+{
+	this->filepath = path;
+	this->keyframeInterval = std::max(1, interval);
+	this->records = {};
+	this->cacheIndex = -1;
+	this->cache = {};
+	this->cachePrevious = {};
+
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if(!file.good())
+	{
+		uint32_t version = 1, reserved = 0;
+		std::ofstream create(path, std::ios::binary);
+		create.write(checkpointStoreMagic, sizeof(checkpointStoreMagic));
+		create.write((const char*) &version, sizeof(version));
+		create.write((const char*) &reserved, sizeof(reserved));
+		return create.good();
+	}
+
+	uint64_t fileSize = file.tellg();
+	file.seekg(0);
+	char magic[8];
+	uint32_t version = 0, reserved = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &reserved, sizeof(reserved));
+	if(!file.good() || std::memcmp(magic, checkpointStoreMagic, sizeof(magic)) != 0 || version != 1)
+		return false;
+
+	uint64_t position = checkpointHeaderBytes;
+	while(position + checkpointRecordBytes <= fileSize)
+	{
+		char head[4];
+		uint32_t kind = 0, idLength = 0, luaLength = 0;
+		uint64_t size = 0, bytes = 0;
+		file.seekg(position);
+		file.read(head, sizeof(head));
+		file.read((char*) &kind, sizeof(kind));
+		file.read((char*) &size, sizeof(size));
+		file.read((char*) &bytes, sizeof(bytes));
+		file.read((char*) &idLength, sizeof(idLength));
+		file.read((char*) &luaLength, sizeof(luaLength));
+		if(!file.good() || std::memcmp(head, checkpointRecordMagic, sizeof(head)) != 0
+				|| position + checkpointRecordBytes + idLength + luaLength + bytes > fileSize)
+			break;
+
+		CheckpointRecord record;
+		record.id.resize(idLength);
+		record.lua.resize(luaLength);
+		file.read(&record.id[0], idLength);
+		file.read(&record.lua[0], luaLength);
+		if(!file.good())
+			break;
+		record.keyframe = (kind == 0);
+		record.size = size;
+		record.offset = position + checkpointRecordBytes + idLength + luaLength;
+		record.bytes = bytes;
+		this->records.push_back(record);
+		position = record.offset + record.bytes;
+	}
+
+	file.close();
+	if(position < fileSize)
+		return truncate(path.c_str(), position) == 0;
+	return true;
+}
+
+/**
+ * Add a checkpoint
+ *
+ * @param id: Id of the checkpoint (e.g. "100" of myCheckpoint100.ug4vec)
+ * @param lua: Content of myCheckpoint.lua belonging to the checkpoint
+ * @param values: The vector
+ * @return Bool if the checkpoint could be written and read back unchanged
+ */
+bool CheckpointStore::
+append(std::string id, const std::string& lua, const std::vector<double>& values)
+{
+	if(this->filepath.empty())
+		return false;
+	const int index = (int) this->records.size();
+	bool keyframe = index == 0 || this->records.back().size != values.size()
+		|| index - this->groupStart(index-1) >= this->keyframeInterval;
+
+	std::string payload;
+	if(keyframe)
+		payload.assign((const char*) values.data(), values.size() * sizeof(double));
+	else
+	{
+		std::vector<double> previous;
+		if(!this->read(index-1, previous))
+			return false;
+		encode(values, this->cache, this->cachePrevious, payload);
+	}
+
+	CheckpointRecord record;
+	record.id = id;
+	record.lua = lua;
+	record.keyframe = keyframe;
+	record.size = values.size();
+	record.bytes = payload.size();
+	record.offset = this->storedBytes() + checkpointRecordBytes + id.size() + lua.size();
+
+	uint32_t kind = keyframe ? 0 : 1;
+	uint32_t idLength = id.size(), luaLength = lua.size();
+	std::ofstream file(this->filepath, std::ios::binary | std::ios::app);
+	file.write(checkpointRecordMagic, sizeof(checkpointRecordMagic));
+	file.write((const char*) &kind, sizeof(kind));
+	file.write((const char*) &record.size, sizeof(record.size));
+	file.write((const char*) &record.bytes, sizeof(record.bytes));
+	file.write((const char*) &idLength, sizeof(idLength));
+	file.write((const char*) &luaLength, sizeof(luaLength));
+	file.write(id.data(), id.size());
+	file.write(lua.data(), lua.size());
+	file.write(payload.data(), payload.size());
+	file.close();
+
+	// read the checkpoint back, so the caller may delete its original
+	std::vector<double> stored;
+	if(!file.good() || !this->decode(record, this->cache, this->cachePrevious, stored)
+			|| std::memcmp(stored.data(), values.data(), values.size() * sizeof(double)) != 0)
+	{
+		truncate(this->filepath.c_str(), this->storedBytes());
+		return false;
+	}
+
+	this->records.push_back(record);
+	if(keyframe)
+		this->cachePrevious = {};
+	else
+		this->cachePrevious.swap(this->cache);
+	this->cache = values;
+	this->cacheIndex = index;
+	return true;
+}
+
+/**
+ * Reconstruct a checkpoint
+ *
+ * @param index: Index of the checkpoint
+ * @param values: The vector
+ * @return Bool if the checkpoint exists and could be decoded
+ */
+bool CheckpointStore::
+read(int index, std::vector<double>& values)
+{
+	if(index < 0 || index >= (int) this->records.size())
+		return false;
+	if(index == this->cacheIndex)
+	{
+		values = this->cache;
+		return true;
+	}
+
+	std::vector<double> previous, beforePrevious;
+	int start = this->groupStart(index);
+	if(this->cacheIndex == index-1 && !this->records[index].keyframe)
+	{
+		previous = this->cache;
+		beforePrevious = this->cachePrevious;
+		start = index;
+	}
+
+	std::vector<double> current;
+	for(int i = start; i <= index; i++)
+	{
+		if(!this->decode(this->records[i], previous, beforePrevious, current))
+		{
+			this->cacheIndex = -1;
+			return false;
+		}
+		if(this->records[i].keyframe)
+			beforePrevious = {};
+		else
+			beforePrevious.swap(previous);
+		previous.swap(current);
+	}
+
+	this->cacheIndex = index;
+	this->cache = previous;
+	this->cachePrevious = beforePrevious;
+	values = previous;
+	return true;
+}
+
+/**
+ * Find a checkpoint by its id
+ *
+ * @param id: Id of the checkpoint
+ * @return Index of the checkpoint or -1
+ */
+int CheckpointStore::
+find(const std::string& id) const
+{
+	for(int i = (int) this->records.size()-1; i >= 0; i--)
+		if(this->records[i].id == id)
+			return i;
+	return -1;
+}
+
+/**
+ * Write a checkpoint as ug4 files to restart a run
+ *
+ * Writes myCheckpoint<id>.ug4vec and myCheckpoint.lua.
+ *
+ * @param index: Index of the checkpoint
+ * @param directory: Directory of the files
+ * @return Bool if the files could be written
+ */
+bool CheckpointStore::
+restore(int index, std::string directory)
+{
+	std::vector<double> values;
+	if(!this->read(index, values))
+		return false;
+	if(!directory.empty() && directory.back() != '/')
+		directory += "/";
+
+	const CheckpointRecord& record = this->records[index];
+	if(!writeVector(directory + "myCheckpoint" + record.id + ".ug4vec", values))
+		return false;
+	if(record.lua.empty())
+		return true;
+	std::ofstream lua(directory + "myCheckpoint.lua");
+	lua << record.lua;
+	return lua.good();
+}
+
+/**
+ * Add the ug4 checkpoints of a directory to its store
+ *
+ * All myCheckpoint<id>.ug4vec files not yet in the store
+ * "myCheckpoint.ug4store" of the directory are added, numerical ids
+ * in ascending order first. myCheckpoint.lua is stored with every
+ * checkpoint (with its file name and id). Incomplete files (e.g. still
+ * written by a running simulation) are skipped, so the conversion can
+ * be repeated during a run.
+ *
+ * @param directory: Directory of the checkpoints
+ * @param removeOriginals: Bool if the .ug4vec files are deleted once they are stored
+ * @return Number of added checkpoints or -1 if the store could not be opened
+ */
+int CheckpointStore::
+convert(std::string directory, bool removeOriginals)
+{
+	if(!directory.empty() && directory.back() != '/')
+		directory += "/";
+	if(!this->open(directory + "myCheckpoint.ug4store", this->keyframeInterval))
+		return -1;
+
+	std::string luaTemplate = "";
+	std::ifstream luaFile(directory + "myCheckpoint.lua");
+	if(luaFile.good())
+	{
+		std::stringstream buffer;
+		buffer << luaFile.rdbuf();
+		luaTemplate = buffer.str();
+	}
+
+	static const std::string prefix = "myCheckpoint", extension = ".ug4vec";
+	std::vector<std::string> ids;
+	DIR* dir = opendir(directory.c_str());
+	if(dir == nullptr)
+		return -1;
+	for(struct dirent* item = readdir(dir); item != nullptr; item = readdir(dir))
+	{
+		std::string name = item->d_name;
+		if(name.size() > prefix.size() + extension.size() && name.compare(0, prefix.size(), prefix) == 0
+				&& name.compare(name.size() - extension.size(), extension.size(), extension) == 0)
+			ids.push_back(name.substr(prefix.size(), name.size() - prefix.size() - extension.size()));
+	}
+	closedir(dir);
+
+	auto numerical = [](const std::string& id)
+	{
+		return !id.empty() && id.size() < 19 && std::all_of(id.begin(), id.end(), ::isdigit);
+	};
+	std::sort(ids.begin(), ids.end(), [&](const std::string& a, const std::string& b)
+	{
+		if(numerical(a) != numerical(b))
+			return numerical(a);
+		if(numerical(a))
+			return std::stoull(a) < std::stoull(b);
+		return a < b;
+	});
+
+	int converted = 0;
+	for(const std::string& id : ids)
+	{
+		std::string filename = prefix + id + extension;
+		std::vector<double> values;
+		if(this->find(id) >= 0 || !readVector(directory + filename, values))
+			continue;
+		if(!this->append(id, checkpointLua(luaTemplate, filename, id), values))
+			break;
+		++converted;
+		if(removeOriginals)
+			std::remove((directory + filename).c_str());
+	}
+	return converted;
+}
+
+/**
+ * Size of the store file
+ *
+ * @return Number of bytes
+ */
+uint64_t CheckpointStore::
+storedBytes() const
+{
+	if(this->records.empty())
+		return checkpointHeaderBytes;
+	return this->records.back().offset + this->records.back().bytes;
+}
+
+/**
+ * Size of all checkpoints as .ug4vec files
+ *
+ * @return Number of bytes
+ */
+uint64_t CheckpointStore::
+originalBytes() const
+{
+	uint64_t bytes = 0;
+	for(const CheckpointRecord& record : this->records)
+		bytes += 16 + record.size * sizeof(double);
+	return bytes;
+}
+
+/**
+ * Read a .ug4vec file
+ *
+ * @param path: The file
+ * @param values: The vector
+ * @return Bool if the file could be read and is complete
+ */
+bool CheckpointStore::
+readVector(std::string path, std::vector<double>& values)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if(!file.good())
+		return false;
+	uint64_t fileSize = file.tellg();
+	file.seekg(0);
+
+	uint32_t version = 0, sizeField = 0;
+	uint64_t size = 0;
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &sizeField, sizeof(sizeField));
+	file.read((char*) &size, sizeof(size));
+	if(!file.good() || version != 1 || fileSize < 16 || (fileSize - 16) / sizeof(double) != size
+			|| (fileSize - 16) % sizeof(double) != 0)
+		return false;
+
+	values.resize(size);
+	file.read((char*) values.data(), size * sizeof(double));
+	return file.good();
+}
+
+/**
+ * Write a .ug4vec file
+ *
+ * @param path: The file
+ * @param values: The vector
+ * @return Bool if the file could be written
+ */
+bool CheckpointStore::
+writeVector(std::string path, const std::vector<double>& values)
+{
+	uint32_t version = 1;
+	uint64_t size = values.size();
+	uint32_t fileSize = (uint32_t) (16 + size * sizeof(double));
+	std::ofstream file(path, std::ios::binary);
+	file.write((const char*) &version, sizeof(version));
+	file.write((const char*) &fileSize, sizeof(fileSize));
+	file.write((const char*) &size, sizeof(size));
+	file.write((const char*) values.data(), size * sizeof(double));
+	return file.good();
+}
+
+/**
+ * First checkpoint of the keyframe group of a checkpoint
+ *
+ * @param index: Index of the checkpoint
+ * @return Index of the keyframe
+ */
+int CheckpointStore::
+groupStart(int index) const
+{
+	while(index > 0 && !this->records[index].keyframe)
+		--index;
+	return index;
+}
+
+/**
+ * Decode one checkpoint
+ *
+ * @param record: The checkpoint
+ * @param previous: The checkpoint before (unused for keyframes)
+ * @param beforePrevious: The checkpoint before "previous" (empty if it belongs to an earlier keyframe)
+ * @param values: The vector
+ * @return Bool if the checkpoint could be read and is consistent
+ */
+bool CheckpointStore::
+decode(const CheckpointRecord& record, const std::vector<double>& previous,
+	const std::vector<double>& beforePrevious, std::vector<double>& values) const
+{
+	std::string payload(record.bytes, '\0');
+	std::ifstream file(this->filepath, std::ios::binary);
+	file.seekg(record.offset);
+	file.read(&payload[0], record.bytes);
+	if(!file.good())
+		return false;
+
+	const std::size_t n = record.size;
+	values.resize(n);
+	if(record.keyframe)
+	{
+		if(record.bytes != n * sizeof(double))
+			return false;
+		std::memcpy(values.data(), payload.data(), record.bytes);
+		return true;
+	}
+	if(previous.size() != n)
+		return false;
+
+	const unsigned char* pos = (const unsigned char*) payload.data();
+	const unsigned char* end = pos + payload.size();
+	for(std::size_t start = 0; start < n; start += checkpointBlock)
+	{
+		const std::size_t count = std::min(checkpointBlock, n - start);
+		if(end - pos < 5)
+			return false;
+		const bool linear = (*pos++ == 1);
+		uint32_t length;
+		std::memcpy(&length, pos, sizeof(length));
+		pos += sizeof(length);
+		if(length > (std::size_t) (end - pos) || (linear && beforePrevious.size() != n))
+			return false;
+		const unsigned char* blockEnd = pos + length;
+
+		for(std::size_t i = start; i < start + count; )
+		{
+			if(pos >= blockEnd)
+				return false;
+			unsigned char control = *pos++;
+			uint64_t run = 1, residual = 0;
+			if(control == checkpointZeroRun)
+			{
+				run = 0;
+				for(int shift = 0; ; shift += 7)
+				{
+					if(pos >= blockEnd || shift > 63)
+						return false;
+					run |= (uint64_t) (*pos & 0x7F) << shift;
+					if(!(*pos++ & 0x80))
+						break;
+				}
+				if(run == 0 || run > start + count - i)
+					return false;
+			}
+			else
+			{
+				int lead = control >> 4, trail = control & 15;
+				int bytes = 8 - lead - trail;
+				if(bytes <= 0 || blockEnd - pos < bytes)
+					return false;
+				for(int b = 0; b < bytes; b++)
+					residual |= (uint64_t) pos[b] << (8 * (trail + b));
+				pos += bytes;
+			}
+
+			for(uint64_t k = 0; k < run; k++, i++)
+			{
+				double predicted = linear ? 2 * previous[i] - beforePrevious[i] : previous[i];
+				uint64_t bits;
+				std::memcpy(&bits, &predicted, sizeof(bits));
+				bits ^= residual;
+				std::memcpy(&values[i], &bits, sizeof(bits));
+			}
+		}
+		pos = blockEnd;
+	}
+	return pos == end;
+}
+
+/**
+ * Encode a checkpoint as delta to the previous ones
+ *
+ * @param values: The vector
+ * @param previous: The checkpoint before
+ * @param beforePrevious: The checkpoint before "previous" (empty: only the previous values are used as prediction)
+ * @param payload: The encoded vector
+ */
+void CheckpointStore::
+encode(const std::vector<double>& values, const std::vector<double>& previous,
+	const std::vector<double>& beforePrevious, std::string& payload)
+{
+	const std::size_t n = values.size();
+	const bool linear = (beforePrevious.size() == n);
+	payload = "";
+	std::string constant, extrapolated;
+	for(std::size_t start = 0; start < n; start += checkpointBlock)
+	{
+		const std::size_t count = std::min(checkpointBlock, n - start);
+		constant = "";
+		encodeBlock(&values[start], &previous[start], nullptr, count, constant);
+		if(linear)
+		{
+			extrapolated = "";
+			encodeBlock(&values[start], &previous[start], &beforePrevious[start], count, extrapolated);
+			if(extrapolated.size() < constant.size())
+				constant.swap(extrapolated);
+		}
+		payload += constant;
+	}
+}
+
+/**
+ * Encode a block of values
+ *
+ * Every value is XORed with its prediction. Runs of zero residuals are
+ * stored as control byte 0xF0 and the length (7 bits per byte), other
+ * residuals as control byte (leading zero bytes * 16 + trailing zero
+ * bytes) and the bytes in between.
+ *
+ * @param values: The values
+ * @param previous: The values of the checkpoint before
+ * @param beforePrevious: The values before "previous" (nullptr: predict the previous values)
+ * @param count: Number of values
+ * @param block: String to append the block (prediction, length, data) to
+ */
+void CheckpointStore::
+encodeBlock(const double* values, const double* previous, const double* beforePrevious,
+	std::size_t count, std::string& block)
+{
+	std::size_t header = block.size();
+	block.push_back(beforePrevious != nullptr ? 1 : 0);
+	block.append(sizeof(uint32_t), '\0');
+
+	uint64_t run = 0;
+	auto flushRun = [&]()
+	{
+		if(run == 0)
+			return;
+		block.push_back((char) checkpointZeroRun);
+		for(; run >= 0x80; run >>= 7)
+			block.push_back((char) ((run & 0x7F) | 0x80));
+		block.push_back((char) run);
+		run = 0;
+	};
+
+	for(std::size_t i = 0; i < count; i++)
+	{
+		double predicted = (beforePrevious != nullptr) ? 2 * previous[i] - beforePrevious[i] : previous[i];
+		uint64_t a, b;
+		std::memcpy(&a, &values[i], sizeof(a));
+		std::memcpy(&b, &predicted, sizeof(b));
+		uint64_t residual = a ^ b;
+		if(residual == 0)
+		{
+			++run;
+			continue;
+		}
+		flushRun();
+
+		int lead = __builtin_clzll(residual) / 8;
+		int trail = __builtin_ctzll(residual) / 8;
+		block.push_back((char) ((lead << 4) | trail));
+		for(int k = trail; k < 8 - lead; k++)
+			block.push_back((char) ((residual >> (8 * k)) & 0xFF));
+	}
+	flushRun();
+
+	uint32_t length = block.size() - header - 1 - sizeof(uint32_t);
+	std::memcpy(&block[header + 1], &length, sizeof(length));
+}
+
+/**
+ * myCheckpoint.lua of a stored checkpoint
+ *
+ * @param lua: Content of the current myCheckpoint.lua
+ * @param filename: File name of the checkpoint
+ * @param id: Id of the checkpoint
+ * @return The content with "lastFilename" and "lastId" of the checkpoint
+ */
+std::string CheckpointStore::
+checkpointLua(const std::string& lua, const std::string& filename, const std::string& id)
+{
+	std::string result = lua;
+	for(const std::pair<std::string, std::string>& field :
+			{std::make_pair(std::string("checkpoint[\"lastFilename\"] = \""), filename),
+			std::make_pair(std::string("checkpoint[\"lastId\"] = \""), id)})
+	{
+		std::string::size_type begin = result.find(field.first);
+		if(begin == std::string::npos)
+			continue;
+		begin += field.first.size();
+		std::string::size_type end = result.find('"', begin);
+		if(end != std::string::npos)
+			result.replace(begin, end - begin, field.second);
+	}
+	return result;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Class to describe one checkpoint in a CheckpointStore
+ *
+ * @param id: Id of the checkpoint (e.g. "100" or "SimulationEnd" of myCheckpoint100.ug4vec)
+ * @param lua: Content of myCheckpoint.lua belonging to the checkpoint
+ * @param keyframe: Whether the vector is stored in full (else as delta to the previous one)
+ * @param size: Number of doubles
+ * @param offset: Position of the encoded vector in the file
+ * @param bytes: Size of the encoded vector
+ */
+class CheckpointRecord {
+	public:
+		CheckpointRecord(){};
+
+		std::string id = "";
+		std::string lua = "";
+		bool keyframe = true;
+		uint64_t size = 0;
+		uint64_t offset = 0;
+		uint64_t bytes = 0;
+};
+
+/**
+ * Class to store a series of ug4 checkpoints compactly
+ *
+ * Consecutive checkpoints of a run (.ug4vec: uint32 1, uint32 size of
+ * the file, uint64 number of doubles, followed by the doubles) differ
+ * only slightly. All checkpoints of a run are appended to one file;
+ * every "keyframeInterval"-th vector (and every vector whose size
+ * changed) is stored in full, the others as XOR of their bits with a
+ * prediction from the previous vectors. The XOR of two close doubles
+ * has many zero bytes, which are left out: every value is stored as a
+ * control byte (number of leading and trailing zero bytes) followed by
+ * the remaining bytes, runs of unchanged values as one control byte
+ * and their count. The prediction (previous value or linear
+ * extrapolation of the two previous ones) is chosen per block of 4096
+ * values, whichever gives fewer bytes. The compression is lossless.
+ *
+ * Reading a checkpoint decodes at most "keyframeInterval" vectors from
+ * the keyframe before it; reading consecutive checkpoints decodes only
+ * one vector each.
+ *
+ * @param filepath: The store file
+ * @param keyframeInterval: Number of checkpoints from one keyframe to the next
+ * @param records: All checkpoints in the order they were added
+ * @param cacheIndex: Index of the checkpoint in "cache" (-1 for none)
+ * @param cache: The last checkpoint read or added
+ * @param cachePrevious: The checkpoint before (empty if it belongs to an earlier keyframe)
+ */
+class CheckpointStore {
+	public:
+		CheckpointStore(){};
+
+		std::string filepath = "";
+		int keyframeInterval = 16;
+		std::vector<CheckpointRecord> records;
+
+		bool open(std::string, int);
+		bool append(std::string, const std::string&, const std::vector<double>&);
+		bool read(int, std::vector<double>&);
+		int find(const std::string&) const;
+		bool restore(int, std::string);
+		int convert(std::string, bool);
+		uint64_t storedBytes() const;
+		uint64_t originalBytes() const;
+
+		static bool readVector(std::string, std::vector<double>&);
+		static bool writeVector(std::string, const std::vector<double>&);
+
+	private:
+		int cacheIndex = -1;
+		std::vector<double> cache;
+		std::vector<double> cachePrevious;
+
+		int groupStart(int) const;
+		bool decode(const CheckpointRecord&, const std::vector<double>&, const std::vector<double>&, std::vector<double>&) const;
+		static void encode(const std::vector<double>&, const std::vector<double>&, const std::vector<double>&, std::string&);
+		static void encodeBlock(const double*, const double*, const double*, std::size_t, std::string&);
+		static std::string checkpointLua(const std::string&, const std::string&, const std::string&);
+};
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "console_capture.h"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/**
+ * Kill the process and stop the reader thread
+ */
+ConsoleCapture::
+~ConsoleCapture()
+{
+	if(this->pid > 0 && this->exitCode < 0)
+		kill(-this->pid, SIGKILL);
+	this->stopping = true;
+	if(this->reader.joinable())
+		this->reader.join();
+}
+
+/**
+ * Start a process
+ *
+ * The command line is run by /bin/sh in its own process group, so
+ * stop() also reaches processes started by it (e.g. mpirun).
+ *
+ * @param commandline: The command line (e.g. "ugshell -ex Biogas.lua -p spec.lua")
+ * @param workingDir: Working directory of the process ("" for the current one)
+ * @param capacity: Size of the ring in bytes
+ * @param maxLines: Number of lines in the ring
+ * @return Bool if the process could be started
+ */
+bool ConsoleCapture::
+start(std::string commandline, std::string workingDir, int capacity, int maxLines)
+{
+	if(this->pid > 0 || capacity < 1024 || maxLines < 1)
+		return false;
+	this->text.assign(capacity, '\0');
+	this->index.assign(maxLines, ConsoleLine());
+
+	int fds[2];
+	if(::pipe(fds) != 0)
+		return false;
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+	this->pid = fork();
+	if(this->pid < 0)
+	{
+		::close(fds[0]);
+		::close(fds[1]);
+		return false;
+	}
+	if(this->pid == 0)
+	{
+		setpgid(0, 0);
+		dup2(fds[1], STDOUT_FILENO);
+		dup2(fds[1], STDERR_FILENO);
+		::close(fds[1]);
+		if(!workingDir.empty() && chdir(workingDir.c_str()) != 0)
+			_exit(127);
+		execl("/bin/sh", "sh", "-c", commandline.c_str(), (char*) nullptr);
+		_exit(127);
+	}
+
+	setpgid(this->pid, this->pid);
+	::close(fds[1]);
+	this->pipe = fds[0];
+	this->reader = std::thread(&ConsoleCapture::read, this);
+	return true;
+}
+
+/**
+ * Terminate the process
+ *
+ * The output written until then stays available.
+ */
+void ConsoleCapture::
+stop()
+{
+	if(this->pid > 0 && this->exitCode < 0)
+		kill(-this->pid, SIGTERM);
+}
+
+/**
+ * Read the pipe until the process closed it (reader thread)
+ *
+ * Waits for the process afterwards to get its exit code.
+ */
+void ConsoleCapture::
+read()
+{
+	char buffer[4096];
+	struct pollfd request = {this->pipe, POLLIN, 0};
+	while(true)
+	{
+		int ready = poll(&request, 1, 200);
+		if(ready == 0 && this->stopping)
+			break;
+		if(ready <= 0)
+			continue;
+		ssize_t count = ::read(this->pipe, buffer, sizeof(buffer));
+		if(count <= 0)
+			break;
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->append(buffer, count);
+	}
+	::close(this->pipe);
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if(this->written > this->lineStart)
+			this->commitLine();
+	}
+
+	int status = 0;
+	if(waitpid(this->pid, &status, 0) != this->pid)
+		this->exitCode = 127;
+	else if(WIFSIGNALED(status))
+		this->exitCode = 128 + WTERMSIG(status);
+	else
+		this->exitCode = WEXITSTATUS(status);
+}
+
+/**
+ * Append output to the ring
+ *
+ * Lines longer than a quarter of the ring are split, so one
+ * line never drops all others.
+ *
+ * @param data: The output
+ * @param count: Number of bytes
+ */
+void ConsoleCapture::
+append(const char* data, std::size_t count)
+{
+	const uint64_t capacity = this->text.size();
+	for(std::size_t i=0; i<count; i++)
+	{
+		if(data[i] == '\n')
+		{
+			this->commitLine();
+			continue;
+		}
+		if(data[i] == '\r')
+			continue;
+		this->text[this->written % capacity] = data[i];
+		++this->written;
+		if(this->written - this->lineStart >= capacity/4)
+			this->commitLine();
+	}
+
+	while(this->firstLine < this->numLines
+		&& this->index[this->firstLine % this->index.size()].begin + capacity < this->written)
+		++this->firstLine;
+}
+
+/**
+ * Add the incomplete last line to the index
+ *
+ * Drops the oldest line if the index is full and parses the
+ * simulated time.
+ */
+void ConsoleCapture::
+commitLine()
+{
+	ConsoleLine line;
+	line.begin = this->lineStart;
+	line.length = (uint32_t) (this->written - this->lineStart);
+	if(this->numLines - this->firstLine == this->index.size())
+		++this->firstLine;
+	this->index[this->numLines % this->index.size()] = line;
+	++this->numLines;
+	this->lineStart = this->written;
+
+	if(this->progressPattern.empty() || line.length < this->progressPattern.size())
+		return;
+	std::string content = this->lineText(line);
+	std::string::size_type pos = content.find(this->progressPattern);
+	if(pos == std::string::npos)
+		return;
+	const char* number = content.c_str() + pos + this->progressPattern.size();
+	char* end;
+	double time = std::strtod(number, &end);
+	if(end != number)
+		this->simulatedTime = time;
+}
+
+/**
+ * Text of a line in the ring
+ *
+ * @param line: The line
+ * @return The text
+ */
+std::string ConsoleCapture::
+lineText(const ConsoleLine& line) const
+{
+	const uint64_t capacity = this->text.size();
+	std::size_t offset = line.begin % capacity;
+	std::size_t first = std::min<uint64_t>(line.length, capacity - offset);
+	std::string result(&this->text[offset], first);
+	result.append(&this->text[0], line.length - first);
+	return result;
+}
+
+/**
+ * Fetch new lines
+ *
+ * Lines dropped from the ring before they were fetched are skipped
+ * and counted in "lostLines()".
+ *
+ * @param cursor: Number of the first line to fetch (0 for the start, the last returned cursor for new lines)
+ * @param maxLines: Maximal number of lines
+ * @return The cursor behind the last fetched line
+ */
+uint64_t ConsoleCapture::
+fetchLines(uint64_t cursor, int maxLines)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->lines = "";
+	if(cursor < this->firstLine)
+	{
+		this->lost += this->firstLine - cursor;
+		cursor = this->firstLine;
+	}
+	for(int i=0; i<maxLines && cursor < this->numLines; i++, cursor++)
+	{
+		this->lines += this->lineText(this->index[cursor % this->index.size()]);
+		this->lines += "\n";
+	}
+	return cursor;
+}
+
+/**
+ * Number of complete lines of the whole run
+ *
+ * @return Number of lines (the cursor behind the newest line)
+ */
+uint64_t ConsoleCapture::
+lineCount()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->numLines;
+}
+
+/**
+ * Number of lines dropped before they were fetched
+ *
+ * @return Number of lines
+ */
+uint64_t ConsoleCapture::
+lostLines()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->lost;
+}
+
+/**
+ * Progress of the simulation
+ *
+ * @return Simulated time relative to startTime..endTime in percent or -1 if unknown
+ */
+int ConsoleCapture::
+getProgress() const
+{
+	double time = this->simulatedTime;
+	if(std::isnan(time) || this->endTime <= this->startTime)
+		return -1;
+	double progress = 100 * (time - this->startTime) / (this->endTime - this->startTime);
+	return (int) std::max(0.0, std::min(100.0, progress));
+}
+
+/**
+ * Container for all captures by their handle
+ *
+ * The functions of the wrapper hold a reference while they use a
+ * capture, so a capture released by another thread stays valid
+ * until they return.
+ */
+static const int maxConsoleCaptures = 16;
+static std::mutex consoleCapturesMutex;
+static std::shared_ptr<ConsoleCapture> consoleCaptureSlots[maxConsoleCaptures];
+
+/**
+ * Register a capture
+ *
+ * @param capture: The capture (owned by the registry afterwards)
+ * @return Handle of the capture or -1 if all slots are used
+ */
+int addConsoleCapture(ConsoleCapture* capture)
+{
+	std::shared_ptr<ConsoleCapture> owned(capture);
+	std::lock_guard<std::mutex> lock(consoleCapturesMutex);
+	for(int i=0; i<maxConsoleCaptures; i++)
+	{
+		if(!consoleCaptureSlots[i])
+		{
+			consoleCaptureSlots[i] = owned;
+			return i+1;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Find a capture by its handle
+ *
+ * @param handle: The handle
+ * @return The capture or nullptr
+ */
+static std::shared_ptr<ConsoleCapture> findConsoleCapture(int handle)
+{
+	if(handle < 1 || handle > maxConsoleCaptures)
+		return nullptr;
+	std::lock_guard<std::mutex> lock(consoleCapturesMutex);
+	return consoleCaptureSlots[handle-1];
+}
+
+/**
+ * Remove a capture
+ *
+ * A running process is terminated as soon as no other thread uses
+ * the capture any more.
+ *
+ * @param handle: The handle
+ */
+static void removeConsoleCapture(int handle)
+{
+	if(handle < 1 || handle > maxConsoleCaptures)
+		return;
+	std::shared_ptr<ConsoleCapture> capture;
+	{
+		std::lock_guard<std::mutex> lock(consoleCapturesMutex);
+		capture.swap(consoleCaptureSlots[handle-1]);
+	}
+}
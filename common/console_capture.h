@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * Class to describe one line in the ring of a ConsoleCapture
+ *
+ * @param begin: Offset of the first byte in the whole output
+ * @param length: Number of bytes (without '\n')
+ */
+class ConsoleLine {
+	public:
+		ConsoleLine(){};
+
+		uint64_t begin = 0;
+		uint32_t length = 0;
+};
+
+/**
+ * Class to run a process and capture its console output
+ *
+ * The process (e.g. ugshell) runs with stdout and stderr connected
+ * to one pipe, which is read by a background thread into a ring of
+ * "capacity" bytes with an index of the last "maxLines" lines. So the
+ * memory stays constant no matter how long the process runs; the
+ * oldest lines are dropped when the ring is full. Lines are numbered
+ * from 0 over the whole run and fetched by a cursor (the number of
+ * the next line to read), so a caller never reads a line twice.
+ *
+ * Lines containing "progressPattern" followed by a number (e.g.
+ * "++++++ TIMESTEP 5 BEGIN (current time: 1.0) ++++++") give the
+ * current simulated time.
+ *
+ * @param lines: Text of the last fetchLines() (lines separated by '\n')
+ * @param progressPattern: Text in front of the simulated time ("" to disable, set before start())
+ * @param startTime: Simulated time at 0% progress
+ * @param endTime: Simulated time at 100% progress
+ * @param pid: Process id (-1 if not started)
+ * @param pipe: Read end of the pipe
+ * @param exitCode: Exit code (-1 while running, 128+n if killed by signal n)
+ * @param stopping: Whether the reader thread has to stop (even if the pipe is still open)
+ * @param reader: The reader thread
+ * @param text: The ring of bytes
+ * @param index: The ring of lines
+ * @param written: Number of bytes written into the ring
+ * @param lineStart: Offset of the incomplete last line
+ * @param firstLine: Number of the oldest line in the ring
+ * @param numLines: Number of complete lines
+ * @param lost: Number of lines dropped before they were fetched
+ * @param simulatedTime: Last simulated time (NaN if none was found)
+ */
+class ConsoleCapture {
+	public:
+		ConsoleCapture(){};
+		~ConsoleCapture();
+
+		std::string lines = "";
+		std::string progressPattern = "current time:";
+		double startTime = 0.0;
+		double endTime = 0.0;
+
+		bool start(std::string, std::string, int, int);
+		void stop();
+
+		uint64_t fetchLines(uint64_t, int);
+		uint64_t lineCount();
+		uint64_t lostLines();
+		double getSimulatedTime() const { return this->simulatedTime; }
+		int getProgress() const;
+		int getExitCode() const { return this->exitCode; }
+
+	private:
+		pid_t pid = -1;
+		int pipe = -1;
+		std::atomic<int> exitCode{-1};
+		std::atomic<bool> stopping{false};
+		std::thread reader;
+
+		std::mutex mutex;
+		std::vector<char> text;
+		std::vector<ConsoleLine> index;
+		uint64_t written = 0;
+		uint64_t lineStart = 0;
+		uint64_t firstLine = 0;
+		uint64_t numLines = 0;
+		uint64_t lost = 0;
+		std::atomic<double> simulatedTime{std::numeric_limits<double>::quiet_NaN()};
+
+		void read();
+		void append(const char*, std::size_t);
+		void commitLine();
+		std::string lineText(const ConsoleLine&) const;
+};
+
+int addConsoleCapture(ConsoleCapture*);
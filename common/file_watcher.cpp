@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "file_watcher.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+static const uint32_t fileWatcherMask = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO;
+
+/**
+ * Whether a file of the output directory belongs to a checkpoint
+ *
+ * @param name: Name of the file
+ * @return Bool if it is a .ug4vec file or myCheckpoint.lua
+ */
+static bool isCheckpointFile(const std::string& name)
+{
+	static const std::string extension = ".ug4vec";
+	return name == "myCheckpoint.lua" || (name.size() > extension.size()
+		&& name.compare(name.size() - extension.size(), extension.size(), extension) == 0);
+}
+
+/**
+ * Split a path into its absolute directory and the filename
+ *
+ * @param path: The path
+ * @param directory: The absolute directory (with trailing '/')
+ * @param name: The filename
+ * @return Bool if the directory exists
+ */
+static bool splitWatchedPath(const std::string& path, std::string& directory, std::string& name)
+{
+	std::string::size_type slash = path.find_last_of('/');
+	std::string parent = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+	name = (slash == std::string::npos) ? path : path.substr(slash+1);
+
+	char resolved[PATH_MAX];
+	if(realpath(parent.c_str(), resolved) == nullptr)
+		return false;
+	directory = resolved;
+	if(directory.back() != '/')
+		directory += "/";
+	return true;
+}
+
+/**
+ * Stop the background thread
+ */
+FileWatcher::
+~FileWatcher()
+{
+	this->stop();
+}
+
+/**
+ * Start watching an output directory
+ *
+ * @param directory: The output directory
+ * @return Bool if the directory could be watched
+ */
+bool FileWatcher::
+start(std::string directory)
+{
+	if(this->fd >= 0)
+		return false;
+	this->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(this->fd < 0)
+		return false;
+
+	std::string name;
+	if(!splitWatchedPath(directory + "/.", this->outputDirectory, name)
+		|| this->watchDirectory(this->outputDirectory) < 0)
+	{
+		close(this->fd);
+		this->fd = -1;
+		return false;
+	}
+	this->worker = std::thread(&FileWatcher::run, this);
+	return true;
+}
+
+/**
+ * Watch a specification or validation file
+ *
+ * Its directory is watched, so replacing the file is noticed as well.
+ *
+ * @param path: The path to the file
+ * @return Bool if the directory of the file could be watched
+ */
+bool FileWatcher::
+watchFile(std::string path)
+{
+	std::string directory, name;
+	if(this->fd < 0 || !splitWatchedPath(path, directory, name) || this->watchDirectory(directory) < 0)
+		return false;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->files.insert(directory + name);
+	return true;
+}
+
+/**
+ * Add an inotify watch to a directory
+ *
+ * @param directory: The absolute directory (with trailing '/')
+ * @return The watch descriptor or -1
+ */
+int FileWatcher::
+watchDirectory(std::string directory)
+{
+	int wd = inotify_add_watch(this->fd, directory.c_str(), fileWatcherMask);
+	if(wd < 0)
+		return -1;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->directories[wd] = directory;
+	return wd;
+}
+
+/**
+ * Stop watching
+ *
+ * Events still in the queue can be taken.
+ */
+void FileWatcher::
+stop()
+{
+	this->stopping = true;
+	if(this->worker.joinable())
+		this->worker.join();
+	if(this->fd >= 0)
+		close(this->fd);
+	this->fd = -1;
+}
+
+/**
+ * Read the inotify events (background thread)
+ */
+void FileWatcher::
+run()
+{
+	alignas(struct inotify_event) char buffer[16384];
+	struct pollfd request = {this->fd, POLLIN, 0};
+	while(!this->stopping)
+	{
+		int timeout = 200;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if(!this->collected.empty())
+			{
+				long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+					std::chrono::steady_clock::now() - this->windowStart).count();
+				if(elapsed >= this->coalesceTime)
+				{
+					this->flush();
+					continue;
+				}
+				timeout = std::min<long long>(timeout, this->coalesceTime - elapsed);
+			}
+		}
+
+		if(poll(&request, 1, timeout) <= 0)
+			continue;
+		ssize_t length = read(this->fd, buffer, sizeof(buffer));
+		for(char* pos = buffer; length > 0 && pos < buffer + length; )
+		{
+			const struct inotify_event* event = (const struct inotify_event*) pos;
+			pos += sizeof(struct inotify_event) + event->len;
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if(event->mask & IN_Q_OVERFLOW)
+			{
+				this->collect(Overflow, "");
+				continue;
+			}
+			std::map<int, std::string>::const_iterator directory = this->directories.find(event->wd);
+			if(directory == this->directories.end() || event->len == 0)
+				continue;
+			std::string name = event->name;
+			std::string path = directory->second + name;
+
+			if(this->files.count(path) > 0)
+			{
+				if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+					this->collect(SpecModified, path);
+			}
+			else if(directory->second != this->outputDirectory)
+				continue;
+			else if(isCheckpointFile(name))
+			{
+				if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+					this->collect(CheckpointWritten, path);
+			}
+			else if(event->mask & (IN_CREATE | IN_MOVED_TO))
+				this->collect(Created, path);
+			else if(event->mask & IN_MODIFY)
+				this->collect(Appended, path);
+		}
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->flush();
+}
+
+/**
+ * Add a change to the coalescing window
+ *
+ * Rows appended to a file created in the same window are part of
+ * the creation.
+ *
+ * @param type: Type of the change
+ * @param path: The absolute path to the file
+ */
+void FileWatcher::
+collect(int type, const std::string& path)
+{
+	if(this->collected.empty())
+		this->windowStart = std::chrono::steady_clock::now();
+	for(FileEvent& event : this->collected)
+	{
+		if(event.path == path && (event.type == type || (type == Appended && event.type == Created)))
+		{
+			++event.count;
+			return;
+		}
+	}
+	FileEvent event;
+	event.type = type;
+	event.path = path;
+	event.count = 1;
+	this->collected.push_back(event);
+}
+
+/**
+ * Move the changes of the coalescing window into the queue
+ *
+ * A change equal to a queued event is merged into it (as appended
+ * rows into a queued creation).
+ */
+void FileWatcher::
+flush()
+{
+	for(const FileEvent& change : this->collected)
+	{
+		std::deque<FileEvent>::iterator queued = std::find_if(this->events.begin(), this->events.end(),
+			[&change](const FileEvent& event) { return event.path == change.path
+				&& (event.type == change.type || (change.type == Appended && event.type == Created)); });
+		if(queued != this->events.end())
+			queued->count += change.count;
+		else
+			this->events.push_back(change);
+	}
+	this->collected = {};
+}
+
+/**
+ * Take the oldest event of the queue
+ *
+ * @param event: The event (unchanged if the queue is empty)
+ * @return Type of the event (see FileWatcher::EventType) or -1 if the queue is empty
+ */
+int FileWatcher::
+next(FileEvent& event)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if(this->events.empty())
+		return -1;
+	event = this->events.front();
+	this->events.pop_front();
+	return event.type;
+}
+
+/**
+ * Number of events in the queue
+ *
+ * @return Number of events
+ */
+int FileWatcher::
+pending()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return (int) this->events.size();
+}
+
+static std::mutex fileWatcherMutex;
+static std::shared_ptr<FileWatcher> fileWatcher;
+static std::vector<std::string> loadedFiles;
+
+/**
+ * Watch a loaded specification or validation file
+ *
+ * Called by the readers for every file they load. The files are
+ * remembered and watched as soon as a watcher is running.
+ *
+ * @param path: The path to the file
+ */
+void watchLoadedFile(std::string path)
+{
+	std::lock_guard<std::mutex> lock(fileWatcherMutex);
+	if(std::find(loadedFiles.begin(), loadedFiles.end(), path) == loadedFiles.end())
+		loadedFiles.push_back(path);
+	if(fileWatcher)
+		fileWatcher->watchFile(path);
+}
+
+/**
+ * Replace the running watcher
+ *
+ * All loaded specification and validation files are watched by the new one.
+ *
+ * @param watcher: The new watcher (already started, or empty to stop watching)
+ */
+static void setFileWatcher(std::shared_ptr<FileWatcher> watcher)
+{
+	std::lock_guard<std::mutex> lock(fileWatcherMutex);
+	fileWatcher = watcher;
+	if(fileWatcher)
+		for(const std::string& path : loadedFiles)
+			fileWatcher->watchFile(path);
+}
+
+/**
+ * Getter method for the running watcher
+ *
+ * @return The watcher (empty if none is running)
+ */
+static std::shared_ptr<FileWatcher> getFileWatcher()
+{
+	std::lock_guard<std::mutex> lock(fileWatcherMutex);
+	return fileWatcher;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Class to hold one (coalesced) change of a file
+ *
+ * @param type: Type of the change (see FileWatcher::EventType)
+ * @param path: The absolute path to the file
+ * @param count: Number of changes merged into this event
+ */
+class FileEvent {
+	public:
+		FileEvent(){};
+
+		int type = 0;
+		std::string path = "";
+		int count = 0;
+};
+
+/**
+ * Class to watch a run directory and specification files with inotify
+ *
+ * Changes in the output directory become "Appended" (rows were
+ * written), "Created" (a new file) or "CheckpointWritten" (a .ug4vec
+ * file or myCheckpoint.lua was completely written). Changes of
+ * watched specification or validation files become "SpecModified",
+ * also if an editor replaces the file by renaming a new one.
+ *
+ * A background thread collects the changes of "coalesceTime"
+ * milliseconds and merges equal changes of the same file. An event
+ * which is still queued absorbs later equal changes, so the queue
+ * never holds more than one event of a type per file. "Overflow"
+ * means that changes were lost and all data should be read again.
+ *
+ * @param coalesceTime: Time to collect changes in milliseconds
+ * @param fd: The inotify instance
+ * @param stopping: Whether the background thread has to stop
+ * @param worker: The background thread
+ * @param outputDirectory: The watched output directory (absolute, with trailing '/')
+ * @param directories: Watched directories by watch descriptor
+ * @param files: Watched specification files
+ * @param collected: Changes within the current coalescing window
+ * @param windowStart: Time of the first change in the window
+ * @param events: The queue
+ */
+class FileWatcher {
+	public:
+		enum EventType {Overflow = 0, Appended = 1, Created = 2, CheckpointWritten = 3, SpecModified = 4};
+
+		FileWatcher(){};
+		~FileWatcher();
+
+		int coalesceTime = 100;
+
+		bool start(std::string);
+		bool watchFile(std::string);
+		void stop();
+
+		int next(FileEvent&);
+		int pending();
+
+	private:
+		int fd = -1;
+		std::atomic<bool> stopping{false};
+		std::thread worker;
+
+		std::mutex mutex;
+		std::string outputDirectory = "";
+		std::map<int, std::string> directories;
+		std::set<std::string> files;
+		std::vector<FileEvent> collected;
+		std::chrono::steady_clock::time_point windowStart;
+		std::deque<FileEvent> events;
+
+		int watchDirectory(std::string);
+		void run();
+		void collect(int, const std::string&);
+		void flush();
+};
+
+void watchLoadedFile(std::string);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/**
+ * Fixed-layout result buffers for LabView
+ *
+ * A result buffer is one block of memory with a header, an array of
+ * records and a string arena. Strings are referenced by their offset
+ * into the arena (and are additionally terminated by '\0'), so names
+ * and units may contain whitespaces. All fields are 32 bit integers,
+ * the layout does not depend on the compiler.
+ *
+ * Layout: [BiogasResultBuffer][records ...][arena ...]
+ *
+ * A buffer is created with a single allocation and has to be
+ * released with releaseResultBuffer().
+ */
+extern "C" {
+
+/**
+ * Reference to a string in the arena
+ *
+ * @param offset: Offset of the first character in the arena
+ * @param length: Number of characters (without '\0')
+ */
+struct BiogasStringRef {
+	uint32_t offset;
+	uint32_t length;
+};
+
+/**
+ * Header of a result buffer
+ *
+ * @param numRecords: Number of records
+ * @param recordSize: Size of one record in bytes
+ * @param recordsOffset: Offset of the first record from the start of the buffer
+ * @param arenaOffset: Offset of the string arena from the start of the buffer
+ * @param arenaSize: Size of the string arena in bytes
+ */
+struct BiogasResultBuffer {
+	uint32_t numRecords;
+	uint32_t recordSize;
+	uint32_t recordsOffset;
+	uint32_t arenaOffset;
+	uint32_t arenaSize;
+	uint32_t reserved;
+};
+
+/**
+ * One row of the Plot-Tree (see getTreeString())
+ */
+struct BiogasTreeRecord {
+	int32_t indent;
+	int32_t glyph;
+	BiogasStringRef leftCell;
+};
+
+/**
+ * One plottable parameter (see getPlotString())
+ *
+ * Columns are -1 if they are not given (e.g. for folders).
+ */
+struct BiogasPlotRecord {
+	BiogasStringRef leftCell;
+	BiogasStringRef unit;
+	BiogasStringRef filename;
+	BiogasStringRef xValueName;
+	BiogasStringRef xValueUnit;
+	int32_t column;
+	int32_t xValueColumn;
+};
+
+/**
+ * One row of the validation tree (see getValiString())
+ */
+struct BiogasValiRecord {
+	int32_t indent;
+	int32_t glyph;
+	BiogasStringRef leftCell;
+	BiogasStringRef type;
+	BiogasStringRef defaultVal;
+	BiogasStringRef rangeMin;
+	BiogasStringRef rangeMax;
+};
+
+} //end extern "C"
+
+/**
+ * Class to fill a result buffer
+ *
+ * The size of the arena has to be known in advance, e.g. by summing
+ * up all string sizes with "arenaSize()". Afterwards the buffer is
+ * allocated once and filled record by record.
+ */
+template <class Record>
+class ResultBufferBuilder {
+	public:
+		/**
+		 * Allocate the buffer
+		 *
+		 * @param numRecords: Number of records
+		 * @param arenaSize: Size of the string arena (see "arenaSize()")
+		 */
+		ResultBufferBuilder(uint32_t numRecords, uint32_t arenaSize)
+		{
+			uint32_t recordsOffset = (sizeof(BiogasResultBuffer) + 7) & ~7u;
+			uint32_t arenaOffset = recordsOffset + numRecords*sizeof(Record);
+			this->buffer = (BiogasResultBuffer*) std::malloc(arenaOffset + arenaSize);
+			if(this->buffer == nullptr)
+				return;
+			this->buffer->numRecords = numRecords;
+			this->buffer->recordSize = sizeof(Record);
+			this->buffer->recordsOffset = recordsOffset;
+			this->buffer->arenaOffset = arenaOffset;
+			this->buffer->arenaSize = arenaSize;
+			this->buffer->reserved = 0;
+			this->records = (Record*) ((char*) this->buffer + recordsOffset);
+			this->arena = (char*) this->buffer + arenaOffset;
+		}
+
+		/**
+		 * Arena size needed for one string
+		 */
+		static uint32_t arenaSize(const std::string& str) { return str.size()+1; }
+
+		/**
+		 * Copy a string into the arena
+		 *
+		 * @param str: The string
+		 * @return Reference to the copied string
+		 */
+		BiogasStringRef add(const std::string& str)
+		{
+			BiogasStringRef ref = {this->arenaPos, (uint32_t) str.size()};
+			std::memcpy(this->arena+this->arenaPos, str.c_str(), str.size()+1);
+			this->arenaPos += str.size()+1;
+			return ref;
+		}
+
+		Record& record(uint32_t i) { return this->records[i]; }
+		BiogasResultBuffer* result() { return this->buffer; }
+
+	private:
+		BiogasResultBuffer* buffer = nullptr;
+		Record* records = nullptr;
+		char* arena = nullptr;
+		uint32_t arenaPos = 0;
+};
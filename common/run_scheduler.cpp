@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "run_scheduler.h"
+#include "../spec_vali_reader/spec_tree.h"
+#include "../spec_vali_reader/time_table.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static const char* const specStartTime = "problem.numericalSetup.sim_starttime";
+static const char* const specEndTime = "problem.numericalSetup.sim_endtime";
+
+/**
+ * Features of a specification
+ *
+ * Numbers are taken as they are, booleans as 1/0, other values as
+ * "path=value" with 1, time tables as "path#rows" with their number
+ * of rows.
+ *
+ * @param filepath: The specification file
+ * @param features: The features (by name)
+ * @return Bool if the file could be read
+ */
+bool RuntimeModel::
+specFeatures(std::string filepath, std::map<std::string, double>& features)
+{
+	features = {};
+	std::string input;
+	SpecTree tree;
+	if(!readSpecFile(filepath, input) || !tree.parse(input))
+		return false;
+
+	std::map<std::string, const SpecNode*> leaves;
+	tree.collectLeaves(leaves);
+	for(const std::pair<const std::string, const SpecNode*>& leaf : leaves)
+	{
+		const SpecNode& node = *leaf.second;
+		double number;
+		if(node.isTable)
+		{
+			if(node.isTimeTable())
+				features[leaf.first + "#rows"] = node.children.size();
+		}
+		else if(parseSpecNumber(node.value, number))
+			features[leaf.first] = number;
+		else if(node.value == "true" || node.value == "false")
+			features[leaf.first] = (node.value == "true") ? 1 : 0;
+		else
+			features[leaf.first + "=" + plainSpecKey(node.value)] = 1;
+	}
+	return true;
+}
+
+/**
+ * Add a recorded runtime
+ *
+ * Call "fit()" afterwards.
+ *
+ * @param features: Features of the specification
+ * @param seconds: The runtime (ignored if not positive)
+ */
+void RuntimeModel::
+add(const std::map<std::string, double>& features, double seconds)
+{
+	if(!(seconds > 0))
+		return;
+	RuntimeRecord record;
+	record.features = features;
+	record.seconds = seconds;
+	this->records.push_back(record);
+}
+
+/**
+ * Read recorded runtimes from a file
+ *
+ * One line per run: the seconds followed by "name=value" of all
+ * features, tab separated (as written by "append()").
+ *
+ * @param filepath: The file
+ * @return Bool if the file could be read
+ */
+bool RuntimeModel::
+load(std::string filepath)
+{
+	std::ifstream file(filepath);
+	if(!file.good())
+		return false;
+
+	for(std::string line; std::getline(file, line); )
+	{
+		std::istringstream cellIter(line);
+		std::string cell;
+		if(!std::getline(cellIter, cell, '\t'))
+			continue;
+		double seconds = std::strtod(cell.c_str(), nullptr);
+		std::map<std::string, double> features;
+		while(std::getline(cellIter, cell, '\t'))
+		{
+			std::string::size_type eq = cell.rfind('=');
+			if(eq != std::string::npos)
+				features[cell.substr(0, eq)] = std::strtod(cell.c_str() + eq + 1, nullptr);
+		}
+		this->add(features, seconds);
+	}
+	return true;
+}
+
+/**
+ * Append a recorded runtime to a file
+ *
+ * @param filepath: The file
+ * @param record: The record
+ * @return Bool if the file could be written
+ */
+bool RuntimeModel::
+append(std::string filepath, const RuntimeRecord& record) const
+{
+	char number[32];
+	snprintf(number, sizeof(number), "%.12g", record.seconds);
+	std::string line = number;
+	for(const std::pair<const std::string, double>& feature : record.features)
+	{
+		snprintf(number, sizeof(number), "%.12g", feature.second);
+		line += "\t" + feature.first + "=" + number;
+	}
+
+	std::ofstream file(filepath, std::ios::app);
+	file << line << "\n";
+	return file.good();
+}
+
+/**
+ * Fit the model to all records
+ *
+ * Only features which differ between the records are used. A feature
+ * missing in a record counts as 0.
+ */
+void RuntimeModel::
+fit()
+{
+	this->names = {};
+	this->mean = {};
+	this->scale = {};
+	this->weights = {};
+	this->offset = 0;
+	const int n = (int) this->records.size();
+	if(n == 0)
+		return;
+
+	std::vector<double> residual(n);
+	for(int i = 0; i < n; i++)
+	{
+		residual[i] = std::log(this->records[i].seconds) - std::log(span(this->records[i].features));
+		this->offset += residual[i] / n;
+	}
+	for(int i = 0; i < n; i++)
+		residual[i] -= this->offset;
+	if(n < 2)
+		return;
+
+	std::set<std::string> all;
+	for(const RuntimeRecord& record : this->records)
+		for(const std::pair<const std::string, double>& feature : record.features)
+			all.insert(feature.first);
+
+	std::vector<std::vector<double>> columns;
+	for(const std::string& name : all)
+	{
+		std::vector<double> column(n, 0);
+		double sum = 0, squares = 0;
+		for(int i = 0; i < n; i++)
+		{
+			std::map<std::string, double>::const_iterator it = this->records[i].features.find(name);
+			if(it != this->records[i].features.end())
+				column[i] = it->second;
+			sum += column[i];
+		}
+		double average = sum / n;
+		for(int i = 0; i < n; i++)
+			squares += (column[i] - average) * (column[i] - average);
+		double deviation = std::sqrt(squares / n);
+		if(!(deviation > 1e-12 * std::max(1.0, std::abs(average))))
+			continue;
+		for(int i = 0; i < n; i++)
+			column[i] = (column[i] - average) / deviation;
+		this->names.push_back(name);
+		this->mean.push_back(average);
+		this->scale.push_back(deviation);
+		columns.push_back(column);
+	}
+
+	const int p = (int) this->names.size();
+	if(p == 0)
+		return;
+	std::vector<double> matrix((std::size_t) p*p, 0), rhs(p, 0);
+	for(int a = 0; a < p; a++)
+	{
+		for(int b = 0; b < p; b++)
+			for(int i = 0; i < n; i++)
+				matrix[(std::size_t) a*p + b] += columns[a][i] * columns[b][i];
+		matrix[(std::size_t) a*p + a] += this->ridge;
+		for(int i = 0; i < n; i++)
+			rhs[a] += columns[a][i] * residual[i];
+	}
+	if(solve(matrix, rhs, p))
+		this->weights = rhs;
+	else
+		this->names = {};
+}
+
+/**
+ * Predict the runtime of a specification
+ *
+ * @param features: Features of the specification
+ * @return The runtime in seconds
+ */
+double RuntimeModel::
+predict(const std::map<std::string, double>& features) const
+{
+	double exponent = std::log(span(features)) + this->offset;
+	for(std::size_t k = 0; k < this->weights.size(); k++)
+	{
+		std::map<std::string, double>::const_iterator it = features.find(this->names[k]);
+		double value = (it == features.end()) ? 0 : it->second;
+		exponent += this->weights[k] * (value - this->mean[k]) / this->scale[k];
+	}
+	return std::exp(std::min(exponent, 700.0));
+}
+
+/**
+ * Simulated time span of a specification
+ *
+ * @param features: Features of the specification
+ * @return sim_endtime - sim_starttime (1 if unknown)
+ */
+double RuntimeModel::
+span(const std::map<std::string, double>& features)
+{
+	std::map<std::string, double>::const_iterator end = features.find(specEndTime);
+	std::map<std::string, double>::const_iterator start = features.find(specStartTime);
+	if(end == features.end())
+		return 1;
+	double time = end->second - (start == features.end() ? 0 : start->second);
+	return (time > 0) ? time : 1;
+}
+
+/**
+ * Solve a linear system by Gaussian elimination with partial pivoting
+ *
+ * @param matrix: The matrix (row wise, destroyed)
+ * @param rhs: Right hand side, replaced by the solution
+ * @param n: Size of the system
+ * @return Bool if the matrix is regular
+ */
+bool RuntimeModel::
+solve(std::vector<double>& matrix, std::vector<double>& rhs, int n)
+{
+	for(int col = 0; col < n; col++)
+	{
+		int pivot = col;
+		for(int row = col+1; row < n; row++)
+			if(std::abs(matrix[(std::size_t) row*n + col]) > std::abs(matrix[(std::size_t) pivot*n + col]))
+				pivot = row;
+		if(matrix[(std::size_t) pivot*n + col] == 0)
+			return false;
+		if(pivot != col)
+		{
+			for(int k = 0; k < n; k++)
+				std::swap(matrix[(std::size_t) col*n + k], matrix[(std::size_t) pivot*n + k]);
+			std::swap(rhs[col], rhs[pivot]);
+		}
+		for(int row = col+1; row < n; row++)
+		{
+			double factor = matrix[(std::size_t) row*n + col] / matrix[(std::size_t) col*n + col];
+			for(int k = col; k < n; k++)
+				matrix[(std::size_t) row*n + k] -= factor * matrix[(std::size_t) col*n + k];
+			rhs[row] -= factor * rhs[col];
+		}
+	}
+	for(int row = n-1; row >= 0; row--)
+	{
+		for(int k = row+1; k < n; k++)
+			rhs[row] -= matrix[(std::size_t) row*n + k] * rhs[k];
+		rhs[row] /= matrix[(std::size_t) row*n + row];
+	}
+	return true;
+}
+
+/**
+ * Initialize the scheduler
+ *
+ * Removes all jobs and reads the recorded runtimes.
+ *
+ * @param numSlots: Number of jobs running at the same time
+ * @param history: File of recorded runtimes ("" for none)
+ */
+void RunScheduler::
+init(int numSlots, std::string history)
+{
+	this->stop();
+	this->slots = std::max(1, numSlots);
+	this->historyFile = history;
+	this->model = RuntimeModel();
+	if(!history.empty())
+		this->model.load(history);
+	this->model.fit();
+	this->jobs = {};
+	this->schedule = "";
+	this->makespan = 0;
+	this->startTime = std::chrono::steady_clock::now();
+}
+
+/**
+ * Add a job
+ *
+ * The job is started by the next "update()" (if a slot is free and no
+ * job with a longer predicted runtime is waiting).
+ *
+ * @param commandline: The command line (e.g. "ugshell -ex Biogas.lua -p spec.lua")
+ * @param workingDir: Working directory of the process ("" for the current one)
+ * @param specFile: The specification of the run (for the prediction)
+ * @return Number of the job
+ */
+int RunScheduler::
+addJob(std::string commandline, std::string workingDir, std::string specFile)
+{
+	RunJob job;
+	job.commandline = commandline;
+	job.workingDir = workingDir;
+	job.specFile = specFile;
+	RuntimeModel::specFeatures(specFile, job.features);
+	job.predicted = this->model.predict(job.features);
+	this->jobs.push_back(job);
+	this->plan();
+	return (int) this->jobs.size() - 1;
+}
+
+/**
+ * Predict the runtime of a specification
+ *
+ * @param specFile: The specification file
+ * @return The runtime in seconds or -1 if the file could not be read
+ */
+double RunScheduler::
+predict(std::string specFile) const
+{
+	std::map<std::string, double> features;
+	if(!RuntimeModel::specFeatures(specFile, features))
+		return -1;
+	return this->model.predict(features);
+}
+
+/**
+ * Record the runtime of a run done elsewhere
+ *
+ * @param specFile: The specification of the run
+ * @param seconds: The runtime
+ * @return Bool if the file could be read and the runtime is positive
+ */
+bool RunScheduler::
+record(std::string specFile, double seconds)
+{
+	RuntimeRecord record;
+	if(!(seconds > 0) || !RuntimeModel::specFeatures(specFile, record.features))
+		return false;
+	record.seconds = seconds;
+	this->model.add(record.features, seconds);
+	if(!this->historyFile.empty())
+		this->model.append(this->historyFile, record);
+	this->model.fit();
+	this->predictJobs();
+	this->plan();
+	return true;
+}
+
+/**
+ * Collect finished jobs, start waiting ones and plan anew
+ *
+ * @return Number of waiting and running jobs
+ */
+int RunScheduler::
+update()
+{
+	double time = this->now();
+	bool refit = false;
+	std::vector<bool> busy(this->slots, false);
+	for(RunJob& job : this->jobs)
+	{
+		if(job.state != Running)
+			continue;
+		int code = job.capture->getExitCode();
+		if(code < 0)
+		{
+			busy[job.slot] = true;
+			continue;
+		}
+
+		job.exitCode = code;
+		job.finished = time;
+		job.state = (code == 0) ? Done : Failed;
+		job.capture.reset();
+		if(code == 0)
+		{
+			RuntimeRecord record;
+			record.features = job.features;
+			record.seconds = job.finished - job.started;
+			this->model.add(record.features, record.seconds);
+			if(!this->historyFile.empty())
+				this->model.append(this->historyFile, record);
+			refit = true;
+		}
+	}
+	if(refit)
+	{
+		this->model.fit();
+		this->predictJobs();
+	}
+
+	for(int index : this->longestFirst())
+	{
+		int slot = std::find(busy.begin(), busy.end(), false) - busy.begin();
+		if(slot >= this->slots)
+			break;
+
+		RunJob& job = this->jobs[index];
+		job.capture = std::make_shared<ConsoleCapture>();
+		std::map<std::string, double>::const_iterator start = job.features.find(specStartTime);
+		std::map<std::string, double>::const_iterator end = job.features.find(specEndTime);
+		job.capture->startTime = (start == job.features.end()) ? 0 : start->second;
+		job.capture->endTime = (end == job.features.end()) ? 0 : end->second;
+		job.started = time;
+		if(!job.capture->start(job.commandline, job.workingDir, 64*1024, 256))
+		{
+			job.state = Failed;
+			job.finished = time;
+			job.capture.reset();
+			continue;
+		}
+		job.state = Running;
+		job.slot = slot;
+		busy[slot] = true;
+	}
+
+	this->plan();
+	int unfinished = 0;
+	for(const RunJob& job : this->jobs)
+		if(job.state == Waiting || job.state == Running)
+			++unfinished;
+	return unfinished;
+}
+
+/**
+ * Terminate all running jobs and cancel the waiting ones
+ */
+void RunScheduler::
+stop()
+{
+	double time = this->now();
+	for(RunJob& job : this->jobs)
+	{
+		if(job.state != Waiting && job.state != Running)
+			continue;
+		if(job.capture)
+			job.capture->stop();
+		job.capture.reset();
+		job.state = Cancelled;
+		job.finished = time;
+	}
+	this->plan();
+}
+
+/**
+ * Plan all waiting jobs
+ *
+ * Running jobs keep their slot until their predicted end. The waiting
+ * jobs are assigned longest first to the slot which becomes free first.
+ * Writes "schedule": one line per job (tab separated, header line)
+ * with its state, slot, predicted runtime and start and end (actual or
+ * planned) in seconds since the start of the scheduler.
+ */
+void RunScheduler::
+plan()
+{
+	double time = this->now();
+	std::vector<double> free(this->slots, time);
+	for(RunJob& job : this->jobs)
+	{
+		if(job.state != Running)
+			continue;
+		double elapsed = time - job.started;
+		double remaining = std::max(0.0, job.predicted - elapsed);
+		int progress = job.capture ? job.capture->getProgress() : -1;
+		if(progress >= 5 && progress < 100)
+			remaining = elapsed * (100 - progress) / progress;
+		job.plannedStart = job.started;
+		job.plannedFinish = time + remaining;
+		free[job.slot] = std::max(free[job.slot], job.plannedFinish);
+	}
+	for(int index : this->longestFirst())
+	{
+		RunJob& job = this->jobs[index];
+		int slot = std::min_element(free.begin(), free.end()) - free.begin();
+		job.slot = slot;
+		job.plannedStart = free[slot];
+		job.plannedFinish = free[slot] + job.predicted;
+		free[slot] = job.plannedFinish;
+	}
+	this->makespan = *std::max_element(free.begin(), free.end()) - time;
+
+	static const char* const states[] = {"waiting", "running", "done", "failed", "cancelled"};
+	char number[32];
+	std::string table = "job\tstate\tslot\tpredicted\tstart\tend\tspec\n";
+	for(std::size_t i = 0; i < this->jobs.size(); i++)
+	{
+		const RunJob& job = this->jobs[i];
+		bool planned = (job.state == Waiting || job.state == Running);
+		table += std::to_string(i) + "\t" + states[job.state] + "\t" + std::to_string(job.slot);
+		for(double value : {job.predicted, planned ? job.plannedStart : job.started,
+				planned ? job.plannedFinish : job.finished})
+		{
+			snprintf(number, sizeof(number), "%.6g", value);
+			table += "\t" + std::string(number);
+		}
+		table += "\t" + job.specFile + "\n";
+	}
+	this->schedule = table;
+}
+
+/**
+ * Seconds since the start of the scheduler
+ */
+double RunScheduler::
+now() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+}
+
+/**
+ * Waiting jobs, longest predicted runtime first
+ *
+ * @return Indices of the jobs
+ */
+std::vector<int> RunScheduler::
+longestFirst() const
+{
+	std::vector<int> waiting;
+	for(std::size_t i = 0; i < this->jobs.size(); i++)
+		if(this->jobs[i].state == Waiting)
+			waiting.push_back((int) i);
+	std::stable_sort(waiting.begin(), waiting.end(), [this](int a, int b)
+	{
+		return this->jobs[a].predicted > this->jobs[b].predicted;
+	});
+	return waiting;
+}
+
+/**
+ * Predict the runtimes of all unfinished jobs anew
+ */
+void RunScheduler::
+predictJobs()
+{
+	for(RunJob& job : this->jobs)
+		if(job.state == Waiting || job.state == Running)
+			job.predicted = this->model.predict(job.features);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "console_capture.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+
+/**
+ * Class to hold the recorded runtime of one run
+ *
+ * @param features: Features of the specification (see RuntimeModel::specFeatures())
+ * @param seconds: Wall clock time of the run
+ */
+class RuntimeRecord {
+	public:
+		RuntimeRecord(){};
+
+		std::map<std::string, double> features;
+		double seconds = 0;
+};
+
+/**
+ * Class to estimate the runtime of a simulation from its specification
+ *
+ * The runtime is assumed to grow with the simulated time span
+ * (sim_endtime - sim_starttime): log(runtime) = log(span) + c + w*f.
+ * The constant c is the mean over all records, the weights w of the
+ * features f are a ridge regression on the remaining deviation. So a
+ * single record already scales with the span, and the other parameters
+ * (e.g. debug, dt, rows of time tables) are learned as records come in.
+ * Without records the prediction is the span in hours as seconds, only
+ * good for comparing runs.
+ *
+ * @param records: The recorded runtimes
+ * @param ridge: Regularization of the weights
+ * @param names: Features used by the fit
+ * @param mean: Mean of every feature over the records
+ * @param scale: Standard deviation of every feature over the records
+ * @param weights: Weight of every (standardized) feature
+ * @param offset: The constant c
+ */
+class RuntimeModel {
+	public:
+		RuntimeModel(){};
+
+		std::vector<RuntimeRecord> records;
+		double ridge = 1.0;
+		std::vector<std::string> names;
+		std::vector<double> mean;
+		std::vector<double> scale;
+		std::vector<double> weights;
+		double offset = 0;
+
+		static bool specFeatures(std::string, std::map<std::string, double>&);
+		void add(const std::map<std::string, double>&, double);
+		bool load(std::string);
+		bool append(std::string, const RuntimeRecord&) const;
+		void fit();
+		double predict(const std::map<std::string, double>&) const;
+
+	private:
+		static double span(const std::map<std::string, double>&);
+		static bool solve(std::vector<double>&, std::vector<double>&, int);
+};
+
+/**
+ * Class to describe one job of a RunScheduler
+ *
+ * @param commandline: The command line (e.g. "ugshell -ex Biogas.lua -p spec.lua")
+ * @param workingDir: Working directory of the process
+ * @param specFile: The specification of the run
+ * @param features: Features of the specification
+ * @param predicted: Predicted runtime in seconds
+ * @param state: The state (see RunScheduler::State)
+ * @param slot: Worker slot running the job (planned slot while waiting)
+ * @param started: Start time in seconds since the start of the scheduler
+ * @param finished: End time in seconds since the start of the scheduler
+ * @param plannedStart: Predicted start time in seconds since the start of the scheduler
+ * @param plannedFinish: Predicted end time in seconds since the start of the scheduler
+ * @param exitCode: Exit code of the process (-1 while not finished)
+ * @param capture: The running process
+ */
+class RunJob {
+	public:
+		RunJob(){};
+
+		std::string commandline = "";
+		std::string workingDir = "";
+		std::string specFile = "";
+		std::map<std::string, double> features;
+		double predicted = 0;
+		int state = 0;
+		int slot = -1;
+		double started = -1;
+		double finished = -1;
+		double plannedStart = -1;
+		double plannedFinish = -1;
+		int exitCode = -1;
+		std::shared_ptr<ConsoleCapture> capture;
+};
+
+/**
+ * Class to run a batch of simulations on a number of local worker slots
+ *
+ * The jobs are started longest predicted runtime first (LPT), so long
+ * runs do not start last and dominate the total time. The plan assigns
+ * every waiting job to the slot which becomes free first; the end of
+ * the last job is the predicted finish of the batch. Every "update()"
+ * collects finished jobs, records their runtimes (and appends them to
+ * the history file), refits the RuntimeModel, starts the next jobs and
+ * plans the rest anew. The remaining time of a running job is taken
+ * from its simulated time in the console output once it made some
+ * progress, else from the prediction.
+ *
+ * @param slots: Number of jobs running at the same time
+ * @param historyFile: File of recorded runtimes ("" for none)
+ * @param model: The runtime model
+ * @param jobs: All jobs in the order they were added
+ * @param schedule: Table of the last "plan()"
+ * @param makespan: Predicted time in seconds until all jobs are finished
+ * @param startTime: Start of the scheduler
+ */
+class RunScheduler {
+	public:
+		enum State {Waiting, Running, Done, Failed, Cancelled};
+
+		RunScheduler() : startTime(std::chrono::steady_clock::now()) {};
+
+		int slots = 1;
+		std::string historyFile = "";
+		RuntimeModel model;
+		std::vector<RunJob> jobs;
+		std::string schedule = "";
+		double makespan = 0;
+
+		void init(int, std::string);
+		int addJob(std::string, std::string, std::string);
+		double predict(std::string) const;
+		bool record(std::string, double);
+		int update();
+		void stop();
+		void plan();
+
+	private:
+		std::chrono::steady_clock::time_point startTime;
+
+		double now() const;
+		std::vector<int> longestFirst() const;
+		void predictJobs();
+};
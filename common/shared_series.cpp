@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "shared_series.h"
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const uint32_t sharedSeriesMagic = 0x42475353;
+
+/**
+ * Name of the shared memory segment of a series
+ *
+ * @param name: Name of the series
+ * @return The segment name "/biogas_<name>"
+ */
+static std::string sharedSeriesSegment(std::string name)
+{
+	std::replace(name.begin(), name.end(), '/', '_');
+	return "/biogas_" + name;
+}
+
+/**
+ * Size of a segment
+ *
+ * @param columns: Number of doubles per row
+ * @param capacity: Number of rows
+ * @return Size in bytes
+ */
+static std::size_t sharedSeriesSize(uint32_t columns, uint32_t capacity)
+{
+	return sizeof(SharedSeriesHeader) + (std::size_t) columns*capacity*sizeof(double);
+}
+
+/**
+ * Unmap the segment
+ *
+ * The producer closes the series first, so the consumer knows
+ * that no more rows will follow.
+ */
+SharedSeries::
+~SharedSeries()
+{
+	this->detach();
+}
+
+/**
+ * Create the segment of a series (producer side)
+ *
+ * A segment of a previous run with the same name is replaced.
+ * Consumers still attached to it see it as closed.
+ *
+ * @param name: Name of the series
+ * @param columns: Number of doubles per row (time and values)
+ * @param capacity: Number of rows in the ring
+ * @return Bool if the segment could be created
+ */
+bool SharedSeries::
+create(std::string name, int columns, int capacity)
+{
+	this->detach();
+	if(columns < 1 || capacity < 2)
+		return false;
+
+	std::string segment = sharedSeriesSegment(name);
+	int oldFd = shm_open(segment.c_str(), O_RDWR, 0600);
+	if(oldFd >= 0)
+	{
+		this->name = name;
+		if(this->map(oldFd, false))
+			this->header->closed = 1;
+		::close(oldFd);
+		this->detach();
+	}
+	shm_unlink(segment.c_str());
+
+	int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd < 0)
+		return false;
+	this->size = sharedSeriesSize(columns, capacity);
+	if(ftruncate(fd, this->size) != 0)
+	{
+		::close(fd);
+		shm_unlink(segment.c_str());
+		return false;
+	}
+
+	this->name = name;
+	this->producer = true;
+	bool mapped = this->map(fd, true);
+	::close(fd);
+	if(!mapped)
+		return false;
+
+	this->header->columns = columns;
+	this->header->capacity = capacity;
+	this->header->closed = 0;
+	this->header->writeIndex = 0;
+	this->header->readIndex = 0;
+	std::atomic_thread_fence(std::memory_order_release);
+	this->header->magic = sharedSeriesMagic;
+	return true;
+}
+
+/**
+ * Attach to the segment of a series (consumer side)
+ *
+ * @param name: Name of the series
+ * @return Bool if the series exists
+ */
+bool SharedSeries::
+attach(std::string name)
+{
+	this->detach();
+	int fd = shm_open(sharedSeriesSegment(name).c_str(), O_RDWR, 0600);
+	if(fd < 0)
+		return false;
+
+	this->name = name;
+	this->producer = false;
+	bool mapped = this->map(fd, false);
+	::close(fd);
+	if(mapped)
+	{
+		this->pending = this->header->readIndex;
+		this->lost = 0;
+	}
+	return mapped;
+}
+
+/**
+ * Map an opened segment
+ *
+ * @param fd: File descriptor of the segment
+ * @param created: Whether the segment was just created (header not yet valid)
+ * @return Bool if the segment is mapped and valid
+ */
+bool SharedSeries::
+map(int fd, bool created)
+{
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (std::size_t) info.st_size < sizeof(SharedSeriesHeader))
+		return false;
+
+	void* memory = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(memory == MAP_FAILED)
+		return false;
+	this->header = (SharedSeriesHeader*) memory;
+	this->rows = (double*) (this->header+1);
+	this->size = info.st_size;
+
+	if(!created && (this->header->magic != sharedSeriesMagic
+			|| sharedSeriesSize(this->header->columns, this->header->capacity) > this->size))
+	{
+		this->detach();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+/**
+ * Unmap the segment
+ *
+ * The producer closes the series before.
+ */
+void SharedSeries::
+detach()
+{
+	if(this->header == nullptr)
+		return;
+	if(this->producer)
+		this->close();
+	munmap(this->header, this->size);
+	this->header = nullptr;
+	this->rows = nullptr;
+	this->size = 0;
+	this->producer = false;
+}
+
+/**
+ * Publish one row (producer side)
+ *
+ * Never waits for the consumer: if the ring is full,
+ * the oldest row is overwritten.
+ *
+ * @param values: "columns" doubles (time first)
+ * @return Bool if the row was published
+ */
+bool SharedSeries::
+publish(const double* values)
+{
+	if(this->header == nullptr || !this->producer)
+		return false;
+
+	uint64_t write = this->header->writeIndex.load(std::memory_order_relaxed);
+	uint32_t columns = this->header->columns;
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(this->rows + (write % this->header->capacity)*columns, values, columns*sizeof(double));
+	this->header->writeIndex.store(write+1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * Mark the series as complete (producer side)
+ */
+void SharedSeries::
+close()
+{
+	if(this->header != nullptr)
+		this->header->closed.store(1, std::memory_order_release);
+}
+
+/**
+ * Get the next published rows (consumer side)
+ *
+ * The rows are not copied, "rows" points into the shared memory.
+ * At most the rows up to the end of the ring are returned, the rest
+ * follows with the next call. Rows the producer already overwrote
+ * are skipped and counted in "lostRows()". The rows have to be
+ * released with "release()" before the next call.
+ *
+ * @param rows: Pointer to the first row ("columns" doubles per row)
+ * @return Number of rows
+ */
+int SharedSeries::
+acquire(const double*& rows)
+{
+	rows = nullptr;
+	if(this->header == nullptr)
+		return 0;
+
+	uint64_t capacity = this->header->capacity;
+	uint64_t write = this->header->writeIndex.load(std::memory_order_acquire);
+	uint64_t read = this->header->readIndex.load(std::memory_order_relaxed);
+
+	// the slot of row "write" may already be written
+	if(write >= capacity && read < write - capacity + 1)
+	{
+		this->lost += write - capacity + 1 - read;
+		read = write - capacity + 1;
+	}
+	this->pending = read;
+
+	uint64_t available = std::min(write - read, capacity - read % capacity);
+	rows = this->rows + (read % capacity)*this->header->columns;
+	return (int) available;
+}
+
+/**
+ * Release rows returned by "acquire()" (consumer side)
+ *
+ * Checks whether the producer overwrote some of the rows while they
+ * were read. Only the oldest rows can be affected, so if the result
+ * is k, the first k rows are not valid.
+ *
+ * @param count: Number of rows read
+ * @return Number of rows overwritten while they were read
+ */
+int SharedSeries::
+release(int count)
+{
+	if(this->header == nullptr || count <= 0)
+		return 0;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t capacity = this->header->capacity;
+	uint64_t write = this->header->writeIndex.load(std::memory_order_acquire);
+	uint64_t end = this->pending + count;
+
+	uint64_t overwritten = 0;
+	if(write >= capacity && write - capacity + 1 > this->pending)
+		overwritten = std::min(write - capacity + 1, end) - this->pending;
+
+	this->header->readIndex.store(end, std::memory_order_release);
+	this->pending = end;
+	this->lost += overwritten;
+	return (int) overwritten;
+}
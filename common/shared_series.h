@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Header of a shared series segment
+ *
+ * A shared series is a POSIX shared memory segment "/biogas_<name>"
+ * holding this header followed by a ring of "capacity" rows with
+ * "columns" doubles each (the first column is the time).
+ *
+ * There is exactly one producer and one consumer. The producer never
+ * waits: it writes row "writeIndex" into slot "writeIndex % capacity"
+ * and publishes it by incrementing "writeIndex". If the consumer falls
+ * behind, the oldest rows are overwritten. The indices count all rows
+ * ever written and do not wrap around.
+ *
+ * @param magic: Identifies an initialized segment
+ * @param columns: Number of doubles per row
+ * @param capacity: Number of rows in the ring
+ * @param closed: Set by the producer when the series is complete
+ * @param writeIndex: Number of rows published by the producer
+ * @param readIndex: Number of rows released by the consumer
+ */
+struct SharedSeriesHeader {
+	uint32_t magic;
+	uint32_t columns;
+	uint32_t capacity;
+	std::atomic<uint32_t> closed;
+	alignas(64) std::atomic<uint64_t> writeIndex;
+	alignas(64) std::atomic<uint64_t> readIndex;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared series need lock free 64 bit atomics");
+
+/**
+ * Class for one side of a shared series
+ *
+ * The producer creates the segment (replacing a segment of a previous
+ * run), the consumer attaches to it. The rows handed to the consumer
+ * point directly into the shared memory; "release()" tells whether
+ * the producer overwrote them in the meantime.
+ *
+ * @param name: Name of the series
+ * @param producer: Whether this side created the segment
+ * @param header: The mapped segment
+ * @param rows: The ring of rows
+ * @param size: Size of the mapping in bytes
+ * @param pending: First row handed to the consumer and not yet released
+ * @param lost: Number of rows the consumer missed since the last call
+ */
+class SharedSeries {
+	public:
+		SharedSeries(){};
+		~SharedSeries();
+
+		bool create(std::string, int, int);
+		bool attach(std::string);
+		void detach();
+
+		bool publish(const double*);
+		void close();
+
+		int acquire(const double*&);
+		int release(int);
+
+		int columns() const { return this->header == nullptr ? 0 : this->header->columns; }
+		bool isClosed() const { return this->header != nullptr && this->header->closed != 0; }
+		uint64_t lostRows() const { return this->lost; }
+
+	private:
+		std::string name;
+		bool producer = false;
+		SharedSeriesHeader* header = nullptr;
+		double* rows = nullptr;
+		std::size_t size = 0;
+		uint64_t pending = 0;
+		uint64_t lost = 0;
+
+		bool map(int, bool);
+};
+
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+/**
+ * Class to store every distinct string only once
+ *
+ * Strings are referenced by an id. Id 0 is the empty string. The
+ * stored strings never move, so references returned by "get()" stay
+ * valid as long as the pool exists.
+ *
+ * @param strings: The distinct strings in the order of their ids
+ * @param ids: Ids of the strings by their hash
+ */
+class StringPool {
+	public:
+		StringPool()
+		{
+			this->strings.push_back("");
+			this->ids.emplace(std::hash<std::string>()(""), 0);
+		};
+
+		/**
+		 * Id of a string, the string is added if it is not in the pool yet
+		 *
+		 * @param value: The string
+		 * @return Id of the string
+		 */
+		uint32_t intern(const std::string& value)
+		{
+			std::size_t hash = std::hash<std::string>()(value);
+			auto range = this->ids.equal_range(hash);
+			for(auto it = range.first; it != range.second; ++it)
+				if(this->strings[it->second] == value)
+					return it->second;
+			uint32_t id = (uint32_t) this->strings.size();
+			this->strings.push_back(value);
+			this->ids.emplace(hash, id);
+			return id;
+		}
+
+		/**
+		 * Getter method for a string
+		 *
+		 * @param id: Id of the string
+		 * @return The string
+		 */
+		const std::string& get(uint32_t id) const
+		{
+			return this->strings[id];
+		}
+
+		/**
+		 * Number of distinct strings
+		 *
+		 * @return Number of strings (including the empty string)
+		 */
+		int size() const
+		{
+			return (int) this->strings.size();
+		}
+
+		/**
+		 * Remove all strings except the empty string
+		 */
+		void clear()
+		{
+			*this = StringPool();
+		}
+
+	private:
+		std::deque<std::string> strings;
+		std::unordered_multimap<std::size_t, uint32_t> ids;
+};
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <atomic>
+
+/**
+ * Class to report the progress of a long running method and to cancel it
+ *
+ * Methods which accept a TaskControl call "step()" between their
+ * working steps and stop as soon as it returns false.
+ *
+ * @param progress: Progress in percent
+ * @param cancelled: Set if the method should stop
+ */
+class TaskControl {
+	public:
+		TaskControl(){};
+
+		std::atomic<int> progress{0};
+		std::atomic<bool> cancelled{false};
+
+		/**
+		 * Report the progress
+		 *
+		 * @param percent: Progress in percent
+		 * @return Bool if the method should continue
+		 */
+		bool step(int percent)
+		{
+			this->progress = percent;
+			return !this->cancelled;
+		}
+};
+
+/**
+ * Report the progress to an optional TaskControl
+ *
+ * @param control: The TaskControl or nullptr
+ * @param percent: Progress in percent
+ * @return Bool if the method should continue
+ */
+inline bool taskStep(TaskControl* control, int percent)
+{
+	return control == nullptr || control->step(percent);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * Class to publish immutable versions of data to concurrent readers
+ *
+ * Readers take the current version (a snapshot) without waiting for
+ * writers. Writers never change a published version, they publish a
+ * new one. A version is deleted as soon as no reader holds it anymore.
+ *
+ * The getters of the C interface return pointers into a snapshot, so
+ * every thread holds the snapshot of its last "read()" until it reads
+ * again. With "pin()" a thread keeps one snapshot for a sequence of
+ * reads (e.g. tree and plot string of the same version).
+ *
+ * @param current: The latest version
+ * @param published: Number of published versions
+ * @param writer: Serializes the writers
+ */
+template <class T>
+class VersionedStore {
+	public:
+		VersionedStore() : current(std::make_shared<const T>()) {};
+
+		/**
+		 * Getter method for the latest version
+		 *
+		 * @return The snapshot (never empty)
+		 */
+		std::shared_ptr<const T> snapshot() const
+		{
+			return std::atomic_load(&this->current);
+		}
+
+		/**
+		 * Getter method for the version number
+		 *
+		 * @return Number of published versions
+		 */
+		unsigned long long version() const
+		{
+			return this->published;
+		}
+
+		/**
+		 * Publish a new version
+		 *
+		 * @param next: The new version (not changed afterwards)
+		 */
+		void publish(std::shared_ptr<const T> next)
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			this->store(std::move(next));
+		}
+
+		/**
+		 * Change a copy of the latest version and publish it
+		 *
+		 * Writers are serialized, readers keep reading the previous
+		 * version until the copy is published.
+		 *
+		 * @param modify: Method changing the copy
+		 * @return Result of "modify"
+		 */
+		template <class F>
+		auto update(F modify) -> decltype(modify(std::declval<T&>()))
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			std::shared_ptr<T> next = std::make_shared<T>(*this->snapshot());
+			auto result = modify(*next);
+			this->store(next);
+			return result;
+		}
+
+		/**
+		 * Snapshot of the calling thread
+		 *
+		 * The latest version, or the pinned one (see "pin()"). It is
+		 * held until the thread reads again.
+		 *
+		 * @return The snapshot
+		 */
+		const T& read()
+		{
+			Pin& pin = this->threadPin();
+			if(!pin.pinned)
+				pin.snapshot = this->snapshot();
+			return *pin.snapshot;
+		}
+
+		/**
+		 * Publish a new version and hold it for the calling thread
+		 *
+		 * Like "publish()" followed by "read()", but the thread gets
+		 * its own version even if another thread publishes in between
+		 * (e.g. the result of a call, returned as pointer). It replaces
+		 * a pinned version.
+		 *
+		 * @param next: The new version (not changed afterwards)
+		 * @return The new version
+		 */
+		const T& publishAndRead(std::shared_ptr<const T> next)
+		{
+			this->threadPin().snapshot = next;
+			this->publish(next);
+			return *next;
+		}
+
+		/**
+		 * Keep the latest version for all reads of the calling thread
+		 */
+		void pin()
+		{
+			Pin& pin = this->threadPin();
+			pin.snapshot = this->snapshot();
+			pin.pinned = true;
+		}
+
+		/**
+		 * Read the latest version again
+		 */
+		void unpin()
+		{
+			this->threadPin().pinned = false;
+		}
+
+	private:
+		struct Pin {
+			std::shared_ptr<const T> snapshot;
+			bool pinned = false;
+		};
+
+		std::shared_ptr<const T> current;
+		std::atomic<unsigned long long> published{0};
+		std::mutex writer;
+
+		void store(std::shared_ptr<const T> next)
+		{
+			std::atomic_store(&this->current, std::move(next));
+			++this->published;
+		}
+
+		Pin& threadPin()
+		{
+			thread_local std::map<const VersionedStore*, Pin> pins;
+			return pins[this];
+		}
+};
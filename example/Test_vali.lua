@@ -29,7 +29,8 @@ problem = {
         },
         sim_endtime = {
             type = "Double",
-            style = "default"
+            style = "default",
+            constraint = "problem.numericalSetup.sim_endtime > problem.numericalSetup.sim_starttime"
         }
     },
     outputSpecs = {
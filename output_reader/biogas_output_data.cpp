@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_output_reader.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+/**
+ * Match a name against a pattern with '*' as wildcard
+ *
+ * @param pattern: The pattern
+ * @param name: The name
+ * @return Bool if the name matches
+ */
+static bool matchWildcard(const char* pattern, const char* name)
+{
+	if(*pattern == '\0')
+		return *name == '\0';
+	if(*pattern == '*')
+		return matchWildcard(pattern+1, name) || (*name != '\0' && matchWildcard(pattern, name+1));
+	return *pattern == *name && matchWildcard(pattern+1, name+1);
+}
+
+/**
+ * Getter method for the data of an output file
+ *
+ * The file is loaded from the "outputDirectory" when it is
+ * needed for the first time.
+ *
+ * @param filename: Name of the output file (e.g. reactorState.txt)
+ * @return The loaded file or nullptr if it could not be read
+ */
+OutputTable* BiogasOutputReader::
+getTable(std::string filename)
+{
+	std::map<std::string, OutputTable>::iterator it = this->tables.find(filename);
+	if(it != this->tables.end())
+		return &it->second;
+
+	OutputTable table;
+	if(!table.load(this->outputDirectory + filename))
+		return nullptr;
+	return &(this->tables[filename] = table);
+}
+
+/**
+ * Find all entries for a reference
+ *
+ * A reference "group.name" is the LeftCell of a folder and one of
+ * its parameters in the Plot-Tree. Both parts may contain '*'.
+ *
+ * @param reference: The reference
+ * @param indices: Indices of all matching entries
+ * @return Number of matching entries
+ */
+int BiogasOutputReader::
+findEntries(std::string reference, std::vector<int>* indices)
+{
+	std::string::size_type dot = reference.find('.');
+	if(dot == std::string::npos)
+		return 0;
+	std::string group = reference.substr(0, dot);
+	std::string name = reference.substr(dot+1);
+
+	bool groupMatches = false;
+	for(int i=0; i<this->entries.size(); i++)
+	{
+		if(this->entries.indent[i] == 0)
+			groupMatches = matchWildcard(group.c_str(), this->entries.leftCell(i).c_str());
+		else if(groupMatches && this->entries.column[i] >= 0
+				&& matchWildcard(name.c_str(), this->entries.leftCell(i).c_str()))
+			indices->push_back(i);
+	}
+	return indices->size();
+}
+
+/**
+ * Bind a reference of a derived series to the output data
+ *
+ * @param reference: The reference "group.name"
+ * @param columns: All matching columns
+ * @param times: The x Value column of every match
+ * @return Bool if at least one column was found
+ */
+bool BiogasOutputReader::
+resolveReference(const std::string& reference, std::vector<const std::vector<double>*>& columns, std::vector<const std::vector<double>*>& times)
+{
+	std::vector<int> indices = {};
+	this->findEntries(reference, &indices);
+	for(int index : indices)
+	{
+		OutputTable* table = this->getTable(this->entries.filename(index));
+		int col = this->entries.column[index];
+		int xCol = this->entries.xValueColumn[index];
+		if(table == nullptr || col >= table->columns() || xCol >= table->columns())
+			return false;
+
+		columns.push_back(&table->column(col));
+		times.push_back(&table->column(xCol));
+	}
+	return !columns.empty();
+}
+
+/**
+ * Define a derived series
+ *
+ * The series is compiled right away but only evaluated when it is
+ * requested. It is added to the Plot-Tree in a folder "derived"
+ * with filename "derived" and its number as column, so
+ * "outputFilesTreeString" and "outputFilesPlotString" are generated again.
+ * A series with the same name is replaced.
+ *
+ * @param name: Name of the series
+ * @param expression: The expression (see DerivedSeries)
+ * @param unit: Unit of the series
+ * @return Bool if the expression is valid and all references exist
+ */
+bool BiogasOutputReader::
+defineDerivedSeries(std::string name, std::string expression, std::string unit)
+{
+	DerivedSeries series;
+	series.name = name;
+	series.expression = expression;
+	series.unit = unit;
+	if(!series.compile())
+		return false;
+
+	int firstEntry = -1;
+	for(const DerivedNode& node : series.nodes)
+	{
+		std::vector<int> indices = {};
+		if(node.op == DerivedSeries::Column && this->findEntries(node.reference, &indices) == 0)
+			return false;
+		if(firstEntry < 0 && !indices.empty())
+			firstEntry = indices[0];
+	}
+	if(firstEntry < 0)
+		return false;
+
+	int number = 0;
+	while(number < (int) this->derivedSeries.size() && this->derivedSeries[number].name != name)
+		++number;
+
+	if(number == (int) this->derivedSeries.size())
+	{
+		if(this->derivedSeries.empty())
+		{
+			int folder = this->entries.add();
+			this->entries.glyph[folder] = 15;
+			this->entries.setLeftCell(folder, "derived");
+			this->entries.setFilename(folder, "derived");
+		}
+		this->derivedSeries.push_back(series);
+		this->entries.add();
+	}
+	else
+	{
+		this->derivedSeries[number] = series;
+		++this->dataRevision;
+	}
+
+	int entry = this->entries.size() - this->derivedSeries.size() + number;
+	this->entries.indent[entry] = 1;
+	this->entries.glyph[entry] = 37;
+	this->entries.setLeftCell(entry, name);
+	this->entries.setUnit(entry, unit);
+	this->entries.setFilename(entry, "derived");
+	this->entries.column[entry] = number;
+	this->entries.xValueColumn[entry] = 0;
+	this->entries.setXValueName(entry, this->entries.xValueName(firstEntry));
+	this->entries.setXValueUnit(entry, this->entries.xValueUnit(firstEntry));
+
+	this->number_of_lines_output = this->entries.size();
+	this->generateTreeString();
+	this->generatePlotString();
+	return true;
+}
+
+/**
+ * Update all loaded output files
+ *
+ * Parses the rows appended to the output files since the last
+ * call (files in windowed mode are only indexed). Derived series are extended the next time they are
+ * requested. If a file was rewritten, all derived series
+ * are computed again.
+ *
+ * @return Number of new rows over all files
+ */
+int BiogasOutputReader::
+updateData()
+{
+	int newRows = 0;
+	bool reloaded = false;
+	for(std::pair<const std::string, OutputTable>& table : this->tables)
+	{
+		int rows = table.second.update();
+		if(rows < 0)
+			reloaded = true;
+		else
+			newRows += rows;
+	}
+	for(std::pair<const std::string, WindowedTable>& table : this->windowedTables)
+		newRows += std::max(table.second.update(), 0);
+
+	if(reloaded)
+	{
+		for(DerivedSeries& series : this->derivedSeries)
+			series.reset();
+		++this->dataRevision;
+	}
+	return newRows;
+}
+
+/**
+ * Getter method for the data of a series
+ *
+ * The name is either "group.name" for a parameter of the
+ * outputFiles.lua or the name of a derived series.
+ *
+ * @param name: Name of the series
+ * @param x: The x Values
+ * @param y: The y Values
+ * @return Number of rows or -1 if the series does not exist
+ */
+int BiogasOutputReader::
+getSeries(std::string name, const std::vector<double>*& x, const std::vector<double>*& y)
+{
+	for(DerivedSeries& series : this->derivedSeries)
+	{
+		if(series.name != name)
+			continue;
+
+		if(!series.isBound())
+		{
+			using namespace std::placeholders;
+			if(!series.bind(std::bind(&BiogasOutputReader::resolveReference, this, _1, _2, _3)))
+				return -1;
+		}
+		int rows = series.evaluate();
+		x = series.time;
+		y = &series.values();
+		return rows;
+	}
+
+	std::vector<const std::vector<double>*> columns = {};
+	std::vector<const std::vector<double>*> times = {};
+	if(name.find('*') != std::string::npos || !this->resolveReference(name, columns, times))
+		return -1;
+
+	x = times[0];
+	y = columns[0];
+	return std::min(x->size(), y->size());
+}
+
+/**
+ * Open an output file in windowed mode
+ *
+ * The file is not loaded into memory but read in chunks when
+ * a time window is requested (see WindowedTable). Parameters of
+ * this file are requested with getWindow().
+ *
+ * @param filename: Name of the output file (e.g. dbg_reactionrates.txt)
+ * @param chunkSize: Size of a chunk in bytes
+ * @param memoryLimit: Maximal memory of the cached chunks in bytes
+ * @return Bool if the file could be read
+ */
+bool BiogasOutputReader::
+openWindowed(std::string filename, long long chunkSize, long long memoryLimit)
+{
+	WindowedTable table;
+	if(!table.open(this->outputDirectory + filename, chunkSize, memoryLimit))
+		return false;
+	this->windowedTables[filename] = std::move(table);
+	return true;
+}
+
+/**
+ * Find the windowed file of a parameter
+ *
+ * @param name: "group.name" of the parameter
+ * @param col: Index of the column of the parameter
+ * @return The file or nullptr if the parameter is not in a windowed file
+ */
+WindowedTable* BiogasOutputReader::
+findWindowedTable(const std::string& name, int& col)
+{
+	std::vector<int> indices = {};
+	if(name.find('*') != std::string::npos || this->findEntries(name, &indices) == 0)
+		return nullptr;
+
+	int entry = indices[0];
+	std::map<std::string, WindowedTable>::iterator it = this->windowedTables.find(this->entries.filename(entry));
+	if(it == this->windowedTables.end() || this->entries.xValueColumn[entry] != 0)
+		return nullptr;
+	col = this->entries.column[entry];
+	return &it->second;
+}
+
+/**
+ * Getter method for a time window of a parameter in a windowed file
+ *
+ * Without "x" and "y" only the number of rows is determined.
+ *
+ * @param name: "group.name" of the parameter
+ * @param start: Start of the window
+ * @param end: End of the window
+ * @param maxPoints: Maximal number of points, larger windows are downsampled (0: all rows)
+ * @param x: The x Values
+ * @param y: The y Values
+ * @return Number of rows within the window or -1 if the parameter is not in a windowed file
+ */
+long long BiogasOutputReader::
+getWindow(std::string name, double start, double end, int maxPoints, std::vector<double>* x, std::vector<double>* y)
+{
+	int col;
+	WindowedTable* table = this->findWindowedTable(name, col);
+	if(table == nullptr)
+		return -1;
+	if(x == nullptr || y == nullptr)
+		return col < table->columns() ? table->windowRows(start, end) : -1;
+	return table->window(col, start, end, maxPoints, *x, *y);
+}
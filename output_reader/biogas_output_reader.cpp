@@ -17,6 +17,16 @@
 #include <boost/algorithm/string.hpp>
 #include <iostream>
 
+#include "output_table.cpp"
+#include "windowed_table.cpp"
+#include "derived_series.cpp"
+#include "biogas_output_data.cpp"
+#include "output_snapshot.cpp"
+#include "steady_state_monitor.cpp"
+#include "run_analytics.cpp"
+#include "run_density.cpp"
+#include "surrogate_model.cpp"
+
 /**
  * Initialize the BiogasOutputReader
  *	
@@ -25,14 +35,27 @@
  * LabView. 
  * 
  * @param output_path: The absolute path to the outputFiles.lua
+ * @param control: Optional progress report and cancellation
  * @return Bool if the method was succesfull
  */
 bool BiogasOutputReader::
-init(const char* output_path)
+init(const char* output_path, TaskControl* control)
 {
+	if(!taskStep(control, 0))
+		return false;
+
 	if(this->load((std::string) output_path))
 	{
+		if(!taskStep(control, 40))
+			return false;
+
+		std::string path = output_path;
+		std::string::size_type dir_pos = path.find_last_of("/\\");
+		this->outputDirectory = (dir_pos == std::string::npos) ? "" : path.substr(0, dir_pos+1);
+
 		this->readOutputFiles();
+		if(!taskStep(control, 80))
+			return false;
 		this->generateTreeString();
 		this->generatePlotString();
 		return true;
@@ -148,7 +171,7 @@ modifyInput()
 /**
  * Generate date from the outputFiles.lua
  *	
- * Constructs a vector "entries" of type "OutputEntry"
+ * Constructs the rows of "entries"
  * and fills in the data from the outputFiles.lua
  * 
  * @return Bool if successful
@@ -156,7 +179,7 @@ modifyInput()
 bool BiogasOutputReader::
 readOutputFiles()
 {	
-	this->entries = {};
+	this->entries.clear();
 	
 	std::vector<std::string> x_Names = {};
 	std::vector<std::string> x_Units = {};
@@ -173,7 +196,7 @@ readOutputFiles()
 	this->modifyInput();
 	std::istringstream lineIter(this->input_modified);
 	std::string lastFileName = "";
-	std::string lastXCol = "";
+	int lastXCol = -1;
 	std::string lastXName = "";
 	std::string lastXUnit = "";
 
@@ -186,22 +209,19 @@ readOutputFiles()
 			{
 				if(std::regex_search(line, y_value))
 				{
-					this->entries[ind].indent = 0;
-					this->entries[ind].glyph = 15;
-					this->entries[ind].leftCell = this->entries[ind].leftCell;
+					this->entries.indent[ind] = 0;
+					this->entries.glyph[ind] = 15;
 				}
 				else
 				{
-					ind += 1;
 					// Contruct new Element
-					OutputEntry* newEntry = new OutputEntry();
-					this->entries.push_back(*newEntry);
+					ind = this->entries.add();
 
-					this->entries[ind].indent = 1;
-					this->entries[ind].glyph = 37;
+					this->entries.indent[ind] = 1;
+					this->entries.glyph[ind] = 37;
 					boost::replace_all(line, "={", "");
-					this->entries[ind].leftCell = line;
-					this->entries[ind].filename = lastFileName;
+					this->entries.setLeftCell(ind, line);
+					this->entries.setFilename(ind, lastFileName);
 				}
 			} 
 			else if(std::regex_search(line, filename))	
@@ -210,21 +230,21 @@ readOutputFiles()
 				boost::replace_all(line, "\"", "");
 				boost::replace_all(line, "filename=", "");
 				lastFileName = line;
-				this->entries[ind].filename = line;
-				this->entries[ind].column = "";
-				this->entries[ind].unit = "";	
+				this->entries.setFilename(ind, line);
+				this->entries.column[ind] = -1;
+				this->entries.setUnit(ind, "");	
 				
-				lastXCol = std::to_string(std::stoi(x_Cols.front())-1);
-				this->entries[ind].xValueColumn = lastXCol;
+				lastXCol = std::stoi(x_Cols.front())-1;
+				this->entries.xValueColumn[ind] = lastXCol;
 				x_Cols.erase(x_Cols.begin());
 				
 				lastXUnit = x_Units.front();
 				boost::replace_all(lastXUnit, "\"", "");
-				this->entries[ind].xValueUnit = lastXUnit;
+				this->entries.setXValueUnit(ind, lastXUnit);
 				x_Units.erase(x_Units.begin());
 				
 				lastXName = x_Names.front();
-				this->entries[ind].xValueName = lastXName;
+				this->entries.setXValueName(ind, lastXName);
 				x_Names.erase(x_Names.begin());
 			}
 			else if(std::regex_search(line, col))	
@@ -232,10 +252,10 @@ readOutputFiles()
 				boost::replace_all(line, "col=", "");
 				boost::replace_all(line, "}", "");
 				boost::replace_all(line, ",", "");
-				this->entries[ind].column = std::to_string(std::stoi(line)-1);
-				this->entries[ind].xValueColumn = lastXCol;
-				this->entries[ind].xValueName = lastXName;
-				this->entries[ind].xValueUnit = lastXUnit;
+				this->entries.column[ind] = std::stoi(line)-1;
+				this->entries.xValueColumn[ind] = lastXCol;
+				this->entries.setXValueName(ind, lastXName);
+				this->entries.setXValueUnit(ind, lastXUnit);
 			}
 			else if(std::regex_search(line, unit))	
 			{
@@ -243,7 +263,7 @@ readOutputFiles()
 				boost::replace_all(line, "}", "");
 				boost::replace_all(line, ",", "");
 				boost::replace_all(line, "\"", "");
-				this->entries[ind].unit = line;
+				this->entries.setUnit(ind, line);
 			}			
 		}	
 	}
@@ -258,12 +278,17 @@ readOutputFiles()
 void BiogasOutputReader::
 generateTreeString()
 {	
+	std::string::size_type size = 0;
+	for(int i=0; i<this->number_of_lines_output; i++)
+		size += this->entries.leftCell(i).size() + 8;
+
 	this->outputFilesTreeString = "";
+	this->outputFilesTreeString.reserve(size);
 	for(int i=0; i<this->number_of_lines_output; i++)
 	{
-		this->outputFilesTreeString += this->entries[i].leftCell + " " + 
-			std::to_string(this->entries[i].indent) + " " + 
-			std::to_string(this->entries[i].glyph) + "\n";		
+		this->outputFilesTreeString += this->entries.leftCell(i) + " " + 
+			std::to_string(this->entries.indent[i]) + " " + 
+			std::to_string(this->entries.glyph[i]) + "\n";		
 	}
 	this->outputFilesTreeString.resize(this->outputFilesTreeString.size() - 1);
 }
@@ -274,14 +299,23 @@ generateTreeString()
 void BiogasOutputReader::
 generatePlotString()
 {	
+	std::string::size_type size = 0;
+	for(int i=0; i<this->number_of_lines_output; i++)
+	{
+		size += this->entries.leftCell(i).size() + this->entries.unit(i).size() + 
+			this->entries.filename(i).size() + this->entries.xValueName(i).size() + 
+			this->entries.xValueUnit(i).size() + 27;
+	}
+
 	this->outputFilesPlotString = "";
+	this->outputFilesPlotString.reserve(size);
 	for(int i=0; i<this->number_of_lines_output; i++)
 	{
-		this->outputFilesPlotString += this->entries[i].leftCell +  " " + this->entries[i].unit + " " + 
-			this->entries[i].column + " " + 
-			this->entries[i].filename + " " +		
-			this->entries[i].xValueColumn + " " +
-			this->entries[i].xValueName + " " + this->entries[i].xValueUnit + "\n";
+		this->outputFilesPlotString += this->entries.leftCell(i) +  " " + this->entries.unit(i) + " " + 
+			OutputEntries::columnText(this->entries.column[i]) + " " + 
+			this->entries.filename(i) + " " +		
+			OutputEntries::columnText(this->entries.xValueColumn[i]) + " " +
+			this->entries.xValueName(i) + " " + this->entries.xValueUnit(i) + "\n";
 	}
 	this->outputFilesPlotString.resize(this->outputFilesPlotString.size() - 1);
 }
@@ -9,9 +9,18 @@
  * GNU Lesser General Public License for more details.
  */
 
+#pragma once
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 #include "output_entry.h"
+#include "output_table.h"
+#include "windowed_table.h"
+#include "derived_series.h"
+#include "output_snapshot.h"
+#include "../common/task_control.h"
+#include "../common/result_buffer.h"
 
 /**
  * Class to save all Data from outputFiles.lua
@@ -27,6 +36,11 @@
  * @param input: Input outputFiles.lua
  * @param input_modified: Modified input for easier parsing
  * @param entries: Internal container for all data
+ * @param outputDirectory: Directory of the outputFiles.lua (and all *.txt files)
+ * @param tables: Loaded output files (by filename)
+ * @param windowedTables: Output files opened in windowed mode (by filename)
+ * @param derivedSeries: Series derived from the output files
+ * @param dataRevision: Counts the changes of the data other than appended rows (rewritten files, redefined series)
  */
 class BiogasOutputReader { 
 	public:
@@ -39,11 +53,23 @@ class BiogasOutputReader {
 		std::string input; //original input whithout linebreaks
 		std::string input_modified; //Formatted original input with linebreaks
 
-		std::vector<OutputEntry> entries;
+		OutputEntries entries;
+
+		std::string outputDirectory;
+		std::map<std::string, OutputTable> tables;
+		std::map<std::string, WindowedTable> windowedTables;
+		std::vector<DerivedSeries> derivedSeries;
+		unsigned long long dataRevision = 0;
 
 	public:
 		BiogasOutputReader(){};
-		bool init(const char*);	
+		bool init(const char*, TaskControl* control = nullptr);
+		bool defineDerivedSeries(std::string, std::string, std::string);
+		int updateData();
+		int getSeries(std::string, const std::vector<double>*&, const std::vector<double>*&);
+		bool openWindowed(std::string, long long, long long);
+		long long getWindow(std::string, double, double, int, std::vector<double>*, std::vector<double>*);
+		std::shared_ptr<const OutputSnapshot> createSnapshot(const OutputSnapshot*, std::string = "");
 
 	private:
 		bool load(std::string);
@@ -52,6 +78,10 @@ class BiogasOutputReader {
 		void generatePlotString();
 		void modifyInput();
 		void readXValues(std::vector<std::string>*, std::vector<std::string>*, std::vector<std::string>*);
+		OutputTable* getTable(std::string);
+		WindowedTable* findWindowedTable(const std::string&, int&);
+		int findEntries(std::string, std::vector<int>*);
+		bool resolveReference(const std::string&, std::vector<const std::vector<double>*>&, std::vector<const std::vector<double>*>&);
 };
 
 
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "derived_series.h"
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <limits>
+
+/**
+ * Compile the expression
+ *
+ * Parses the "expression" into the "nodes" list. Arguments are
+ * always added before the node using them, so the nodes can be
+ * evaluated in order.
+ *
+ * @return Bool if the expression is valid
+ */
+bool DerivedSeries::
+compile()
+{
+	this->nodes = {};
+	this->time = nullptr;
+	this->pos = 0;
+
+	int root = this->parseExpression();
+	this->skipSpaces();
+	if(root < 0 || this->pos != this->expression.size())
+	{
+		this->nodes = {};
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Skip whitespaces in the expression
+ */
+void DerivedSeries::
+skipSpaces()
+{
+	while(this->pos < this->expression.size() && isspace(this->expression[this->pos]))
+		++this->pos;
+}
+
+/**
+ * Add a new node
+ *
+ * @param op: Operation of the node
+ * @param args: Indices of the argument nodes
+ * @return Index of the new node
+ */
+int DerivedSeries::
+addNode(int op, std::vector<int> args)
+{
+	DerivedNode node;
+	node.op = op;
+	node.args = args;
+	this->nodes.push_back(node);
+	return this->nodes.size()-1;
+}
+
+/**
+ * Parse a sum or difference of terms
+ *
+ * @return Index of the resulting node or -1
+ */
+int DerivedSeries::
+parseExpression()
+{
+	int left = this->parseTerm();
+	while(left >= 0)
+	{
+		this->skipSpaces();
+		if(this->pos >= this->expression.size())
+			break;
+		char c = this->expression[this->pos];
+		if(c != '+' && c != '-')
+			break;
+		++this->pos;
+		int right = this->parseTerm();
+		if(right < 0)
+			return -1;
+		left = this->addNode(c == '+' ? Add : Subtract, {left, right});
+	}
+	return left;
+}
+
+/**
+ * Parse a product or quotient of factors
+ *
+ * @return Index of the resulting node or -1
+ */
+int DerivedSeries::
+parseTerm()
+{
+	int left = this->parseFactor();
+	while(left >= 0)
+	{
+		this->skipSpaces();
+		if(this->pos >= this->expression.size())
+			break;
+		char c = this->expression[this->pos];
+		if(c != '*' && c != '/')
+			break;
+		++this->pos;
+		int right = this->parseFactor();
+		if(right < 0)
+			return -1;
+		left = this->addNode(c == '*' ? Multiply : Divide, {left, right});
+	}
+	return left;
+}
+
+/**
+ * Parse a number, reference, function call or parenthesis
+ *
+ * @return Index of the resulting node or -1
+ */
+int DerivedSeries::
+parseFactor()
+{
+	this->skipSpaces();
+	if(this->pos >= this->expression.size())
+		return -1;
+
+	const std::string& expr = this->expression;
+	char c = expr[this->pos];
+	if(c == '-')
+	{
+		++this->pos;
+		int arg = this->parseFactor();
+		if(arg < 0)
+			return -1;
+		return this->addNode(Negate, {arg});
+	}
+	if(c == '(')
+	{
+		++this->pos;
+		int inner = this->parseExpression();
+		this->skipSpaces();
+		if(inner < 0 || this->pos >= expr.size() || expr[this->pos] != ')')
+			return -1;
+		++this->pos;
+		return inner;
+	}
+	if(isdigit(c) || c == '.')
+	{
+		char* end;
+		double val = std::strtod(expr.c_str()+this->pos, &end);
+		int node = this->addNode(Constant, {});
+		this->nodes[node].constant = val;
+		this->pos = end - expr.c_str();
+		return node;
+	}
+
+	std::string::size_type start = this->pos;
+	while(this->pos < expr.size() && (isalnum(expr[this->pos]) || expr[this->pos] == '_'
+			|| expr[this->pos] == '.' || expr[this->pos] == '*'))
+	{
+		// Inside a reference a '*' is a wildcard, in front of the dot it is a product
+		if(expr[this->pos] == '*' && expr.substr(start, this->pos-start).find('.') == std::string::npos)
+			break;
+		++this->pos;
+	}
+	std::string word = expr.substr(start, this->pos-start);
+	if(word.empty())
+		return -1;
+
+	this->skipSpaces();
+	if(this->pos < expr.size() && expr[this->pos] == '(')
+	{
+		++this->pos;
+		std::vector<int> args;
+		for(;;)
+		{
+			int arg = this->parseExpression();
+			if(arg < 0)
+				return -1;
+			args.push_back(arg);
+			this->skipSpaces();
+			if(this->pos >= expr.size() || expr[this->pos] != ',')
+				break;
+			++this->pos;
+		}
+
+		if(this->pos >= expr.size() || expr[this->pos] != ')')
+			return -1;
+		++this->pos;
+
+		if((word == "diff" || word == "rate") && args.size() == 1)
+			return this->addNode(word == "diff" ? Diff : Rate, args);
+		if(word == "sum")
+		{
+			int node = args[0];
+			for(std::size_t i=1; i<args.size(); i++)
+				node = this->addNode(Add, {node, args[i]});
+			return node;
+		}
+		return -1;
+	}
+
+	if(word.find('.') == std::string::npos)
+		return -1;
+	int node = this->addNode(Column, {});
+	this->nodes[node].reference = word;
+	return node;
+}
+
+/**
+ * Bind all references to the columns of the output files
+ *
+ * The time column of the series is taken from the first reference.
+ *
+ * @param resolver: Finds all columns (and their time columns) for a reference
+ * @return Bool if all references could be found
+ */
+bool DerivedSeries::
+bind(const Resolver& resolver)
+{
+	this->time = nullptr;
+	for(DerivedNode& node : this->nodes)
+	{
+		if(node.op != Column)
+			continue;
+
+		node.columns = {};
+		node.times = {};
+		if(!resolver(node.reference, node.columns, node.times) || node.columns.empty()
+				|| node.times.size() != node.columns.size())
+		{
+			this->time = nullptr;
+			return false;
+		}
+		node.cursors.assign(node.columns.size(), 0);
+		if(this->time == nullptr)
+			this->time = node.times[0];
+	}
+	return this->time != nullptr;
+}
+
+/**
+ * Remove all memoized values and bindings
+ *
+ * Needed if the output files were loaded again, the series
+ * has to be bound before the next evaluation.
+ */
+void DerivedSeries::
+reset()
+{
+	this->time = nullptr;
+	for(DerivedNode& node : this->nodes)
+	{
+		node.columns = {};
+		node.times = {};
+		node.cursors = {};
+		node.values = {};
+	}
+}
+
+/**
+ * Evaluate the series
+ *
+ * Only rows which are available in all bound columns (for columns of
+ * other output files: whose time is not after their last row) and
+ * which have not been computed before are evaluated. Each node is
+ * computed with one loop over the new rows.
+ *
+ * @return Number of rows of the series
+ */
+int DerivedSeries::
+evaluate()
+{
+	if(!this->isBound())
+		return 0;
+
+	const double* t = this->time->data();
+	std::size_t rows = this->time->size();
+	for(const DerivedNode& node : this->nodes)
+	{
+		for(std::size_t k=0; k<node.columns.size(); k++)
+		{
+			std::size_t available = std::min(node.columns[k]->size(), node.times[k]->size());
+			if(node.times[k] == this->time)
+				rows = std::min(rows, available);
+			else if(available == 0)
+				rows = 0;
+			else
+				rows = std::upper_bound(t, t+rows, (*node.times[k])[available-1]) - t;
+		}
+	}
+	for(DerivedNode& node : this->nodes)
+	{
+		std::size_t first = node.values.size();
+		if(first >= rows)
+			continue;
+		node.values.resize(rows);
+		double* out = node.values.data();
+		const double* a = node.args.size() > 0 ? this->nodes[node.args[0]].values.data() : nullptr;
+		const double* b = node.args.size() > 1 ? this->nodes[node.args[1]].values.data() : nullptr;
+
+		switch(node.op)
+		{
+			case Constant:
+				std::fill(out+first, out+rows, node.constant);
+				break;
+			case Column:
+				std::fill(out+first, out+rows, 0.0);
+				for(std::size_t k=0; k<node.columns.size(); k++)
+				{
+					const double* col = node.columns[k]->data();
+					if(node.times[k] == this->time)
+					{
+						for(std::size_t i=first; i<rows; i++)
+							out[i] += col[i];
+						continue;
+					}
+
+					const double* colTime = node.times[k]->data();
+					std::size_t last = std::min(node.columns[k]->size(), node.times[k]->size()) - 1;
+					std::size_t& j = node.cursors[k];
+					for(std::size_t i=first; i<rows; i++)
+					{
+						while(j < last && colTime[j+1] < t[i])
+							++j;
+						if(t[i] < colTime[0])
+							out[i] = std::numeric_limits<double>::quiet_NaN();
+						else if(j == last || !(colTime[j+1] > colTime[j]))
+							out[i] += col[std::min(j+1, last)];
+						else
+							out[i] += col[j] + (col[j+1] - col[j]) * (t[i] - colTime[j]) / (colTime[j+1] - colTime[j]);
+					}
+				}
+				break;
+			case Negate:
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = -a[i];
+				break;
+			case Add:
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = a[i] + b[i];
+				break;
+			case Subtract:
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = a[i] - b[i];
+				break;
+			case Multiply:
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = a[i] * b[i];
+				break;
+			case Divide:
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = a[i] / b[i];
+				break;
+			case Diff:
+				if(first == 0)
+					out[first++] = 0.0;
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = a[i] - a[i-1];
+				break;
+			case Rate:
+				if(first == 0)
+					out[first++] = 0.0;
+				for(std::size_t i=first; i<rows; i++)
+					out[i] = (a[i] - a[i-1]) / (t[i] - t[i-1]);
+				break;
+		}
+	}
+	return rows;
+}
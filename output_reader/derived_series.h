@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+
+/**
+ * Class to represent one node of a derived series expression
+ *
+ * @param op: Operation of the node (see DerivedSeries::Op)
+ * @param constant: Value of a constant node
+ * @param reference: Series referenced by a column node ("group.name", may contain '*')
+ * @param columns: Columns bound to a column node (summed up if more than one)
+ * @param times: Time column of every bound column
+ * @param cursors: Row of every time column before the last resampled time
+ * @param args: Indices of the argument nodes
+ * @param values: Memoized values of the node
+ */
+class DerivedNode {
+	public:
+		DerivedNode(){};
+
+		int op = 0;
+		double constant = 0.0;
+		std::string reference = "";
+		std::vector<const std::vector<double>*> columns;
+		std::vector<const std::vector<double>*> times;
+		std::vector<std::size_t> cursors;
+		std::vector<int> args;
+		std::vector<double> values;
+};
+
+/**
+ * Class to represent a series derived from the output data
+ *
+ * A derived series is defined by an expression over the columns of
+ * the output files, e.g.
+ *
+ *   rate(NormvolumeCumulative.Methane)
+ *   sum(allMass.*_gas)
+ *   NormvolumeCumulative.Methane / reactorState.COD
+ *
+ * Supported are numbers, references "group.name" (with '*' as
+ * wildcard), + - * /, parentheses and the functions
+ * diff(x) (difference to the previous row), rate(x) (difference
+ * divided by the time step) and sum(x, ...). Since '*' is a wildcard
+ * inside a reference, products of references need whitespaces
+ * ("a.b * c.d").
+ *
+ * The time column of the series is the one of the first reference.
+ * Columns of other output files (with other time steps) are linearly
+ * interpolated at these times; times before the first row of such a
+ * file give NaN, rows after its last row are not evaluated until the
+ * file is extended.
+ *
+ * The expression is compiled into a list of nodes. All nodes memoize
+ * their values, so evaluating the series again only computes the rows
+ * appended to the output files since the last evaluation.
+ *
+ * @param name: Name of the series (LeftCell in the Plot-Tree)
+ * @param expression: The expression
+ * @param unit: Unit of the series
+ * @param time: Time column (x Value) of the series
+ * @param nodes: The compiled expression, the last node is the result
+ */
+class DerivedSeries {
+	public:
+		enum Op {Constant, Column, Negate, Add, Subtract, Multiply, Divide, Diff, Rate};
+		typedef std::function<bool(const std::string&, std::vector<const std::vector<double>*>&, std::vector<const std::vector<double>*>&)> Resolver;
+
+		DerivedSeries(){};
+
+		std::string name = "";
+		std::string expression = "";
+		std::string unit = "";
+		const std::vector<double>* time = nullptr;
+		std::vector<DerivedNode> nodes;
+
+		bool compile();
+		bool bind(const Resolver&);
+		int evaluate();
+		void reset();
+		bool isBound() const { return this->time != nullptr; }
+		const std::vector<double>& values() const { return this->nodes.back().values; }
+
+	private:
+		std::string::size_type pos = 0;
+
+		int parseExpression();
+		int parseTerm();
+		int parseFactor();
+		int addNode(int, std::vector<int>);
+		void skipSpaces();
+};
@@ -1,48 +1,120 @@
 /*
  * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
  * Author: Paul Zügel
- * 
- * 
+ *
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU Lesser General Public License for more details.
  */
 
+#pragma once
+#include "../common/string_pool.h"
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
 
 /**
- * Class to represents one row in the LabView Plot-Tree structure
+ * Class to represent the rows of the LabView Plot-Tree structure
  *
- * Contains all information given by the outputFiles.lua
- * file concerning one parameter.
+ * Contains all information given by the outputFiles.lua file, one
+ * column per field and one row per parameter. Filenames, units and
+ * x values repeat for every parameter of a file, they are stored
+ * once in a StringPool and the columns only hold their ids. Copies
+ * share the StringPool until one of them adds a string.
  *
  * @param indent: The indentation in the tree structure
  * @param glyph: Visual symbol in the tree strucutre (e.g. a folder symbol)
- * @param leftCell: Name of the parameter
- * @param filename: Name of the file where the parameter is given (*.txt)
- * @param unit: Unit of the parameter (e.g. [h])
- * @param column: Column of the parameter in the (CSV-style) textfile
+ * @param column: Column of the parameter in the (CSV-style) textfile (-1 for files)
+ * @param xValueColumn: Column of the x value in the (CSV-style) textfile (-1 for groups)
  *
- * Each parameter is affiliated with an x value. 
- * @param xValueName: Name of the x value
- * @param xValueUnit: Unit of the x value
- * @param xValueColumn: Column of the x value in the (CSV-style) textfile
+ * Interned columns (see the getter and setter methods):
+ * leftCell: Name of the parameter
+ * filename: Name of the file where the parameter is given (*.txt)
+ * unit: Unit of the parameter (e.g. [h])
+ *
+ * Each parameter is affiliated with an x value.
+ * xValueName: Name of the x value
+ * xValueUnit: Unit of the x value
  */
-class OutputEntry { 
+class OutputEntries {
 	public:
-		OutputEntry(){};
-		
-		int indent = 0;
-		int glyph = 0;
-		std::string leftCell = "";
-		std::string filename = "";
-		std::string unit = ""; 
-		std::string column = "";
-
-		std::string xValueName = "";
-		std::string xValueUnit = ""; 
-		std::string xValueColumn = "";
-};
+		OutputEntries(){};
+
+		std::vector<int16_t> indent;
+		std::vector<uint8_t> glyph;
+		std::vector<int> column;
+		std::vector<int> xValueColumn;
+
+		/**
+		 * Number of rows
+		 */
+		int size() const { return (int) this->indent.size(); }
+
+		/**
+		 * Remove all rows and strings
+		 */
+		void clear() { *this = OutputEntries(); }
 
+		/**
+		 * Append an empty row
+		 *
+		 * @return Index of the row
+		 */
+		int add()
+		{
+			this->indent.push_back(0);
+			this->glyph.push_back(0);
+			this->column.push_back(-1);
+			this->xValueColumn.push_back(-1);
+			for(std::vector<uint32_t>* column : this->stringColumns())
+				column->push_back(0);
+			return this->size() - 1;
+		}
 
+		const std::string& leftCell(int i) const { return this->strings->get(this->leftCellIds[i]); }
+		const std::string& filename(int i) const { return this->strings->get(this->filenameIds[i]); }
+		const std::string& unit(int i) const { return this->strings->get(this->unitIds[i]); }
+		const std::string& xValueName(int i) const { return this->strings->get(this->xValueNameIds[i]); }
+		const std::string& xValueUnit(int i) const { return this->strings->get(this->xValueUnitIds[i]); }
+
+		void setLeftCell(int i, const std::string& value) { this->leftCellIds[i] = this->ownStrings().intern(value); }
+		void setFilename(int i, const std::string& value) { this->filenameIds[i] = this->ownStrings().intern(value); }
+		void setUnit(int i, const std::string& value) { this->unitIds[i] = this->ownStrings().intern(value); }
+		void setXValueName(int i, const std::string& value) { this->xValueNameIds[i] = this->ownStrings().intern(value); }
+		void setXValueUnit(int i, const std::string& value) { this->xValueUnitIds[i] = this->ownStrings().intern(value); }
+
+		/**
+		 * Column number as written for LabView
+		 *
+		 * @param number: column[i] or xValueColumn[i]
+		 * @return The number or "" if there is no column
+		 */
+		static std::string columnText(int number) { return number < 0 ? "" : std::to_string(number); }
+
+	private:
+		std::shared_ptr<StringPool> strings = std::make_shared<StringPool>();
+		std::vector<uint32_t> leftCellIds;
+		std::vector<uint32_t> filenameIds;
+		std::vector<uint32_t> unitIds;
+		std::vector<uint32_t> xValueNameIds;
+		std::vector<uint32_t> xValueUnitIds;
+
+		/**
+		 * The StringPool of this copy alone (copied if it is shared)
+		 */
+		StringPool& ownStrings()
+		{
+			if(this->strings.use_count() > 1)
+				this->strings = std::make_shared<StringPool>(*this->strings);
+			return *this->strings;
+		}
+
+		std::vector<std::vector<uint32_t>*> stringColumns()
+		{
+			return {&this->leftCellIds, &this->filenameIds, &this->unitIds,
+				&this->xValueNameIds, &this->xValueUnitIds};
+		}
+};
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "output_snapshot.h"
+#include "biogas_output_reader.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+
+/**
+ * Whether two values are the same (NaN is the same as NaN)
+ */
+static bool sameValue(double a, double b)
+{
+	return a == b || (a != a && b != b);
+}
+
+/**
+ * Create the next version of the output data
+ *
+ * Contains the Plot-Tree and all series of the previous version plus
+ * "request". The series are evaluated on this reader (loading their
+ * files if needed). Rows only get appended to a series until the
+ * "dataRevision" changes, so the chunks of the previous version are
+ * shared and only the new rows are copied. Only the last row is
+ * compared, it may have been provisional (see OutputTable::flush()).
+ *
+ * @param previous: The previous version (nullptr for none)
+ * @param request: Name of a series to add ("" for none)
+ * @return The new version
+ */
+std::shared_ptr<const OutputSnapshot> BiogasOutputReader::
+createSnapshot(const OutputSnapshot* previous, std::string request)
+{
+	std::shared_ptr<OutputSnapshot> snapshot = std::make_shared<OutputSnapshot>();
+	snapshot->number_of_lines_output = this->number_of_lines_output;
+	snapshot->outputFilesTreeString = this->outputFilesTreeString;
+	snapshot->outputFilesPlotString = this->outputFilesPlotString;
+	snapshot->entries = this->entries;
+
+	std::vector<std::string> names = {};
+	if(previous != nullptr)
+		for(const std::pair<const std::string, std::shared_ptr<const OutputSeries>>& series : previous->series)
+			names.push_back(series.first);
+	if(!request.empty() && (previous == nullptr || previous->series.count(request) == 0))
+		names.push_back(request);
+
+	for(const std::string& name : names)
+	{
+		const std::vector<double>* x;
+		const std::vector<double>* y;
+		int rows = this->getSeries(name, x, y);
+		if(rows < 0)
+			continue;
+
+		std::shared_ptr<OutputSeries> data = std::make_shared<OutputSeries>();
+		const OutputSeries* old = (previous == nullptr) ? nullptr : previous->getSeries(name);
+		if(old != nullptr && old->revision == this->dataRevision && old->size > 0 && rows >= old->size-1)
+		{
+			int last = old->size-1;
+			const OutputChunk& chunk = *old->chunks.back();
+			bool lastKept = rows > last && sameValue(chunk.x.back(), (*x)[last]) && sameValue(chunk.y.back(), (*y)[last]);
+			if(lastKept && rows == old->size)
+			{
+				snapshot->series[name] = previous->series.at(name);
+				continue;
+			}
+			*data = *old;
+			if(!lastKept)
+				data->dropLastChunk();
+		}
+		data->revision = this->dataRevision;
+		data->append(*x, *y, data->size, rows);
+		snapshot->series[name] = data;
+	}
+	return snapshot;
+}
+
+/**
+ * Append rows to a series
+ *
+ * The rows are added as new chunk. While the chunk before is not
+ * larger, both are merged, so the chunks halve in size towards the
+ * end and a series of n rows has at most log2(n) chunks.
+ *
+ * @param x: The x Values
+ * @param y: The y Values
+ * @param first: Index of the first row to append
+ * @param last: Index behind the last row to append
+ */
+void OutputSeries::
+append(const std::vector<double>& x, const std::vector<double>& y, int first, int last)
+{
+	if(last <= first)
+		return;
+
+	std::size_t rows = last - first;
+	std::size_t merged = rows;
+	std::size_t keep = this->chunks.size();
+	while(keep > 0 && this->chunks[keep-1]->x.size() <= merged)
+		merged += this->chunks[--keep]->x.size();
+
+	std::shared_ptr<OutputChunk> chunk = std::make_shared<OutputChunk>();
+	chunk->x.reserve(merged);
+	chunk->y.reserve(merged);
+	for(std::size_t i=keep; i<this->chunks.size(); i++)
+	{
+		chunk->x.insert(chunk->x.end(), this->chunks[i]->x.begin(), this->chunks[i]->x.end());
+		chunk->y.insert(chunk->y.end(), this->chunks[i]->y.begin(), this->chunks[i]->y.end());
+	}
+	chunk->x.insert(chunk->x.end(), x.begin()+first, x.begin()+last);
+	chunk->y.insert(chunk->y.end(), y.begin()+first, y.begin()+last);
+
+	this->chunks.resize(keep);
+	this->chunks.push_back(chunk);
+	this->size = last;
+}
+
+/**
+ * Remove the last chunk (its rows are appended again)
+ */
+void OutputSeries::
+dropLastChunk()
+{
+	this->size -= (int) this->chunks.back()->x.size();
+	this->chunks.pop_back();
+}
+
+/**
+ * Copy the rows into two arrays
+ *
+ * @param x: Array for the x Values
+ * @param y: Array for the y Values
+ * @param maxRows: Size of the arrays
+ * @return Number of copied rows
+ */
+int OutputSeries::
+copy(double* x, double* y, int maxRows) const
+{
+	int copied = 0;
+	for(const std::shared_ptr<const OutputChunk>& chunk : this->chunks)
+	{
+		int rows = std::min((int) chunk->x.size(), maxRows - copied);
+		if(rows <= 0)
+			break;
+		std::copy(chunk->x.begin(), chunk->x.begin()+rows, x+copied);
+		std::copy(chunk->y.begin(), chunk->y.begin()+rows, y+copied);
+		copied += rows;
+	}
+	return copied;
+}
+
+/**
+ * Getter method for a series
+ *
+ * @param name: Name of the series (as in BiogasOutputReader::getSeries())
+ * @return The series or nullptr if it is not part of this version
+ */
+const OutputSeries* OutputSnapshot::
+getSeries(const std::string& name) const
+{
+	std::map<std::string, std::shared_ptr<const OutputSeries>>::const_iterator it = this->series.find(name);
+	return (it == this->series.end()) ? nullptr : it->second.get();
+}
+
+/**
+ * Create a result buffer with the Plot-Tree
+ *
+ * Same content as "outputFilesTreeString" as fixed-layout
+ * records (see result_buffer.h).
+ *
+ * @return The buffer (release with releaseResultBuffer())
+ */
+BiogasResultBuffer* OutputSnapshot::
+createTreeBuffer() const
+{
+	typedef ResultBufferBuilder<BiogasTreeRecord> Builder;
+	uint32_t arenaSize = 0;
+	for(int i=0; i<this->entries.size(); i++)
+		arenaSize += Builder::arenaSize(this->entries.leftCell(i));
+
+	Builder builder(this->entries.size(), arenaSize);
+	if(builder.result() == nullptr)
+		return nullptr;
+
+	for(int i=0; i<this->entries.size(); i++)
+	{
+		BiogasTreeRecord& record = builder.record(i);
+		record.indent = this->entries.indent[i];
+		record.glyph = this->entries.glyph[i];
+		record.leftCell = builder.add(this->entries.leftCell(i));
+	}
+	return builder.result();
+}
+
+/**
+ * Create a result buffer with all plot information
+ *
+ * Same content as "outputFilesPlotString" as fixed-layout
+ * records (see result_buffer.h).
+ *
+ * @return The buffer (release with releaseResultBuffer())
+ */
+BiogasResultBuffer* OutputSnapshot::
+createPlotBuffer() const
+{
+	typedef ResultBufferBuilder<BiogasPlotRecord> Builder;
+	uint32_t arenaSize = 0;
+	for(int i=0; i<this->entries.size(); i++)
+	{
+		arenaSize += Builder::arenaSize(this->entries.leftCell(i)) + Builder::arenaSize(this->entries.unit(i))
+			+ Builder::arenaSize(this->entries.filename(i)) + Builder::arenaSize(this->entries.xValueName(i))
+			+ Builder::arenaSize(this->entries.xValueUnit(i));
+	}
+
+	Builder builder(this->entries.size(), arenaSize);
+	if(builder.result() == nullptr)
+		return nullptr;
+
+	for(int i=0; i<this->entries.size(); i++)
+	{
+		BiogasPlotRecord& record = builder.record(i);
+		record.leftCell = builder.add(this->entries.leftCell(i));
+		record.unit = builder.add(this->entries.unit(i));
+		record.filename = builder.add(this->entries.filename(i));
+		record.xValueName = builder.add(this->entries.xValueName(i));
+		record.xValueUnit = builder.add(this->entries.xValueUnit(i));
+		record.column = this->entries.column[i];
+		record.xValueColumn = this->entries.xValueColumn[i];
+	}
+	return builder.result();
+}
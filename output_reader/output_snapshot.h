@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "output_entry.h"
+#include "../common/result_buffer.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+/**
+ * Class to hold consecutive rows of a series
+ *
+ * @param x: The x Values
+ * @param y: The y Values
+ */
+class OutputChunk {
+	public:
+		OutputChunk(){};
+
+		std::vector<double> x;
+		std::vector<double> y;
+};
+
+/**
+ * Class to hold the data of one series in a snapshot
+ *
+ * The rows are stored in immutable chunks. A new version of a growing
+ * series shares the chunks of the previous version and only adds the
+ * new rows (see "append()").
+ *
+ * @param chunks: The rows, in order
+ * @param size: Number of rows
+ * @param revision: BiogasOutputReader::dataRevision of the rows
+ */
+class OutputSeries {
+	public:
+		OutputSeries(){};
+
+		std::vector<std::shared_ptr<const OutputChunk>> chunks;
+		int size = 0;
+		unsigned long long revision = 0;
+
+		void append(const std::vector<double>&, const std::vector<double>&, int, int);
+		void dropLastChunk();
+		int copy(double*, double*, int) const;
+};
+
+/**
+ * Class to hold one published version of the output data
+ *
+ * Created by BiogasOutputReader::createSnapshot() and never changed
+ * afterwards, so it can be read by many threads while the reader
+ * works on the next version (see VersionedStore). Only series which
+ * have been requested once are part of a snapshot. Unchanged series
+ * are shared with the previous snapshot.
+ *
+ * @param number_of_lines_output: Number of rows of the Plot-Tree
+ * @param outputFilesTreeString: See BiogasOutputReader
+ * @param outputFilesPlotString: See BiogasOutputReader
+ * @param entries: The rows of the Plot-Tree
+ * @param series: The requested series (by name)
+ */
+class OutputSnapshot {
+	public:
+		OutputSnapshot(){};
+
+		int number_of_lines_output = 0;
+		std::string outputFilesTreeString = "";
+		std::string outputFilesPlotString = "";
+		OutputEntries entries;
+		std::map<std::string, std::shared_ptr<const OutputSeries>> series;
+
+		const OutputSeries* getSeries(const std::string&) const;
+		BiogasResultBuffer* createTreeBuffer() const;
+		BiogasResultBuffer* createPlotBuffer() const;
+};
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "output_table.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <cctype>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Load an output file
+ *
+ * Removes all previous data and parses the whole file, including a
+ * last line which is not terminated by '\n' (see "flush()").
+ *
+ * @param path: The absolute path to the output file
+ * @return Bool if the file could be read
+ */
+bool OutputTable::
+load(std::string path)
+{
+	this->filepath = path;
+	this->clear();
+
+	std::ifstream file(this->filepath);
+	if(!file.good())
+		return false;
+
+	this->update();
+	this->flush();
+	return true;
+}
+
+/**
+ * Read only some columns
+ *
+ * Has to be called before "load()". The other columns are skipped
+ * without being parsed. Selected columns which do not exist in the
+ * file are filled with NaN.
+ *
+ * @param columns: Names (e.g. "pH") or numbers (starting with 1) of the columns
+ */
+void OutputTable::
+select(const std::vector<std::string>& columns)
+{
+	this->selection = columns;
+}
+
+/**
+ * Remove all data
+ */
+void OutputTable::
+clear()
+{
+	this->offset = 0;
+	this->pendingLine = "";
+	this->pendingRow = false;
+	this->data = {};
+	this->header = {};
+	this->selectedColumns = {};
+}
+
+/**
+ * Release the unused capacity of all columns
+ */
+void OutputTable::
+shrink()
+{
+	for(std::vector<double>& column : this->data)
+		column.shrink_to_fit();
+}
+
+/**
+ * Number of rows
+ *
+ * Rows are only counted if they are complete in all columns.
+ *
+ * @return Number of rows
+ */
+int OutputTable::
+rows() const
+{
+	if(this->data.empty())
+		return 0;
+	return (int) this->data.back().size();
+}
+
+/**
+ * Parse all rows appended to the file
+ *
+ * Reads the file from the last known offset. If the file got
+ * smaller (e.g. a new simulation was started in the same directory)
+ * all data is parsed again.
+ *
+ * @return Number of new rows or -1 if the data was reloaded
+ */
+int OutputTable::
+update()
+{
+	std::ifstream file(this->filepath, std::ios::binary | std::ios::ate);
+	if(!file.good())
+		return 0;
+
+	bool reloaded = false;
+	long long size = (long long) file.tellg();
+	if(size < this->offset)
+	{
+		this->clear();
+		reloaded = true;
+	}
+	if(size == this->offset)
+		return reloaded ? -1 : 0;
+
+	if(this->pendingRow)
+	{
+		for(std::vector<double>& column : this->data)
+			column.pop_back();
+		this->pendingRow = false;
+	}
+
+	std::string buffer = this->pendingLine;
+	std::string::size_type pendingSize = buffer.size();
+	buffer.resize(pendingSize + (size - this->offset));
+	file.seekg(this->offset);
+	file.read(&buffer[pendingSize], size - this->offset);
+	this->offset = size;
+
+	int oldRows = this->rows();
+	const char* end = buffer.c_str() + buffer.size();
+	this->pendingLine.assign(this->parseLines(buffer.c_str(), end), end);
+
+	if(reloaded)
+		return -1;
+	return this->rows() - oldRows;
+}
+
+/**
+ * Parse the last line even if it is not terminated by '\n'
+ *
+ * The line of a running simulation may still be incomplete, so the
+ * row is only provisional: the next "update()" removes it and parses
+ * the line again together with the appended data.
+ *
+ * @return Bool if the line was a data row
+ */
+bool OutputTable::
+flush()
+{
+	if(!this->pendingRow)
+		this->pendingRow = this->parseLine(this->pendingLine.c_str(), this->pendingLine.c_str() + this->pendingLine.size());
+	return this->pendingRow;
+}
+
+/**
+ * Parse all complete lines of a part of the output file
+ *
+ * @param pos: Start of the first line
+ * @param end: End of the part
+ * @return Start of the incomplete last line (not terminated by '\n') or "end"
+ */
+const char* OutputTable::
+parseLines(const char* pos, const char* end)
+{
+	while(pos < end)
+	{
+		const char* lineEnd = pos;
+		while(lineEnd < end && *lineEnd != '\n')
+			++lineEnd;
+		if(lineEnd == end)
+			break;
+		this->parseLine(pos, lineEnd);
+		pos = lineEnd+1;
+	}
+	return pos;
+}
+
+/**
+ * Parse one line of the output file
+ *
+ * Lines which are empty, comments or not completely numerical
+ * (e.g. headers) are skipped. The first numerical line defines
+ * the number of columns.
+ *
+ * @param pos: Start of the line
+ * @param end: End of the line
+ * @return Bool if the line was a data row
+ */
+bool OutputTable::
+parseLine(const char* pos, const char* end)
+{
+	if(!this->selection.empty())
+		return this->parseSelectedLine(pos, end);
+
+	this->rowValues.clear();
+	while(pos < end)
+	{
+		while(pos < end && isspace(*pos))
+			++pos;
+		if(pos == end)
+			break;
+		if(*pos == '#')
+		{
+			if(this->data.empty())
+				this->parseHeader(pos+1, end);
+			return false;
+		}
+
+		char* next;
+		double value = std::strtod(pos, &next);
+		if(next == pos || next > end)
+			return false;
+		this->rowValues.push_back(value);
+		pos = next;
+	}
+	const int numValues = (int) this->rowValues.size();
+	if(numValues == 0)
+		return false;
+
+	if(this->data.empty())
+		this->data.resize(numValues);
+
+	for(int i=0; i<this->columns(); i++)
+		this->data[i].push_back(i < numValues ? this->rowValues[i] : std::numeric_limits<double>::quiet_NaN());
+	return true;
+}
+
+/**
+ * Parse the selected columns of one line of the output file
+ *
+ * The first value is always parsed to recognize data rows, the
+ * other values only if they are selected. The columns are resolved
+ * with the header at the first data row.
+ *
+ * @param pos: Start of the line
+ * @param end: End of the line
+ * @return Bool if the line was a data row
+ */
+bool OutputTable::
+parseSelectedLine(const char* pos, const char* end)
+{
+	while(pos < end && isspace(*pos))
+		++pos;
+	if(pos == end)
+		return false;
+	if(*pos == '#')
+	{
+		if(this->data.empty())
+			this->parseHeader(pos+1, end);
+		return false;
+	}
+
+	if(this->data.empty())
+	{
+		this->data.resize(this->selection.size());
+		this->selectedColumns.resize(this->selection.size());
+		int numColumns = 1;
+		for(std::size_t i=0; i<this->selection.size(); i++)
+		{
+			this->selectedColumns[i] = this->findColumn(this->selection[i]);
+			numColumns = std::max(numColumns, this->selectedColumns[i]+1);
+		}
+		this->rowValues.assign(numColumns, 0.0);
+		this->neededColumns.assign(numColumns, false);
+		for(int col : this->selectedColumns)
+			if(col >= 0)
+				this->neededColumns[col] = true;
+	}
+
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	int numValues = 0;
+	while(pos < end && numValues < (int) this->rowValues.size())
+	{
+		while(pos < end && isspace(*pos))
+			++pos;
+		if(pos == end)
+			break;
+		if(numValues > 0 && !this->neededColumns[numValues])
+		{
+			while(pos < end && !isspace(*pos))
+				++pos;
+			++numValues;
+			continue;
+		}
+
+		char* next;
+		this->rowValues[numValues] = std::strtod(pos, &next);
+		if(next == pos || next > end)
+		{
+			if(numValues == 0)
+				return false;
+			this->rowValues[numValues] = nan;
+			while(pos < end && !isspace(*pos))
+				++pos;
+			next = (char*) pos;
+		}
+		++numValues;
+		pos = next;
+	}
+
+	for(std::size_t i=0; i<this->selectedColumns.size(); i++)
+	{
+		int col = this->selectedColumns[i];
+		this->data[i].push_back(col >= 0 && col < numValues ? this->rowValues[col] : nan);
+	}
+	return true;
+}
+
+/**
+ * Parse the column names of a comment line
+ *
+ * Column names are delimited by tabs and may be followed by
+ * their unit in brackets, e.g. "# Time [h]	FOS [g/L]	pH [1]".
+ *
+ * @param pos: Start of the line (behind the '#')
+ * @param end: End of the line
+ */
+void OutputTable::
+parseHeader(const char* pos, const char* end)
+{
+	this->header = {};
+	while(pos < end)
+	{
+		const char* next = pos;
+		while(next < end && *next != '\t')
+			++next;
+
+		std::string name(pos, next);
+		std::string::size_type unit = name.find('[');
+		if(unit != std::string::npos)
+			name = name.substr(0, unit);
+		std::string::size_type first = name.find_first_not_of(" \r");
+		std::string::size_type last = name.find_last_not_of(" \r");
+		this->header.push_back(first == std::string::npos ? "" : name.substr(first, last-first+1));
+		pos = next+1;
+	}
+}
+
+/**
+ * Find a column by its name or number
+ *
+ * @param name: Name of the column in the header (e.g. "pH") or
+ * its number as in outputFiles.lua (starting with 1)
+ * @return Index of the column or -1 if it does not exist
+ */
+int OutputTable::
+findColumn(const std::string& name) const
+{
+	return findOutputColumn(this->header, name);
+}
+
+/**
+ * Find a column by its name or number
+ *
+ * @param header: Column names of the output file
+ * @param name: Name of the column in the header (e.g. "pH") or
+ * its number as in outputFiles.lua (starting with 1)
+ * @return Index of the column or -1 if it does not exist
+ */
+int findOutputColumn(const std::vector<std::string>& header, const std::string& name)
+{
+	for(int i=0; i<(int) header.size(); i++)
+		if(!name.empty() && header[i] == name)
+			return i;
+
+	char* end;
+	long number = std::strtol(name.c_str(), &end, 10);
+	if(name.empty() || *end != '\0' || number < 1)
+		return -1;
+	return (int) number-1;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * Class to hold the numerical data of one output file (*.txt)
+ *
+ * The output files of the simulation are CSV-style text files with
+ * comment lines starting with '#'. All numerical rows are stored
+ * column wise. The file can be followed while the simulation is
+ * running: "update()" only parses the rows appended since the last call.
+ * With "select()" only some columns are parsed and stored, column i
+ * is then the i-th selected column.
+ *
+ * @param filepath: The absolute path to the output file
+ * @param offset: Number of bytes of the file already parsed
+ * @param pendingLine: Incomplete last line (not yet terminated by '\n')
+ * @param pendingRow: Whether the last row was parsed from the "pendingLine" (see "flush()")
+ * @param data: The columns of the file
+ * @param header: Column names of the last comment line before the data (without units)
+ * @param selection: Names or numbers of the columns to read (empty: all columns)
+ * @param selectedColumns: Column in the file of every selected column (-1 if it does not exist)
+ * @param neededColumns: Whether a column of the file is selected
+ * @param rowValues: Values of the current row
+ */
+class OutputTable {
+	public:
+		OutputTable(){};
+		bool load(std::string);
+		void select(const std::vector<std::string>&);
+		int update();
+		bool flush();
+		void clear();
+
+		int rows() const;
+		int columns() const { return (int) this->data.size(); }
+		const std::vector<double>& column(int col) const { return this->data[col]; }
+		const std::string& path() const { return this->filepath; }
+		int findColumn(const std::string&) const;
+		const std::vector<std::string>& columnNames() const { return this->header; }
+		const char* parseLines(const char*, const char*);
+		void shrink();
+
+	private:
+		std::string filepath;
+		long long offset = 0;
+		std::string pendingLine;
+		bool pendingRow = false;
+		std::vector<std::vector<double>> data;
+		std::vector<std::string> header;
+		std::vector<std::string> selection;
+		std::vector<int> selectedColumns;
+		std::vector<bool> neededColumns;
+		std::vector<double> rowValues;
+
+		bool parseLine(const char*, const char*);
+		bool parseSelectedLine(const char*, const char*);
+		void parseHeader(const char*, const char*);
+};
+
+int findOutputColumn(const std::vector<std::string>&, const std::string&);
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "run_analytics.h"
+#include "output_table.h"
+#include "steady_state_monitor.h"
+#include "../spec_vali_reader/spec_tree.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fnmatch.h>
+
+/**
+ * Parse the definition of the KPI
+ *
+ * @param definition: "name reduction filename column [arguments]"
+ * @return Bool if the definition is valid
+ */
+bool RunKpi::
+parse(const std::string& definition)
+{
+	static const std::map<std::string, int> reductions = {{"first", First}, {"last", Last}, {"min", Min},
+		{"max", Max}, {"sum", Sum}, {"integral", Integral}, {"mean", Mean}, {"maxratio", MaxRatio}, {"steady", Steady}};
+
+	std::istringstream stream(definition);
+	std::string reduction;
+	if(!(stream >> this->name >> reduction >> this->filename >> this->column))
+		return false;
+	std::map<std::string, int>::const_iterator it = reductions.find(reduction);
+	if(it == reductions.end())
+		return false;
+	this->reduction = it->second;
+
+	if(this->reduction == MaxRatio && !(stream >> this->column2))
+		return false;
+
+	this->arguments = {};
+	std::string argument;
+	while(stream >> argument)
+	{
+		char* end;
+		this->arguments.push_back(std::strtod(argument.c_str(), &end));
+		if(*end != '\0')
+			return false;
+	}
+	if(this->reduction == Steady)
+		this->arguments.resize(3, -1);
+	return this->reduction != Steady || this->arguments[0] > 0;
+}
+
+/**
+ * Compute the KPI of one run
+ *
+ * @param time: The time column
+ * @param values: The column
+ * @param values2: The denominator (maxratio)
+ * @return The KPI or NaN if there are no values
+ */
+double RunKpi::
+evaluate(const std::vector<double>& time, const std::vector<double>& values, const std::vector<double>* values2) const
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	double result = nan;
+	double lastTime = nan, lastValue = nan, firstTime = nan;
+	double integral = 0;
+
+	SteadyStateCriterion criterion;
+	criterion.window.width = this->arguments.empty() ? 0 : this->arguments[0];
+	criterion.maxSlope = this->arguments.size() > 1 ? this->arguments[1] : -1;
+	criterion.maxVariance = this->arguments.size() > 2 ? this->arguments[2] : -1;
+
+	for(std::size_t row = 0; row < values.size(); row++)
+	{
+		double value = values[row];
+		if(this->reduction == MaxRatio)
+			value = ((*values2)[row] != 0) ? value / (*values2)[row] : nan;
+		if(std::isnan(value) || std::isnan(time[row]))
+			continue;
+
+		switch(this->reduction)
+		{
+			case First:
+				return value;
+			case Last:
+				result = value;
+				break;
+			case Min:
+				result = std::isnan(result) ? value : std::min(result, value);
+				break;
+			case Max:
+			case MaxRatio:
+				result = std::isnan(result) ? value : std::max(result, value);
+				break;
+			case Sum:
+				result = (std::isnan(result) ? 0 : result) + value;
+				break;
+			case Integral:
+			case Mean:
+				if(std::isnan(firstTime))
+					firstTime = time[row];
+				else
+					integral += 0.5 * (value + lastValue) * (time[row] - lastTime);
+				result = (this->reduction == Integral) ? integral
+					: (time[row] > firstTime ? integral / (time[row] - firstTime) : value);
+				break;
+			case Steady:
+				criterion.window.add(time[row], value);
+				if(!criterion.holds())
+					criterion.holdsSince = -1;
+				else if(criterion.holdsSince < 0)
+					criterion.holdsSince = time[row];
+				result = criterion.holdsSince >= 0 ? criterion.holdsSince : nan;
+				break;
+		}
+		lastTime = time[row];
+		lastValue = value;
+	}
+	return result;
+}
+
+/**
+ * Initialize the analytics
+ *
+ * Removes all KPIs and parameters.
+ *
+ * @param pattern: Name of the specification in a run directory (wildcards allowed)
+ */
+void RunAnalytics::
+init(std::string pattern)
+{
+	this->specPattern = pattern;
+	this->kpis = {};
+	this->parameters = {};
+	this->summary = "";
+}
+
+/**
+ * Add a KPI
+ *
+ * @param definition: Definition of the KPI (see RunKpi)
+ * @return Bool if the definition is valid
+ */
+bool RunAnalytics::
+addKpi(std::string definition)
+{
+	RunKpi kpi;
+	if(!kpi.parse(definition))
+		return false;
+	this->kpis.push_back(kpi);
+	return true;
+}
+
+/**
+ * Add a parameter of the specification to the table
+ *
+ * @param path: Path of the parameter (e.g. pSettings.feeding.drymass)
+ */
+void RunAnalytics::
+addParameter(std::string path)
+{
+	this->parameters.push_back(path);
+}
+
+/**
+ * Compute all KPIs of one run and read its specification
+ *
+ * Every output file is read once with the columns needed by its KPIs.
+ *
+ * @param runDir: The run directory (with trailing '/')
+ * @param values: The KPIs (NaN if an output file or column is missing)
+ * @param spec: Normalized values of all parameters of the specification (by path)
+ */
+void RunAnalytics::
+evaluateRun(std::string runDir, std::vector<double>& values, std::map<std::string, std::string>& spec) const
+{
+	values.assign(this->kpis.size(), std::numeric_limits<double>::quiet_NaN());
+
+	std::map<std::string, std::vector<std::string>> selections;
+	for(const RunKpi& kpi : this->kpis)
+	{
+		std::vector<std::string>& selection = selections[kpi.filename];
+		if(selection.empty())
+			selection.push_back("1");
+		for(const std::string& column : {kpi.column, kpi.column2})
+			if(!column.empty() && std::find(selection.begin(), selection.end(), column) == selection.end())
+				selection.push_back(column);
+	}
+
+	for(const std::pair<const std::string, std::vector<std::string>>& file : selections)
+	{
+		OutputTable table;
+		table.select(file.second);
+		if(!table.load(runDir + file.first))
+			continue;
+		if(table.columns() == 0)
+			continue;
+
+		for(std::size_t i=0; i<this->kpis.size(); i++)
+		{
+			const RunKpi& kpi = this->kpis[i];
+			if(kpi.filename != file.first)
+				continue;
+			int col = std::find(file.second.begin(), file.second.end(), kpi.column) - file.second.begin();
+			int col2 = std::find(file.second.begin(), file.second.end(), kpi.column2) - file.second.begin();
+			values[i] = kpi.evaluate(table.column(0), table.column(col),
+				kpi.column2.empty() ? nullptr : &table.column(col2));
+		}
+	}
+
+	DIR* dir = opendir(runDir.c_str());
+	if(dir == nullptr)
+		return;
+	std::vector<std::string> matches;
+	for(struct dirent* item = readdir(dir); item != nullptr; item = readdir(dir))
+		if(fnmatch(this->specPattern.c_str(), item->d_name, 0) == 0)
+			matches.push_back(item->d_name);
+	closedir(dir);
+	if(matches.empty())
+		return;
+
+	std::sort(matches.begin(), matches.end());
+	std::string input;
+	SpecTree tree;
+	if(!readSpecFile(runDir + matches[0], input) || !tree.parse(input))
+		return;
+	std::map<std::string, const SpecNode*> leaves;
+	tree.collectLeaves(leaves);
+	for(const std::pair<const std::string, const SpecNode*>& leaf : leaves)
+		spec[leaf.first] = leaf.second->normalizedValue();
+}
+
+/**
+ * Compute the KPIs of all runs
+ *
+ * The runs are distributed over one worker thread per core. The
+ * table ("summary") has the columns "run", the parameters and the
+ * KPIs. If no parameters were added, all parameters whose values
+ * differ between the runs are taken (runs without a readable
+ * specification are not compared).
+ *
+ * @param runDirs: The run directories
+ * @param outputFile: File to write the table to ("" for none)
+ * @param control: Progress and cancellation (optional)
+ * @return Bool if all runs were evaluated and the table could be written
+ */
+bool RunAnalytics::
+run(const std::vector<std::string>& runDirs, std::string outputFile, TaskControl* control)
+{
+	this->summary = "";
+	std::vector<std::vector<double>> values(runDirs.size());
+	std::vector<std::map<std::string, std::string>> specs(runDirs.size());
+
+	std::atomic<int> next{0};
+	std::atomic<int> finished{0};
+	std::atomic<bool> cancelled{false};
+	std::vector<std::thread> workers;
+	int numWorkers = std::max(1u, std::thread::hardware_concurrency());
+	numWorkers = std::min(numWorkers, (int) runDirs.size());
+	for(int w=0; w<numWorkers; w++)
+	{
+		workers.push_back(std::thread([&]()
+		{
+			for(int run = next++; run < (int) runDirs.size() && !cancelled; run = next++)
+			{
+				std::string runDir = runDirs[run];
+				if(!runDir.empty() && runDir.back() != '/')
+					runDir += "/";
+				this->evaluateRun(runDir, values[run], specs[run]);
+				if(!taskStep(control, 100 * (++finished) / (int) runDirs.size()))
+					cancelled = true;
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+		worker.join();
+	if(cancelled)
+		return false;
+
+	std::vector<std::string> columns = this->parameters;
+	if(columns.empty())
+	{
+		std::set<std::string> paths;
+		for(const std::map<std::string, std::string>& spec : specs)
+			for(const std::pair<const std::string, std::string>& param : spec)
+				paths.insert(param.first);
+		for(const std::string& path : paths)
+		{
+			std::string first = "";
+			bool compared = false;
+			for(std::size_t run = 0; run < specs.size(); run++)
+			{
+				if(specs[run].empty())
+					continue;
+				std::map<std::string, std::string>::const_iterator it = specs[run].find(path);
+				std::string value = (it == specs[run].end()) ? "" : it->second;
+				if(!compared)
+				{
+					first = value;
+					compared = true;
+				}
+				else if(value != first)
+				{
+					columns.push_back(path);
+					break;
+				}
+			}
+		}
+	}
+
+	std::string table = "run";
+	for(const std::string& column : columns)
+		table += "\t" + column;
+	for(const RunKpi& kpi : this->kpis)
+		table += "\t" + kpi.name;
+	table += "\n";
+
+	char number[32];
+	for(std::size_t run = 0; run < runDirs.size(); run++)
+	{
+		table += runDirs[run];
+		for(const std::string& column : columns)
+		{
+			std::map<std::string, std::string>::const_iterator it = specs[run].find(column);
+			table += "\t" + (it == specs[run].end() ? "" : it->second);
+		}
+		for(double value : values[run])
+		{
+			snprintf(number, sizeof(number), "%.12g", value);
+			table += "\t" + std::string(number);
+		}
+		table += "\n";
+	}
+	this->summary = table;
+
+	if(outputFile.empty())
+		return true;
+	std::ofstream file(outputFile);
+	file << table;
+	return file.good();
+}
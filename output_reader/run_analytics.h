@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include "../common/task_control.h"
+
+/**
+ * Class to hold one key performance indicator of a run
+ *
+ * A KPI is defined by one line "name reduction filename column [arguments]",
+ * e.g.
+ *
+ *   methane last producedNormVolumeCumulative.txt Methane
+ *   meanPH mean reactorState.txt pH
+ *   peakFOSCOD maxratio reactorState.txt FOS COD
+ *   steadyPH steady reactorState.txt pH 48 0.001 -1
+ *
+ * Reductions over the column (NaN rows are skipped):
+ * first, last, min, max, sum, integral (over the time), mean
+ * (weighted by the time), maxratio (maximum of column/column2) and
+ * steady (time since the column is steady until the end of the run,
+ * arguments: window [h], maxSlope and maxVariance as for the
+ * SteadyStateMonitor).
+ *
+ * @param name: Name of the KPI (column of the summary)
+ * @param reduction: The reduction (see RunKpi::Reduction)
+ * @param filename: Output file (e.g. reactorState.txt)
+ * @param column: Name or number of the column
+ * @param column2: Name or number of the denominator (maxratio)
+ * @param arguments: Numerical arguments (steady)
+ */
+class RunKpi {
+	public:
+		enum Reduction {First, Last, Min, Max, Sum, Integral, Mean, MaxRatio, Steady};
+
+		RunKpi(){};
+
+		std::string name = "";
+		int reduction = Last;
+		std::string filename = "";
+		std::string column = "";
+		std::string column2 = "";
+		std::vector<double> arguments;
+
+		bool parse(const std::string&);
+		double evaluate(const std::vector<double>&, const std::vector<double>&, const std::vector<double>*) const;
+};
+
+/**
+ * Class to compute KPIs of many runs
+ *
+ * The runs are evaluated in parallel (one worker per core). Of every
+ * output file only the columns needed by the KPIs are parsed. The
+ * result is one table with a row per run, holding the parameters of
+ * the specification of the run (read from the file matching
+ * "specPattern" in the run directory) and all KPIs.
+ *
+ * @param specPattern: Name of the specification in a run directory (wildcards allowed)
+ * @param kpis: All KPIs
+ * @param parameters: Paths of the parameters in the table (empty: all parameters which differ between the runs)
+ * @param summary: The table of the last run() (tab separated, one header line)
+ */
+class RunAnalytics {
+	public:
+		RunAnalytics(){};
+
+		std::string specPattern = "problemSettings.lua";
+		std::vector<RunKpi> kpis;
+		std::vector<std::string> parameters;
+		std::string summary = "";
+
+		void init(std::string);
+		bool addKpi(std::string);
+		void addParameter(std::string);
+		bool run(const std::vector<std::string>&, std::string, TaskControl* control = nullptr);
+
+	private:
+		void evaluateRun(std::string, std::vector<double>&, std::map<std::string, std::string>&) const;
+};
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "run_density.h"
+#include "output_table.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+/**
+ * Initialize the density image
+ *
+ * Removes the range and all percentiles.
+ *
+ * @param file: Output file (e.g. reactorState.txt)
+ * @param col: Name or number of the column
+ * @param columns: Number of time columns
+ * @param rows: Number of value rows
+ * @return Bool if the size is valid
+ */
+bool RunDensity::
+init(std::string file, std::string col, int columns, int rows)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	this->filename = file;
+	this->column = col;
+	this->width = std::max(columns, 0);
+	this->height = std::max(rows, 0);
+	this->setRange(nan, nan, nan, nan);
+	this->percentiles = {};
+	this->data = {};
+	this->range = {};
+	this->runs = 0;
+	return columns > 0 && rows > 0;
+}
+
+/**
+ * Setter method for the bounds of the image
+ *
+ * NaN takes the bound from the data of all runs. Only with all four
+ * bounds given the runs are binned while they are read.
+ *
+ * @param tMin: Lower bound of the time
+ * @param tMax: Upper bound of the time
+ * @param vMin: Lower bound of the values
+ * @param vMax: Upper bound of the values
+ */
+void RunDensity::
+setRange(double tMin, double tMax, double vMin, double vMax)
+{
+	this->timeMin = tMin;
+	this->timeMax = tMax;
+	this->valueMin = vMin;
+	this->valueMax = vMax;
+}
+
+/**
+ * Add a percentile band
+ *
+ * @param percentile: The percentile (0 to 100, e.g. 50 for the median)
+ * @return Bool if the percentile is valid
+ */
+bool RunDensity::
+addPercentile(double percentile)
+{
+	if(!(percentile >= 0 && percentile <= 100))
+		return false;
+	this->percentiles.push_back(percentile);
+	return true;
+}
+
+/**
+ * Compute the density image of all runs
+ *
+ * @param runDirs: The run directories
+ * @param control: Progress and cancellation (optional)
+ * @return Bool if at least one run has data and the image was computed
+ */
+bool RunDensity::
+run(const std::vector<std::string>& runDirs, TaskControl* control)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	this->data = {};
+	this->range = {this->timeMin, this->timeMax, this->valueMin, this->valueMax};
+	this->runs = 0;
+	if(this->width <= 0 || this->height <= 0 || runDirs.empty())
+		return false;
+
+	const int numRuns = (int) runDirs.size();
+	const int cells = this->width * this->height;
+	int numWorkers = std::max(1u, std::thread::hardware_concurrency());
+	numWorkers = std::min(numWorkers, numRuns);
+
+	std::vector<std::vector<uint32_t>> grids(numWorkers, std::vector<uint32_t>(cells, 0));
+	std::vector<double> samples(this->percentiles.empty() ? 0 : (std::size_t) numRuns * this->width, nan);
+	std::vector<char> loaded(numRuns, 0);
+	std::vector<std::vector<double>> times(numRuns), values(numRuns);
+	const bool streaming = !std::isnan(this->timeMin) && !std::isnan(this->timeMax)
+		&& !std::isnan(this->valueMin) && !std::isnan(this->valueMax);
+
+	if(!streaming)
+	{
+		// read all runs first to find the bounds
+		bool finished = this->parallel(numRuns, numWorkers, control, 0, 60, [&](int run, int)
+		{
+			loaded[run] = this->loadRun(runDirs[run], times[run], values[run]);
+		});
+		if(!finished)
+			return false;
+
+		double bounds[4] = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+			std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+		for(int run = 0; run < numRuns; run++)
+		{
+			if(!loaded[run])
+				continue;
+			bounds[0] = std::min(bounds[0], times[run].front());
+			bounds[1] = std::max(bounds[1], times[run].back());
+			std::pair<std::vector<double>::const_iterator, std::vector<double>::const_iterator> minmax
+				= std::minmax_element(values[run].begin(), values[run].end());
+			bounds[2] = std::min(bounds[2], *minmax.first);
+			bounds[3] = std::max(bounds[3], *minmax.second);
+		}
+		for(int i = 0; i < 4; i++)
+			if(std::isnan(this->range[i]))
+				this->range[i] = bounds[i];
+	}
+
+	for(int i = 0; i < 4; i += 2)
+	{
+		if(std::isinf(this->range[i]) || std::isinf(this->range[i+1]))
+			return false;
+		if(!(this->range[i+1] > this->range[i]))
+		{
+			this->range[i] -= 0.5;
+			this->range[i+1] += 0.5;
+		}
+	}
+
+	bool finished = this->parallel(numRuns, numWorkers, control, streaming ? 0 : 60, 90, [&](int run, int worker)
+	{
+		if(streaming)
+			loaded[run] = this->loadRun(runDirs[run], times[run], values[run]);
+		if(!loaded[run])
+			return;
+		this->binRun(times[run], values[run], grids[worker].data(),
+			samples.empty() ? nullptr : &samples[(std::size_t) run * this->width]);
+		times[run] = {};
+		values[run] = {};
+	});
+	if(!finished)
+		return false;
+
+	this->runs = (int) std::count(loaded.begin(), loaded.end(), 1);
+	if(this->runs == 0)
+		return false;
+
+	std::vector<double> result(cells + this->percentiles.size() * this->width, 0);
+	for(const std::vector<uint32_t>& grid : grids)
+		for(int i = 0; i < cells; i++)
+			result[i] += grid[i];
+
+	finished = this->parallel(samples.empty() ? 0 : this->width, numWorkers, control, 90, 100, [&](int x, int)
+	{
+		std::vector<double> column;
+		column.reserve(numRuns);
+		for(int run = 0; run < numRuns; run++)
+		{
+			double sample = samples[(std::size_t) run * this->width + x];
+			if(!std::isnan(sample))
+				column.push_back(sample);
+		}
+		std::sort(column.begin(), column.end());
+
+		for(std::size_t p = 0; p < this->percentiles.size(); p++)
+		{
+			double band = nan;
+			if(!column.empty())
+			{
+				double rank = this->percentiles[p] / 100 * (column.size()-1);
+				std::size_t below = (std::size_t) rank;
+				std::size_t above = std::min(below+1, column.size()-1);
+				band = column[below] + (rank-below) * (column[above]-column[below]);
+			}
+			result[cells + p * this->width + x] = band;
+		}
+	});
+	if(!finished)
+		return false;
+
+	this->data = result;
+	return true;
+}
+
+/**
+ * Read the series of one run
+ *
+ * Rows with NaN in the time or the column are skipped.
+ *
+ * @param runDir: The run directory
+ * @param time: The time of the rows
+ * @param values: The values of the rows
+ * @return Bool if the run has at least one row
+ */
+bool RunDensity::
+loadRun(std::string runDir, std::vector<double>& time, std::vector<double>& values) const
+{
+	if(!runDir.empty() && runDir.back() != '/')
+		runDir += "/";
+
+	OutputTable table;
+	table.select({"1", this->column});
+	if(!table.load(runDir + this->filename))
+		return false;
+	if(table.columns() < 2)
+		return false;
+
+	const std::vector<double>& t = table.column(0);
+	const std::vector<double>& v = table.column(1);
+	time = {};
+	values = {};
+	time.reserve(t.size());
+	values.reserve(v.size());
+	for(std::size_t row = 0; row < t.size() && row < v.size(); row++)
+	{
+		if(std::isnan(t[row]) || std::isnan(v[row]))
+			continue;
+		time.push_back(t[row]);
+		values.push_back(v[row]);
+	}
+	return !time.empty();
+}
+
+/**
+ * Add the curve of one run to a grid
+ *
+ * The curve is interpolated linearly between the rows. In every time
+ * column the run covers the cells from the lowest to the highest value
+ * of its curve within the column, each of them is counted once.
+ *
+ * @param time: The time of the rows (increasing)
+ * @param values: The values of the rows
+ * @param counts: The grid (width*height cells, column wise)
+ * @param samples: Value of the curve at the center of every column (nullptr: none)
+ */
+void RunDensity::
+binRun(const std::vector<double>& time, const std::vector<double>& values, uint32_t* counts, double* samples) const
+{
+	const int columns = this->width;
+	const double t0 = this->range[0], t1 = this->range[1];
+	const double v0 = this->range[2], v1 = this->range[3];
+	const double dt = (t1 - t0) / columns;
+	const double valueScale = this->height / (v1 - v0);
+
+	std::vector<double> low(columns, std::numeric_limits<double>::infinity());
+	std::vector<double> high(columns, -std::numeric_limits<double>::infinity());
+	auto columnOf = [&](double t)
+	{
+		return std::min(columns-1, std::max(0, (int) ((t - t0) / dt)));
+	};
+	auto cover = [&](int x, double a, double b)
+	{
+		low[x] = std::min(low[x], std::min(a, b));
+		high[x] = std::max(high[x], std::max(a, b));
+	};
+
+	if(time.size() == 1 && time[0] >= t0 && time[0] <= t1)
+	{
+		cover(columnOf(time[0]), values[0], values[0]);
+		if(samples != nullptr)
+			samples[columnOf(time[0])] = values[0];
+	}
+	for(std::size_t row = 1; row < time.size(); row++)
+	{
+		const double ta = time[row-1], tb = time[row];
+		const double va = values[row-1], vb = values[row];
+		if(tb <= ta)
+		{
+			if(tb == ta && ta >= t0 && ta <= t1)
+				cover(columnOf(ta), va, vb);
+			continue;
+		}
+		const double start = std::max(ta, t0), end = std::min(tb, t1);
+		if(start > end)
+			continue;
+
+		const double slope = (vb - va) / (tb - ta);
+		const int last = columnOf(end);
+		for(int x = columnOf(start); x <= last; x++)
+		{
+			const double from = std::max(start, t0 + x*dt);
+			const double to = std::min(end, t0 + (x+1)*dt);
+			cover(x, va + slope*(from - ta), va + slope*(to - ta));
+
+			const double center = t0 + (x+0.5)*dt;
+			if(samples != nullptr && center >= ta && center <= tb)
+				samples[x] = va + slope*(center - ta);
+		}
+	}
+
+	for(int x = 0; x < columns; x++)
+	{
+		if(low[x] > high[x] || high[x] < v0 || low[x] > v1)
+			continue;
+		const int first = (int) ((std::max(low[x], v0) - v0) * valueScale);
+		const int last = std::min(this->height-1, (int) ((std::min(high[x], v1) - v0) * valueScale));
+		uint32_t* cell = counts + (std::size_t) x * this->height;
+		for(int y = first; y <= last; y++)
+			++cell[y];
+	}
+}
+
+/**
+ * Distribute work over worker threads
+ *
+ * @param count: Number of items
+ * @param numWorkers: Number of worker threads
+ * @param control: Progress and cancellation (optional)
+ * @param progressFrom: Progress before the first item
+ * @param progressTo: Progress after the last item
+ * @param work: Method called as work(item, worker) for every item
+ * @return Bool if all items were processed (not cancelled)
+ */
+template <class F>
+bool RunDensity::
+parallel(int count, int numWorkers, TaskControl* control, int progressFrom, int progressTo, F work) const
+{
+	std::atomic<int> next{0};
+	std::atomic<int> finished{0};
+	std::atomic<bool> cancelled{false};
+	std::vector<std::thread> workers;
+	for(int w = 0; w < std::min(numWorkers, count); w++)
+	{
+		workers.push_back(std::thread([&, w]()
+		{
+			for(int item = next++; item < count && !cancelled; item = next++)
+			{
+				work(item, w);
+				if(!taskStep(control, progressFrom + (progressTo - progressFrom) * (++finished) / count))
+					cancelled = true;
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+		worker.join();
+	return !cancelled;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "../common/task_control.h"
+
+/**
+ * Class to overlay one series of many runs as density image
+ *
+ * Instead of one trace per run, the series of all runs are binned into
+ * a grid of "width" time columns and "height" value rows. Every run
+ * adds 1 to all cells its (linearly interpolated) curve passes in a
+ * column, so a cell holds the number of runs passing it. The size of
+ * the result only depends on the grid, not on the number of runs.
+ *
+ * The runs are read in parallel (one worker per core), of every output
+ * file only the time and the chosen column are parsed. With a fixed
+ * range a run is binned right after it has been read and not kept.
+ *
+ * The result "data" holds the counts column wise (data[x*height+y],
+ * y = 0 is the lowest value), followed by one row of "width" values
+ * per percentile band (value of the band at the center of the column,
+ * NaN where no run has data).
+ *
+ * @param filename: Output file (e.g. reactorState.txt)
+ * @param column: Name or number of the column
+ * @param width: Number of time columns
+ * @param height: Number of value rows
+ * @param timeMin: Lower bound of the time (NaN: smallest time of all runs)
+ * @param timeMax: Upper bound of the time (NaN: largest time of all runs)
+ * @param valueMin: Lower bound of the values (NaN: smallest value of all runs)
+ * @param valueMax: Upper bound of the values (NaN: largest value of all runs)
+ * @param percentiles: Percentiles of the bands (0 to 100)
+ * @param data: The result of the last run()
+ * @param range: Bounds used by the last run() (timeMin, timeMax, valueMin, valueMax)
+ * @param runs: Number of runs with data in the last run()
+ */
+class RunDensity {
+	public:
+		RunDensity(){};
+
+		std::string filename = "";
+		std::string column = "";
+		int width = 0;
+		int height = 0;
+		double timeMin = std::numeric_limits<double>::quiet_NaN();
+		double timeMax = std::numeric_limits<double>::quiet_NaN();
+		double valueMin = std::numeric_limits<double>::quiet_NaN();
+		double valueMax = std::numeric_limits<double>::quiet_NaN();
+		std::vector<double> percentiles;
+		std::vector<double> data;
+		std::vector<double> range;
+		int runs = 0;
+
+		bool init(std::string, std::string, int, int);
+		void setRange(double, double, double, double);
+		bool addPercentile(double);
+		bool run(const std::vector<std::string>&, TaskControl* control = nullptr);
+
+	private:
+		bool loadRun(std::string, std::vector<double>&, std::vector<double>&) const;
+		void binRun(const std::vector<double>&, const std::vector<double>&, uint32_t*, double*) const;
+		template <class F>
+		bool parallel(int, int, TaskControl*, int, int, F) const;
+};
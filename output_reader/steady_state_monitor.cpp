@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "steady_state_monitor.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <signal.h>
+
+/**
+ * Add a sample to the window
+ *
+ * Samples older than "width" (relative to the new sample) are dropped.
+ *
+ * @param t: Time of the sample
+ * @param v: Value of the sample
+ */
+void RollingWindow::
+add(double t, double v)
+{
+	if(std::isnan(t) || std::isnan(v))
+		return;
+
+	if(this->samples.empty())
+	{
+		this->t0 = t;
+		this->v0 = v;
+	}
+	this->samples.push_back(std::make_pair(t, v));
+	this->accumulate(t, v, 1);
+
+	while(this->samples.size() > 2 && t - this->samples[1].first >= this->width)
+	{
+		this->accumulate(this->samples.front().first, this->samples.front().second, -1);
+		this->samples.pop_front();
+	}
+}
+
+/**
+ * Add or remove a sample to the sums
+ *
+ * @param t: Time of the sample
+ * @param v: Value of the sample
+ * @param sign: 1 to add, -1 to remove
+ */
+void RollingWindow::
+accumulate(double t, double v, double sign)
+{
+	t -= this->t0;
+	v -= this->v0;
+	this->sumT += sign*t;
+	this->sumV += sign*v;
+	this->sumTT += sign*t*t;
+	this->sumTV += sign*t*v;
+	this->sumVV += sign*v*v;
+}
+
+/**
+ * Remove all samples
+ */
+void RollingWindow::
+clear()
+{
+	this->samples.clear();
+	this->sumT = this->sumV = this->sumTT = this->sumTV = this->sumVV = 0;
+}
+
+/**
+ * Time covered by the samples
+ *
+ * @return Time between the first and the last sample
+ */
+double RollingWindow::
+span() const
+{
+	if(this->samples.empty())
+		return 0;
+	return this->samples.back().first - this->samples.front().first;
+}
+
+/**
+ * Least squares slope of the samples
+ *
+ * @return The slope (0 for less than two samples)
+ */
+double RollingWindow::
+slope() const
+{
+	double n = this->samples.size();
+	double denominator = n*this->sumTT - this->sumT*this->sumT;
+	if(n < 2 || denominator <= 0)
+		return 0;
+	return (n*this->sumTV - this->sumT*this->sumV) / denominator;
+}
+
+/**
+ * Variance of the values
+ *
+ * @return The variance (0 for less than two samples)
+ */
+double RollingWindow::
+variance() const
+{
+	double n = this->samples.size();
+	if(n < 2)
+		return 0;
+	double mean = this->sumV / n;
+	return std::max(0.0, this->sumVV / n - mean*mean);
+}
+
+/**
+ * Check the criterion
+ *
+ * @return Bool if the window is filled and slope and variance are within their limits
+ */
+bool SteadyStateCriterion::
+holds() const
+{
+	if(this->window.count() < 2 || this->window.span() < this->window.width)
+		return false;
+	if(this->maxSlope >= 0 && std::fabs(this->window.slope()) > this->maxSlope)
+		return false;
+	if(this->maxVariance >= 0 && this->window.variance() > this->maxVariance)
+		return false;
+	return true;
+}
+
+/**
+ * Initialize the monitor
+ *
+ * Removes all criteria and the state of a previous run.
+ *
+ * @param directory: Output directory of the simulation
+ */
+void SteadyStateMonitor::
+init(std::string directory)
+{
+	if(!directory.empty() && directory.back() != '/')
+		directory += "/";
+	this->outputDirectory = directory;
+	this->criteria = {};
+	this->tables = {};
+	this->converged = false;
+	this->convergenceTime = -1;
+}
+
+/**
+ * Add a convergence criterion
+ *
+ * @param filename: Output file (e.g. reactorState.txt)
+ * @param column: Name (e.g. "pH") or number (as in outputFiles.lua) of the column
+ * @param window: Width of the window in hours
+ * @param maxSlope: Maximal absolute slope per hour (negative: not checked)
+ * @param maxVariance: Maximal variance (negative: not checked)
+ */
+void SteadyStateMonitor::
+addCriterion(std::string filename, std::string column, double window, double maxSlope, double maxVariance)
+{
+	SteadyStateCriterion criterion;
+	criterion.filename = filename;
+	criterion.column = column;
+	criterion.window.width = window;
+	criterion.maxSlope = maxSlope;
+	criterion.maxVariance = maxVariance;
+	this->criteria.push_back(criterion);
+}
+
+/**
+ * Add the new rows of its output file to a criterion
+ *
+ * @param criterion: The criterion
+ * @return Bool if the criterion holds
+ */
+bool SteadyStateMonitor::
+updateCriterion(SteadyStateCriterion& criterion)
+{
+	OutputTable& table = this->tables[criterion.filename];
+	if(criterion.index < 0)
+	{
+		criterion.index = table.findColumn(criterion.column);
+		if(criterion.index < 0 || criterion.index >= table.columns())
+		{
+			criterion.index = -1;
+			return false;
+		}
+	}
+
+	const std::vector<double>& time = table.column(0);
+	const std::vector<double>& values = table.column(criterion.index);
+	for(int row = criterion.rowsRead; row < table.rows(); row++)
+	{
+		criterion.window.add(time[row], values[row]);
+		if(!criterion.holds())
+			criterion.holdsSince = -1;
+		else if(criterion.holdsSince < 0)
+			criterion.holdsSince = time[row];
+	}
+	criterion.rowsRead = table.rows();
+	return criterion.holdsSince >= 0;
+}
+
+/**
+ * Read the new rows of all output files and check the criteria
+ *
+ * If an output file was rewritten (a new simulation was started),
+ * all criteria on this file start again.
+ *
+ * @return Bool if the run has converged
+ */
+bool SteadyStateMonitor::
+update()
+{
+	if(this->converged || this->criteria.empty())
+		return this->converged;
+
+	for(SteadyStateCriterion& criterion : this->criteria)
+	{
+		if(this->tables.find(criterion.filename) == this->tables.end())
+			this->tables[criterion.filename].load(this->outputDirectory + criterion.filename);
+	}
+
+	for(std::pair<const std::string, OutputTable>& table : this->tables)
+	{
+		if(table.second.update() < 0)
+		{
+			for(SteadyStateCriterion& criterion : this->criteria)
+			{
+				if(criterion.filename != table.first)
+					continue;
+				criterion.window.clear();
+				criterion.index = -1;
+				criterion.rowsRead = 0;
+				criterion.holdsSince = -1;
+			}
+		}
+	}
+
+	bool allHold = true;
+	double since = -1;
+	for(SteadyStateCriterion& criterion : this->criteria)
+	{
+		allHold = this->updateCriterion(criterion) && allHold;
+		since = std::max(since, criterion.holdsSince);
+	}
+
+	if(allHold)
+	{
+		this->convergenceTime = since;
+		this->converged = true;
+		this->finish();
+	}
+	return this->converged;
+}
+
+/**
+ * Record the convergence and signal the simulation
+ *
+ * Writes the time of convergence to "steadyState.txt"
+ * (in the format of the other output files).
+ */
+void SteadyStateMonitor::
+finish()
+{
+	std::ofstream file(this->outputDirectory + "steadyState.txt");
+	if(file.good())
+	{
+		file.precision(14);
+		file << "# Time [h]\n" << this->convergenceTime.load() << "\n";
+	}
+
+	int pid = this->process;
+	int sig = this->signal;
+	if(pid > 0 && sig > 0)
+		kill(pid, sig);
+}
+
+/**
+ * Follow the output files until the run has converged
+ *
+ * The progress is the percentage of criteria which currently hold.
+ *
+ * @param control: Progress and cancellation (or nullptr)
+ * @param interval: Time between two updates in milliseconds
+ * @return Bool if the run has converged (false if cancelled)
+ */
+bool SteadyStateMonitor::
+run(TaskControl* control, int interval)
+{
+	while(!this->update())
+	{
+		int holding = 0;
+		for(const SteadyStateCriterion& criterion : this->criteria)
+			if(criterion.holdsSince >= 0)
+				++holding;
+		if(!taskStep(control, this->criteria.empty() ? 0 : 100*holding / (int) this->criteria.size()))
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+	}
+	return true;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <atomic>
+#include "output_table.h"
+#include "../common/task_control.h"
+
+/**
+ * Class for the statistics of a series over a sliding time window
+ *
+ * Keeps the sums needed for the least squares slope and the variance,
+ * so adding a sample and dropping the samples which left the window
+ * costs constant time (amortized). Times and values are stored
+ * relative to the first sample to keep the sums well conditioned.
+ *
+ * @param width: Width of the window (same unit as the time, e.g. [h])
+ * @param samples: Samples (time, value) inside the window
+ */
+class RollingWindow {
+	public:
+		RollingWindow(){};
+
+		double width = 0;
+
+		void add(double, double);
+		void clear();
+
+		int count() const { return (int) this->samples.size(); }
+		double span() const;
+		double slope() const;
+		double variance() const;
+
+	private:
+		std::deque<std::pair<double, double>> samples;
+		double t0 = 0, v0 = 0;
+		double sumT = 0, sumV = 0, sumTT = 0, sumTV = 0, sumVV = 0;
+
+		void accumulate(double, double, double);
+};
+
+/**
+ * Class to hold one convergence criterion
+ *
+ * The criterion holds if the window is filled, the absolute slope
+ * is at most "maxSlope" and the variance at most "maxVariance"
+ * (negative limits are not checked).
+ *
+ * @param filename: Output file (e.g. reactorState.txt)
+ * @param column: Name (e.g. "pH") or number of the column
+ * @param maxSlope: Maximal absolute slope (unit of the column per hour)
+ * @param maxVariance: Maximal variance (squared unit of the column)
+ * @param window: The statistics of the last rows
+ * @param index: Index of the column (-1 until the file is found)
+ * @param rowsRead: Rows of the file already added to the window
+ * @param holdsSince: Time since the criterion holds (-1 if it does not)
+ */
+class SteadyStateCriterion {
+	public:
+		SteadyStateCriterion(){};
+
+		std::string filename = "";
+		std::string column = "";
+		double maxSlope = -1;
+		double maxVariance = -1;
+
+		RollingWindow window;
+		int index = -1;
+		int rowsRead = 0;
+		double holdsSince = -1;
+
+		bool holds() const;
+};
+
+/**
+ * Class to detect the steady state of a running simulation
+ *
+ * Follows the output files of the simulation and checks all criteria
+ * on every update. The run has converged as soon as all criteria hold
+ * at the same time. The time of convergence is the latest time one of
+ * the criteria started to hold; it is written to "steadyState.txt" in
+ * the output directory. If a process is set, it gets a signal (e.g.
+ * SIGTERM for ugshell) once the run has converged. The process may be
+ * set while "run()" follows the files on a worker thread.
+ *
+ * @param outputDirectory: Directory of the output files (with trailing '/')
+ * @param criteria: All convergence criteria
+ * @param tables: Followed output files (by filename)
+ * @param process: Process to signal (0 for none)
+ * @param signal: Signal to send
+ * @param converged: Whether the run has converged
+ * @param convergenceTime: Simulated time of the convergence (-1 if not converged)
+ */
+class SteadyStateMonitor {
+	public:
+		SteadyStateMonitor(){};
+
+		std::string outputDirectory = "";
+		std::vector<SteadyStateCriterion> criteria;
+		std::atomic<int> process{0};
+		std::atomic<int> signal{0};
+
+		std::atomic<bool> converged{false};
+		std::atomic<double> convergenceTime{-1};
+
+		void init(std::string);
+		void addCriterion(std::string, std::string, double, double, double);
+		bool update();
+		bool run(TaskControl*, int);
+
+	private:
+		std::map<std::string, OutputTable> tables;
+
+		bool updateCriterion(SteadyStateCriterion&);
+		void finish();
+};
@@ -0,0 +1,687 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "surrogate_model.h"
+#include "../spec_vali_reader/spec_tree.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Train the model on a summary of runs
+ *
+ * @param table: Summary of RunAnalytics (tab separated, header line, first column "run")
+ * @param kpis: Names of the KPI columns (the outputs)
+ * @param methodName: "kriging", "linear" or "quadratic"
+ * @param smoothing: Relative noise variance (0: interpolate the runs)
+ * @return Bool if the method is known and at least two runs have all values
+ */
+bool SurrogateModel::
+train(const std::string& table, const std::vector<std::string>& kpis, std::string methodName, double smoothing)
+{
+	static const std::map<std::string, int> methods = {{"kriging", Kriging}, {"linear", Linear}, {"quadratic", Quadratic}};
+	std::map<std::string, int>::const_iterator it = methods.find(methodName);
+	if(it == methods.end() || kpis.empty())
+		return false;
+	this->method = it->second;
+	this->nugget = (smoothing > 0) ? smoothing : 1e-6;
+	this->runs = 0;
+
+	std::vector<std::vector<std::string>> cells;
+	std::istringstream lineIter(table);
+	for(std::string line; std::getline(lineIter, line); )
+	{
+		std::vector<std::string> row;
+		std::istringstream cellIter(line);
+		for(std::string cell; std::getline(cellIter, cell, '\t'); )
+			row.push_back(cell);
+		if(!row.empty())
+			cells.push_back(row);
+	}
+	if(cells.size() < 3)
+		return false;
+	const std::vector<std::string>& header = cells[0];
+	const int numRows = (int) cells.size() - 1;
+	const int numColumns = (int) header.size();
+
+	// numerical value of every cell (NaN if missing), columns with text are no inputs
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	std::vector<std::vector<double>> values(numColumns, std::vector<double>(numRows, nan));
+	std::vector<bool> numerical(numColumns, true);
+	for(int col = 1; col < numColumns; col++)
+	{
+		for(int row = 0; row < numRows; row++)
+		{
+			if(col >= (int) cells[row+1].size() || cells[row+1][col].empty())
+				continue;
+			char* end;
+			values[col][row] = std::strtod(cells[row+1][col].c_str(), &end);
+			if(*end != '\0')
+			{
+				numerical[col] = false;
+				values[col][row] = nan;
+			}
+		}
+	}
+
+	std::vector<int> outputColumns;
+	for(const std::string& kpi : kpis)
+	{
+		int col = std::find(header.begin(), header.end(), kpi) - header.begin();
+		if(col == 0 || col >= numColumns || !numerical[col])
+			return false;
+		outputColumns.push_back(col);
+	}
+	std::vector<int> inputColumns;
+	for(int col = 1; col < numColumns; col++)
+		if(numerical[col] && std::find(outputColumns.begin(), outputColumns.end(), col) == outputColumns.end())
+			inputColumns.push_back(col);
+
+	std::vector<int> rows;
+	for(int row = 0; row < numRows; row++)
+	{
+		bool complete = true;
+		for(int col : inputColumns)
+			complete = complete && !std::isnan(values[col][row]);
+		for(int col : outputColumns)
+			complete = complete && !std::isnan(values[col][row]);
+		if(complete)
+			rows.push_back(row);
+	}
+	if(rows.size() < 2)
+		return false;
+
+	// inputs are the parameters which differ between the runs
+	this->inputs = {};
+	this->inputMin = {};
+	this->inputMax = {};
+	std::vector<int> used;
+	for(int col : inputColumns)
+	{
+		double low = values[col][rows[0]], high = low;
+		for(int row : rows)
+		{
+			low = std::min(low, values[col][row]);
+			high = std::max(high, values[col][row]);
+		}
+		if(high > low)
+		{
+			this->inputs.push_back(header[col]);
+			this->inputMin.push_back(low);
+			this->inputMax.push_back(high);
+			used.push_back(col);
+		}
+	}
+
+	this->outputs = kpis;
+	this->outputMean = {};
+	this->outputScale = {};
+	for(int col : outputColumns)
+	{
+		double sum = 0, squares = 0;
+		for(int row : rows)
+			sum += values[col][row];
+		double mean = sum / rows.size();
+		for(int row : rows)
+			squares += (values[col][row] - mean) * (values[col][row] - mean);
+		double deviation = std::sqrt(squares / rows.size());
+		this->outputMean.push_back(mean);
+		this->outputScale.push_back(deviation > 0 ? deviation : 1);
+	}
+
+	const int d = (int) this->inputs.size();
+	const int m = (int) this->outputs.size();
+	this->runs = (int) rows.size();
+	this->points.assign((std::size_t) this->runs * d, 0);
+	std::vector<double> y((std::size_t) this->runs * m);
+	for(int i = 0; i < this->runs; i++)
+	{
+		for(int k = 0; k < d; k++)
+			this->points[(std::size_t) i*d + k] = (values[used[k]][rows[i]] - this->inputMin[k])
+				/ (this->inputMax[k] - this->inputMin[k]);
+		for(int j = 0; j < m; j++)
+			y[(std::size_t) i*m + j] = (values[outputColumns[j]][rows[i]] - this->outputMean[j]) / this->outputScale[j];
+	}
+
+	bool trained = (this->method == Kriging) ? this->trainKriging(y) : this->trainPolynomial(y);
+	if(!trained)
+		this->runs = 0;
+	return trained;
+}
+
+/**
+ * Predict the KPIs of a run
+ *
+ * @param x: Values of the inputs (in the order of "inputs")
+ * @param mean: Predicted value of every output
+ * @param stddev: Standard deviation of the prediction of every output
+ * @return Bool if the model is trained and all inputs are numbers
+ */
+bool SurrogateModel::
+predict(const double* x, double* mean, double* stddev) const
+{
+	if(this->runs == 0)
+		return false;
+	const int d = (int) this->inputs.size();
+	const int p = this->terms();
+	const int m = (int) this->outputs.size();
+
+	std::vector<double> scaled(d), b(p);
+	for(int k = 0; k < d; k++)
+		if(std::isnan(x[k]))
+			return false;
+	this->scale(x, scaled.data());
+	this->basis(scaled.data(), b.data());
+
+	for(int j = 0; j < m; j++)
+	{
+		double sum = 0;
+		for(int i = 0; i < p; i++)
+			sum += b[i] * this->weights[(std::size_t) i*m + j];
+		mean[j] = this->outputMean[j] + sum * this->outputScale[j];
+	}
+
+	solveLower(this->factor, p, b.data());
+	double explained = 0;
+	for(int i = 0; i < p; i++)
+		explained += b[i] * b[i];
+	double relative = (this->method == Kriging) ? std::max(0.0, 1 + this->nugget - explained) : 1 + explained;
+	for(int j = 0; j < m; j++)
+		stddev[j] = std::sqrt(relative * this->variance[j]) * this->outputScale[j];
+	return true;
+}
+
+/**
+ * Predict the KPIs of a specification
+ *
+ * @param filepath: The specification file
+ * @param mean: Predicted value of every output
+ * @param stddev: Standard deviation of the prediction of every output
+ * @return Bool if the file could be read and holds all inputs as numbers
+ */
+bool SurrogateModel::
+predictSpec(std::string filepath, double* mean, double* stddev) const
+{
+	std::string input;
+	SpecTree tree;
+	if(!readSpecFile(filepath, input) || !tree.parse(input))
+		return false;
+	std::map<std::string, const SpecNode*> leaves;
+	tree.collectLeaves(leaves);
+
+	std::vector<double> x;
+	for(const std::string& name : this->inputs)
+	{
+		std::map<std::string, const SpecNode*>::const_iterator it = leaves.find(name);
+		if(it == leaves.end())
+			return false;
+		std::string value = it->second->normalizedValue();
+		char* end;
+		x.push_back(std::strtod(value.c_str(), &end));
+		if(*end != '\0')
+			return false;
+	}
+	return this->predict(x.data(), mean, stddev);
+}
+
+/**
+ * Suggest the next runs to simulate
+ *
+ * Picks the points of a Halton sequence in the range of the training
+ * runs where the prediction is most uncertain. After every pick the
+ * uncertainty is updated as if the point had been simulated, so the
+ * points spread out instead of piling up at the same spot.
+ *
+ * @param count: Number of points
+ * @return Table (tab separated, header line) with the inputs and the
+ * predicted value and standard deviation ("<name>_stddev") of every output
+ */
+std::string SurrogateModel::
+suggest(int count) const
+{
+	const int d = (int) this->inputs.size();
+	const int p = this->terms();
+	const int m = (int) this->outputs.size();
+	if(this->runs == 0 || d == 0 || count <= 0)
+		return "";
+
+	const int numCandidates = std::min(4096, 256 * d);
+	std::vector<int> primes;
+	for(int n = 2; (int) primes.size() < d; n++)
+	{
+		bool prime = true;
+		for(int q : primes)
+			prime = prime && (n % q != 0);
+		if(prime)
+			primes.push_back(n);
+	}
+
+	std::vector<double> candidates((std::size_t) numCandidates * d);
+	std::vector<std::vector<double>> projections(numCandidates);
+	std::vector<double> uncertainty(numCandidates);
+	this->parallel(numCandidates, [&](int c)
+	{
+		double* point = &candidates[(std::size_t) c*d];
+		for(int k = 0; k < d; k++)
+		{
+			double value = 0, fraction = 1;
+			for(int index = c+1; index > 0; index /= primes[k])
+			{
+				fraction /= primes[k];
+				value += fraction * (index % primes[k]);
+			}
+			point[k] = value;
+		}
+		std::vector<double>& v = projections[c];
+		v.resize(p);
+		this->basis(point, v.data());
+		solveLower(this->factor, p, v.data());
+		double explained = 0;
+		for(int i = 0; i < p; i++)
+			explained += v[i] * v[i];
+		uncertainty[c] = (this->method == Kriging) ? std::max(0.0, 1 + this->nugget - explained) : explained;
+	});
+
+	// condition the uncertainty on every picked point (Cholesky update)
+	const double noise = (this->method == Kriging) ? this->nugget : 1;
+	std::vector<std::vector<double>> updates(numCandidates);
+	std::vector<int> picked;
+	for(int n = 0; n < count && n < numCandidates; n++)
+	{
+		int best = -1;
+		for(int c = 0; c < numCandidates; c++)
+			if(std::find(picked.begin(), picked.end(), c) == picked.end()
+					&& (best < 0 || uncertainty[c] > uncertainty[best]))
+				best = c;
+		picked.push_back(best);
+
+		const std::vector<double> bestProjection = projections[best];
+		const std::vector<double> bestUpdate = updates[best];
+		const double pivot = std::sqrt(uncertainty[best] + noise);
+		this->parallel(numCandidates, [&](int c)
+		{
+			double covariance = 0;
+			for(int i = 0; i < p; i++)
+				covariance += projections[c][i] * bestProjection[i];
+			if(this->method == Kriging)
+				covariance = this->kernel(&candidates[(std::size_t) c*d], &candidates[(std::size_t) best*d],
+					this->lengthScale) - covariance;
+			for(std::size_t i = 0; i < bestUpdate.size(); i++)
+				covariance -= updates[c][i] * bestUpdate[i];
+			updates[c].push_back(covariance / pivot);
+			uncertainty[c] = std::max(0.0, uncertainty[c] - (covariance / pivot) * (covariance / pivot));
+		});
+	}
+
+	std::string list = "";
+	for(const std::string& name : this->inputs)
+		list += name + "\t";
+	for(const std::string& name : this->outputs)
+		list += name + "\t" + name + "_stddev\t";
+	list.back() = '\n';
+
+	char number[32];
+	std::vector<double> x(d), mean(m), stddev(m);
+	for(int c : picked)
+	{
+		std::string row = "";
+		for(int k = 0; k < d; k++)
+		{
+			x[k] = this->inputMin[k] + candidates[(std::size_t) c*d + k] * (this->inputMax[k] - this->inputMin[k]);
+			snprintf(number, sizeof(number), "%.12g", x[k]);
+			row += std::string(number) + "\t";
+		}
+		this->predict(x.data(), mean.data(), stddev.data());
+		for(int j = 0; j < m; j++)
+		{
+			snprintf(number, sizeof(number), "%.12g", mean[j]);
+			row += std::string(number) + "\t";
+			snprintf(number, sizeof(number), "%.12g", stddev[j]);
+			row += std::string(number) + "\t";
+		}
+		row.back() = '\n';
+		list += row;
+	}
+	return list;
+}
+
+/**
+ * Number of kernel points or polynomial terms
+ */
+int SurrogateModel::
+terms() const
+{
+	const int d = (int) this->inputs.size();
+	if(this->method == Kriging)
+		return this->runs;
+	if(this->method == Linear)
+		return 1 + d;
+	return 1 + d + d*(d+1)/2;
+}
+
+/**
+ * Scale inputs to the range [0,1] of the training runs
+ *
+ * @param x: Values of the inputs
+ * @param scaled: The scaled values
+ */
+void SurrogateModel::
+scale(const double* x, double* scaled) const
+{
+	for(std::size_t k = 0; k < this->inputs.size(); k++)
+		scaled[k] = (x[k] - this->inputMin[k]) / (this->inputMax[k] - this->inputMin[k]);
+}
+
+/**
+ * Evaluate the basis of the model at a point
+ *
+ * Kriging: the kernel between the point and every training run,
+ * polynomial: 1, x_k (and x_k*x_l for k <= l).
+ *
+ * @param x: Scaled inputs
+ * @param b: The basis ("terms()" values)
+ */
+void SurrogateModel::
+basis(const double* x, double* b) const
+{
+	const int d = (int) this->inputs.size();
+	if(this->method == Kriging)
+	{
+		for(int i = 0; i < this->runs; i++)
+			b[i] = this->kernel(x, &this->points[(std::size_t) i*d], this->lengthScale);
+		return;
+	}
+
+	int term = 0;
+	b[term++] = 1;
+	for(int k = 0; k < d; k++)
+		b[term++] = x[k];
+	if(this->method == Quadratic)
+		for(int k = 0; k < d; k++)
+			for(int l = k; l < d; l++)
+				b[term++] = x[k] * x[l];
+}
+
+/**
+ * Squared exponential kernel
+ *
+ * @param a: Scaled inputs of the first point
+ * @param b: Scaled inputs of the second point
+ * @param length: Length scale
+ * @return The correlation of the points
+ */
+double SurrogateModel::
+kernel(const double* a, const double* b, double length) const
+{
+	double distance = 0;
+	for(std::size_t k = 0; k < this->inputs.size(); k++)
+		distance += (a[k] - b[k]) * (a[k] - b[k]);
+	return std::exp(-0.5 * distance / (length * length));
+}
+
+/**
+ * Fit a Gaussian process
+ *
+ * The length scales are cross validated in parallel, the one with the
+ * smallest leave-one-out error is kept.
+ *
+ * @param y: Scaled outputs of the training runs (row wise)
+ * @return Bool if the kernel matrix could be factorized for one length scale
+ */
+bool SurrogateModel::
+trainKriging(const std::vector<double>& y)
+{
+	const double lengths[] = {0.05, 0.1, 0.15, 0.25, 0.4, 0.6, 1, 1.5, 2.5};
+	const int numLengths = sizeof(lengths) / sizeof(lengths[0]);
+	const double dimension = std::sqrt(std::max(1.0, (double) this->inputs.size()));
+
+	std::vector<double> errors(numLengths);
+	this->parallel(numLengths, [&](int i)
+	{
+		std::vector<double> l, w;
+		errors[i] = this->crossValidate(y, lengths[i] * dimension, l, w);
+	});
+	int best = std::min_element(errors.begin(), errors.end()) - errors.begin();
+	if(std::isinf(errors[best]))
+		return false;
+
+	this->lengthScale = lengths[best] * dimension;
+	this->crossValidate(y, this->lengthScale, this->factor, this->weights);
+
+	const int m = (int) this->outputs.size();
+	this->variance.assign(m, 0);
+	for(int i = 0; i < this->runs; i++)
+		for(int j = 0; j < m; j++)
+			this->variance[j] += y[(std::size_t) i*m + j] * this->weights[(std::size_t) i*m + j] / this->runs;
+	return true;
+}
+
+/**
+ * Fit a Gaussian process for one length scale
+ *
+ * @param y: Scaled outputs of the training runs (row wise)
+ * @param length: The length scale
+ * @param l: Cholesky factor of the kernel matrix
+ * @param w: Weights of the outputs
+ * @return Sum of the squared leave-one-out errors (infinity if the matrix is singular)
+ */
+double SurrogateModel::
+crossValidate(const std::vector<double>& y, double length, std::vector<double>& l, std::vector<double>& w) const
+{
+	const int n = this->runs;
+	const int d = (int) this->inputs.size();
+	const int m = (int) this->outputs.size();
+	l.assign((std::size_t) n*n, 0);
+	for(int i = 0; i < n; i++)
+	{
+		for(int j = 0; j <= i; j++)
+			l[(std::size_t) i*n + j] = this->kernel(&this->points[(std::size_t) i*d], &this->points[(std::size_t) j*d], length);
+		l[(std::size_t) i*n + i] += this->nugget;
+	}
+	if(!cholesky(l, n))
+		return std::numeric_limits<double>::infinity();
+
+	w = y;
+	std::vector<double> column(n);
+	for(int j = 0; j < m; j++)
+	{
+		for(int i = 0; i < n; i++)
+			column[i] = y[(std::size_t) i*m + j];
+		solveLower(l, n, column.data());
+		solveUpper(l, n, column.data());
+		for(int i = 0; i < n; i++)
+			w[(std::size_t) i*m + j] = column[i];
+	}
+
+	// diagonal of the inverse: squared norms of the columns of the inverse factor
+	std::vector<double> diagonal(n, 0);
+	for(int k = 0; k < n; k++)
+	{
+		std::fill(column.begin(), column.end(), 0);
+		column[k] = 1;
+		for(int i = k; i < n; i++)
+		{
+			double sum = column[i];
+			for(int j = k; j < i; j++)
+				sum -= l[(std::size_t) i*n + j] * column[j];
+			column[i] = sum / l[(std::size_t) i*n + i];
+			diagonal[k] += column[i] * column[i];
+		}
+	}
+
+	double error = 0;
+	for(int i = 0; i < n; i++)
+		for(int j = 0; j < m; j++)
+			error += std::pow(w[(std::size_t) i*m + j] / diagonal[i], 2);
+	return error;
+}
+
+/**
+ * Fit a polynomial by least squares
+ *
+ * @param y: Scaled outputs of the training runs (row wise)
+ * @return Bool if the normal matrix could be factorized
+ */
+bool SurrogateModel::
+trainPolynomial(const std::vector<double>& y)
+{
+	const int n = this->runs;
+	const int d = (int) this->inputs.size();
+	const int m = (int) this->outputs.size();
+	const int p = this->terms();
+
+	std::vector<double> design((std::size_t) n*p);
+	for(int i = 0; i < n; i++)
+		this->basis(&this->points[(std::size_t) i*d], &design[(std::size_t) i*p]);
+
+	this->factor.assign((std::size_t) p*p, 0);
+	this->parallel(p, [&](int a)
+	{
+		for(int b = 0; b <= a; b++)
+		{
+			double sum = 0;
+			for(int i = 0; i < n; i++)
+				sum += design[(std::size_t) i*p + a] * design[(std::size_t) i*p + b];
+			this->factor[(std::size_t) a*p + b] = sum;
+		}
+		this->factor[(std::size_t) a*p + a] += this->nugget * n;
+	});
+	if(!cholesky(this->factor, p))
+		return false;
+
+	this->weights.assign((std::size_t) p*m, 0);
+	this->variance.assign(m, 0);
+	std::vector<double> column(p);
+	for(int j = 0; j < m; j++)
+	{
+		std::fill(column.begin(), column.end(), 0);
+		for(int i = 0; i < n; i++)
+			for(int a = 0; a < p; a++)
+				column[a] += design[(std::size_t) i*p + a] * y[(std::size_t) i*m + j];
+		solveLower(this->factor, p, column.data());
+		solveUpper(this->factor, p, column.data());
+
+		double residuals = 0;
+		for(int i = 0; i < n; i++)
+		{
+			double fit = 0;
+			for(int a = 0; a < p; a++)
+				fit += design[(std::size_t) i*p + a] * column[a];
+			residuals += std::pow(y[(std::size_t) i*m + j] - fit, 2);
+		}
+		this->variance[j] = residuals / std::max(1, n - p);
+		for(int a = 0; a < p; a++)
+			this->weights[(std::size_t) a*m + j] = column[a];
+	}
+	return true;
+}
+
+/**
+ * Run a method for every item on one worker thread per core
+ *
+ * @param count: Number of items
+ * @param work: Method called as work(item) for every item
+ */
+template <class F>
+void SurrogateModel::
+parallel(int count, F work) const
+{
+	std::atomic<int> next{0};
+	std::vector<std::thread> workers;
+	int numWorkers = std::min((int) std::max(1u, std::thread::hardware_concurrency()), count);
+	for(int w = 0; w < numWorkers; w++)
+	{
+		workers.push_back(std::thread([&]()
+		{
+			for(int item = next++; item < count; item = next++)
+				work(item);
+		}));
+	}
+	for(std::thread& worker : workers)
+		worker.join();
+}
+
+/**
+ * Cholesky factorization of a symmetric positive definite matrix
+ *
+ * @param a: The lower triangle of the matrix (row wise), replaced by the factor
+ * @param n: Size of the matrix
+ * @return Bool if the matrix is positive definite
+ */
+bool SurrogateModel::
+cholesky(std::vector<double>& a, int n)
+{
+	for(int i = 0; i < n; i++)
+	{
+		double* row = &a[(std::size_t) i*n];
+		for(int j = 0; j <= i; j++)
+		{
+			const double* pivotRow = &a[(std::size_t) j*n];
+			double sum = row[j];
+			for(int k = 0; k < j; k++)
+				sum -= row[k] * pivotRow[k];
+			if(j < i)
+				row[j] = sum / pivotRow[j];
+			else if(sum > 0)
+				row[j] = std::sqrt(sum);
+			else
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Solve L*x = b in place
+ *
+ * @param l: The Cholesky factor (row wise)
+ * @param n: Size of the matrix
+ * @param b: Right hand side, replaced by the solution
+ */
+void SurrogateModel::
+solveLower(const std::vector<double>& l, int n, double* b)
+{
+	for(int i = 0; i < n; i++)
+	{
+		const double* row = &l[(std::size_t) i*n];
+		double sum = b[i];
+		for(int k = 0; k < i; k++)
+			sum -= row[k] * b[k];
+		b[i] = sum / row[i];
+	}
+}
+
+/**
+ * Solve L^T*x = b in place
+ *
+ * @param l: The Cholesky factor (row wise)
+ * @param n: Size of the matrix
+ * @param b: Right hand side, replaced by the solution
+ */
+void SurrogateModel::
+solveUpper(const std::vector<double>& l, int n, double* b)
+{
+	for(int i = n-1; i >= 0; i--)
+	{
+		double sum = b[i];
+		for(int k = i+1; k < n; k++)
+			sum -= l[(std::size_t) k*n + i] * b[k];
+		b[i] = sum / l[(std::size_t) i*n + i];
+	}
+}
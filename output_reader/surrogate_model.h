@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * Class to predict the KPIs of a run from its parameters
+ *
+ * Trained on the summary of RunAnalytics (one row per finished run with
+ * its parameters and KPIs), so screening studies can skip runs whose
+ * outcome is predicted well enough. Every numerical parameter column
+ * which differs between the runs is an input, the KPIs are the outputs.
+ * Rows with a missing value are skipped.
+ *
+ * Methods:
+ * kriging (Gaussian process with a squared exponential kernel, the
+ * length scale is chosen by leave-one-out cross validation),
+ * linear and quadratic (polynomial least squares).
+ *
+ * Inputs are scaled to [0,1] and outputs to mean 0 and deviation 1 of
+ * the training data. A prediction costs O(n*d) for the mean and O(n^2)
+ * for the deviation (kriging, n runs, d inputs) or O(p^2) (polynomial,
+ * p terms), so it takes microseconds for a few hundred runs.
+ *
+ * @param method: The method (see SurrogateModel::Method)
+ * @param inputs: Names of the inputs (paths of the parameters)
+ * @param outputs: Names of the outputs (KPIs)
+ * @param inputMin: Smallest training value of every input
+ * @param inputMax: Largest training value of every input
+ * @param outputMean: Mean training value of every output
+ * @param outputScale: Standard deviation of the training values of every output
+ * @param runs: Number of training runs
+ * @param points: Scaled inputs of the training runs (kriging, row wise)
+ * @param lengthScale: Length scale of the kernel (kriging)
+ * @param nugget: Relative noise variance added to the diagonal
+ * @param factor: Cholesky factor of the kernel or normal matrix (row wise, lower)
+ * @param weights: Weights of every output (row wise, one row per kernel point or polynomial term)
+ * @param variance: Scaled variance of every output
+ */
+class SurrogateModel {
+	public:
+		enum Method {Kriging, Linear, Quadratic};
+
+		SurrogateModel(){};
+
+		int method = Kriging;
+		std::vector<std::string> inputs;
+		std::vector<std::string> outputs;
+		std::vector<double> inputMin;
+		std::vector<double> inputMax;
+		std::vector<double> outputMean;
+		std::vector<double> outputScale;
+		int runs = 0;
+		std::vector<double> points;
+		double lengthScale = 0;
+		double nugget = 1e-6;
+		std::vector<double> factor;
+		std::vector<double> weights;
+		std::vector<double> variance;
+
+		bool train(const std::string&, const std::vector<std::string>&, std::string, double);
+		bool predict(const double*, double*, double*) const;
+		bool predictSpec(std::string, double*, double*) const;
+		std::string suggest(int) const;
+
+	private:
+		int terms() const;
+		void scale(const double*, double*) const;
+		void basis(const double*, double*) const;
+		double kernel(const double*, const double*, double) const;
+		bool trainKriging(const std::vector<double>&);
+		bool trainPolynomial(const std::vector<double>&);
+		double crossValidate(const std::vector<double>&, double, std::vector<double>&, std::vector<double>&) const;
+		template <class F>
+		void parallel(int, F) const;
+
+		static bool cholesky(std::vector<double>&, int);
+		static void solveLower(const std::vector<double>&, int, double*);
+		static void solveUpper(const std::vector<double>&, int, double*);
+};
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "windowed_table.h"
+#include "output_table.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Memory of a parsed chunk
+ *
+ * @param table: The parsed chunk
+ * @return Size of all columns in bytes
+ */
+static long long chunkMemory(const OutputTable& table)
+{
+	long long bytes = 0;
+	for(int i=0; i<table.columns(); i++)
+		bytes += table.column(i).capacity() * sizeof(double);
+	return bytes;
+}
+
+/**
+ * Open an output file
+ *
+ * Indexes the whole file. Only the chunks at the end of the file
+ * stay in the cache.
+ *
+ * @param path: The absolute path to the output file
+ * @param chunkSize: Size of a chunk in bytes
+ * @param memoryLimit: Maximal size of all parsed chunks in bytes (at least one chunk is kept)
+ * @return Bool if the file could be read
+ */
+bool WindowedTable::
+open(std::string path, long long chunkSize, long long memoryLimit)
+{
+	this->filepath = path;
+	this->chunkSize = std::max(chunkSize, 4096LL);
+	this->memoryLimit = memoryLimit;
+	this->chunks = {};
+	this->header = {};
+	this->numColumns = 0;
+	this->decoded = {};
+	this->cached = {};
+	this->lastUse = {};
+	this->memory = 0;
+
+	struct stat info;
+	if(stat(this->filepath.c_str(), &info) != 0)
+		return false;
+	this->update();
+	return true;
+}
+
+/**
+ * Number of rows
+ *
+ * @return Number of rows of all chunks
+ */
+long long WindowedTable::
+rows() const
+{
+	if(this->chunks.empty())
+		return 0;
+	return this->chunks.back().firstRow + this->chunks.back().rows;
+}
+
+/**
+ * Index the rows appended to the file
+ *
+ * A last chunk smaller than "chunkSize" is indexed again together
+ * with the new rows, so following a running simulation does not
+ * produce many small chunks. If the file got smaller, it is indexed
+ * again from the start.
+ *
+ * @return Number of new rows or -1 if the file was indexed again
+ */
+int WindowedTable::
+update()
+{
+	struct stat info;
+	if(stat(this->filepath.c_str(), &info) != 0)
+		return 0;
+	long long size = info.st_size;
+
+	long long indexed = this->chunks.empty() ? 0 : this->chunks.back().end;
+	if(size < indexed)
+	{
+		this->open(this->filepath, this->chunkSize, this->memoryLimit);
+		return -1;
+	}
+	if(size == indexed)
+		return 0;
+
+	long long oldRows = this->rows();
+	if(!this->chunks.empty() && this->chunks.back().end - this->chunks.back().begin < this->chunkSize)
+	{
+		this->drop(this->chunks.size()-1);
+		indexed = this->chunks.back().begin;
+		this->chunks.pop_back();
+		this->decoded.pop_back();
+		this->lastUse.pop_back();
+	}
+
+	while(indexed < size)
+	{
+		OutputTable table;
+		long long end = std::min(size, indexed + this->chunkSize);
+		long long parsedEnd = indexed;
+		while(this->decode(indexed, end, table, parsedEnd) && parsedEnd == indexed && end < size)
+			end = std::min(size, end + this->chunkSize);
+		if(parsedEnd == indexed)
+			break;
+
+		WindowedChunk chunk;
+		chunk.begin = indexed;
+		chunk.end = parsedEnd;
+		chunk.firstRow = this->rows();
+		chunk.rows = table.rows();
+		chunk.firstTime = this->chunks.empty() ? -std::numeric_limits<double>::infinity() : this->chunks.back().lastTime;
+		chunk.lastTime = chunk.firstTime;
+		if(chunk.rows > 0)
+		{
+			chunk.firstTime = table.column(0).front();
+			chunk.lastTime = table.column(0).back();
+		}
+		if(this->header.empty())
+			this->header = table.columnNames();
+		if(this->numColumns == 0)
+			this->numColumns = table.columns();
+
+		this->chunks.push_back(chunk);
+		this->decoded.push_back(OutputTable());
+		this->lastUse.push_back(0);
+		this->cache(this->chunks.size()-1, table);
+		indexed = parsedEnd;
+	}
+
+	return (int) (this->rows() - oldRows);
+}
+
+/**
+ * Map a part of the file and parse all complete lines
+ *
+ * @param begin: Offset of the first byte
+ * @param end: Offset behind the last byte
+ * @param table: Table to fill (previous data is removed)
+ * @param parsedEnd: Offset behind the last complete line
+ * @return Bool if the file could be mapped
+ */
+bool WindowedTable::
+decode(long long begin, long long end, OutputTable& table, long long& parsedEnd) const
+{
+	table.clear();
+	parsedEnd = begin;
+	if(end <= begin)
+		return true;
+
+	int file = ::open(this->filepath.c_str(), O_RDONLY);
+	if(file < 0)
+		return false;
+	long long page = sysconf(_SC_PAGESIZE);
+	long long aligned = begin - begin % page;
+	void* map = mmap(nullptr, end - aligned, PROT_READ, MAP_PRIVATE, file, aligned);
+	close(file);
+	if(map == MAP_FAILED)
+		return false;
+	madvise(map, end - aligned, MADV_SEQUENTIAL);
+
+	const char* data = (const char*) map + (begin - aligned);
+	parsedEnd = begin + (table.parseLines(data, data + (end - begin)) - data);
+	munmap(map, end - aligned);
+	table.shrink();
+	return true;
+}
+
+/**
+ * Getter method for a parsed chunk
+ *
+ * The chunk is parsed again if it is not in the cache. The reference
+ * is valid until the next call.
+ *
+ * @param index: Index of the chunk
+ * @return The parsed chunk (empty if the file could not be read)
+ */
+const OutputTable& WindowedTable::
+chunk(int index)
+{
+	if(std::find(this->cached.begin(), this->cached.end(), index) != this->cached.end())
+	{
+		this->lastUse[index] = ++this->useCounter;
+		return this->decoded[index];
+	}
+
+	OutputTable table;
+	long long parsedEnd;
+	if(this->decode(this->chunks[index].begin, this->chunks[index].end, table, parsedEnd))
+		this->cache(index, table);
+	return this->decoded[index];
+}
+
+/**
+ * Put a parsed chunk into the cache
+ *
+ * Drops the least recently used chunks while the cache is larger
+ * than "memoryLimit".
+ *
+ * @param index: Index of the chunk
+ * @param table: The parsed chunk (moved into the cache)
+ */
+void WindowedTable::
+cache(int index, OutputTable& table)
+{
+	this->memory += chunkMemory(table);
+	this->decoded[index] = std::move(table);
+	this->cached.push_back(index);
+	this->lastUse[index] = ++this->useCounter;
+
+	while(this->memory > this->memoryLimit && this->cached.size() > 1)
+	{
+		int oldest = -1;
+		for(int other : this->cached)
+			if(other != index && (oldest < 0 || this->lastUse[other] < this->lastUse[oldest]))
+				oldest = other;
+		this->drop(oldest);
+	}
+}
+
+/**
+ * Remove a chunk from the cache
+ *
+ * @param index: Index of the chunk
+ */
+void WindowedTable::
+drop(int index)
+{
+	std::vector<int>::iterator it = std::find(this->cached.begin(), this->cached.end(), index);
+	if(it == this->cached.end())
+		return;
+	this->memory -= chunkMemory(this->decoded[index]);
+	this->decoded[index] = OutputTable();
+	this->cached.erase(it);
+}
+
+/**
+ * Find the first row at or behind a time
+ *
+ * Only the chunk holding the row is parsed.
+ *
+ * @param time: The time
+ * @param behind: Whether the row has to be behind the time (else at or behind)
+ * @return Index of the row or "rows()" if there is none
+ */
+long long WindowedTable::
+findRow(double time, bool behind)
+{
+	int low = 0, high = this->chunks.size();
+	while(low < high)
+	{
+		int mid = (low + high) / 2;
+		double last = this->chunks[mid].lastTime;
+		if(behind ? last > time : last >= time)
+			high = mid;
+		else
+			low = mid+1;
+	}
+	while(low < (int) this->chunks.size() && this->chunks[low].rows == 0)
+		++low;
+	if(low == (int) this->chunks.size())
+		return this->rows();
+
+	const OutputTable& table = this->chunk(low);
+	if(table.columns() == 0)
+		return this->chunks[low].firstRow;
+	const std::vector<double>& times = table.column(0);
+	std::vector<double>::const_iterator row = behind ? std::upper_bound(times.begin(), times.end(), time)
+		: std::lower_bound(times.begin(), times.end(), time);
+	return this->chunks[low].firstRow + (row - times.begin());
+}
+
+/**
+ * Number of rows within a time window
+ *
+ * @param start: Start of the window
+ * @param end: End of the window
+ * @return Number of rows with start <= time <= end
+ */
+long long WindowedTable::
+windowRows(double start, double end)
+{
+	return std::max(0LL, this->findRow(end, true) - this->findRow(start, false));
+}
+
+/**
+ * Read a column within a time window
+ *
+ * If the window holds more than "maxPoints" rows, it is split into
+ * maxPoints/2 buckets of equal row count and the minimum and the
+ * maximum of every bucket are returned (in the order of their rows),
+ * so peaks stay visible in a plot.
+ *
+ * @param col: Index of the column
+ * @param start: Start of the window
+ * @param end: End of the window
+ * @param maxPoints: Maximal number of points (0: all rows)
+ * @param x: The times
+ * @param y: The values
+ * @return Number of rows within the window or -1 if the column does not exist
+ */
+long long WindowedTable::
+window(int col, double start, double end, int maxPoints, std::vector<double>& x, std::vector<double>& y)
+{
+	x.clear();
+	y.clear();
+	if(col < 0 || col >= this->numColumns)
+		return -1;
+
+	long long first = this->findRow(start, false);
+	long long last = this->findRow(end, true);
+	if(last <= first)
+		return 0;
+	long long count = last - first;
+	long long buckets = (maxPoints > 0 && count > maxPoints) ? std::max(1, maxPoints/2) : 0;
+	x.reserve(buckets > 0 ? 2*buckets : count);
+	y.reserve(buckets > 0 ? 2*buckets : count);
+
+	int low = 0, high = this->chunks.size();
+	while(low < high)
+	{
+		int mid = (low + high) / 2;
+		if(this->chunks[mid].firstRow + this->chunks[mid].rows > first)
+			high = mid;
+		else
+			low = mid+1;
+	}
+
+	long long row = first;
+	long long bucket = 0;
+	long long bucketEnd = buckets > 0 ? first + count/buckets : last;
+	long long minRow = -1, maxRow = -1;
+	double minTime = 0, minValue = 0, maxTime = 0, maxValue = 0;
+	for(int index = low; row < last; index++)
+	{
+		const WindowedChunk& info = this->chunks[index];
+		if(info.rows == 0)
+			continue;
+		const OutputTable& table = this->chunk(index);
+		if(col >= table.columns())
+			return -1;
+		const std::vector<double>& times = table.column(0);
+		const std::vector<double>& values = table.column(col);
+
+		long long stop = std::min(last, info.firstRow + info.rows);
+		for(; row < stop; row++)
+		{
+			std::size_t i = row - info.firstRow;
+			if(buckets == 0)
+			{
+				x.push_back(times[i]);
+				y.push_back(values[i]);
+				continue;
+			}
+
+			if(minRow < 0 || values[i] < minValue || std::isnan(minValue))
+			{
+				minRow = row;
+				minTime = times[i];
+				minValue = values[i];
+			}
+			if(maxRow < 0 || values[i] > maxValue || std::isnan(maxValue))
+			{
+				maxRow = row;
+				maxTime = times[i];
+				maxValue = values[i];
+			}
+			if(row+1 < bucketEnd)
+				continue;
+
+			if(minRow > maxRow)
+			{
+				std::swap(minRow, maxRow);
+				std::swap(minTime, maxTime);
+				std::swap(minValue, maxValue);
+			}
+			x.push_back(minTime);
+			y.push_back(minValue);
+			if(maxRow != minRow)
+			{
+				x.push_back(maxTime);
+				y.push_back(maxValue);
+			}
+			minRow = maxRow = -1;
+			++bucket;
+			bucketEnd = first + count*(bucket+1)/buckets;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "output_table.h"
+#include <string>
+#include <vector>
+
+/**
+ * Class to describe one chunk of a WindowedTable
+ *
+ * @param begin: Offset of the first byte in the file
+ * @param end: Offset behind the last '\n' of the chunk
+ * @param firstRow: Number of rows in all previous chunks
+ * @param rows: Number of rows
+ * @param firstTime: Time (first column) of the first row
+ * @param lastTime: Time of the last row
+ */
+class WindowedChunk {
+	public:
+		WindowedChunk(){};
+
+		long long begin = 0;
+		long long end = 0;
+		long long firstRow = 0;
+		long long rows = 0;
+		double firstTime = 0.0;
+		double lastTime = 0.0;
+};
+
+/**
+ * Class to read an output file too large to be held in memory
+ *
+ * The file is split into chunks of about "chunkSize" bytes (at line
+ * ends). Opening the file parses it once to index the chunks, after
+ * that a chunk is only mapped and parsed again when a query needs it.
+ * Parsed chunks are kept in a cache, the least recently used chunks
+ * are dropped as soon as the cache exceeds "memoryLimit" bytes. So
+ * the memory does not depend on the size of the file.
+ *
+ * The first column has to be the time and must not decrease.
+ *
+ * @param filepath: The absolute path to the output file
+ * @param chunkSize: Size of a chunk in bytes
+ * @param memoryLimit: Maximal size of all parsed chunks in bytes
+ * @param chunks: Index of all chunks
+ * @param header: Column names of the file
+ * @param numColumns: Number of columns
+ * @param decoded: Parsed chunks (empty if not cached)
+ * @param cached: Indices of all parsed chunks
+ * @param lastUse: Time stamp of the last use of every chunk
+ * @param useCounter: Current time stamp
+ * @param memory: Size of all parsed chunks in bytes
+ */
+class WindowedTable {
+	public:
+		WindowedTable(){};
+
+		bool open(std::string, long long, long long);
+		int update();
+
+		long long rows() const;
+		int columns() const { return this->numColumns; }
+		int findColumn(const std::string& name) const { return findOutputColumn(this->header, name); }
+		const std::string& path() const { return this->filepath; }
+		long long memoryUsage() const { return this->memory; }
+
+		long long windowRows(double, double);
+		long long window(int, double, double, int, std::vector<double>&, std::vector<double>&);
+
+	private:
+		std::string filepath;
+		long long chunkSize = 0;
+		long long memoryLimit = 0;
+		std::vector<WindowedChunk> chunks;
+		std::vector<std::string> header;
+		int numColumns = 0;
+
+		std::vector<OutputTable> decoded;
+		std::vector<int> cached;
+		std::vector<unsigned long long> lastUse;
+		unsigned long long useCounter = 0;
+		long long memory = 0;
+
+		bool decode(long long, long long, OutputTable&, long long&) const;
+		const OutputTable& chunk(int);
+		void cache(int, OutputTable&);
+		void drop(int);
+		long long findRow(double, bool);
+};
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include <cstdlib>
+
+/**
+ * Validate one specification file of a batch
+ *
+ * Works on a copy of the reader, so the loaded validation data is
+ * shared by all files and the loaded specification stays unchanged.
+ *
+ * @param file: The path to the specification file
+ * @param paths: Paths of all entries (see entryPaths())
+ * @return Report of the file: "file\tstatus\terrors\n" followed by
+ * one line "\tindex\tpath\tmessage\n" per error
+ */
+std::string BiogasSpecValiReader::
+validateBatchFile(const std::string& file, const std::vector<std::string>& paths) const
+{
+	BiogasSpecValiReader reader(*this);
+	std::string status = "unreadable";
+	try
+	{
+		if(reader.init_Spec(file.c_str()))
+			status = reader.validateSpecs(reader.specString) ? "valid" : "invalid";
+	}
+	catch(const std::exception&)
+	{
+		return file + "\tfailed\t0\n";
+	}
+	if(status == "unreadable")
+		return file + "\tunreadable\t0\n";
+
+	std::string errors = "";
+	int count = 0;
+	std::istringstream messages(reader.validationMessage);
+	std::istringstream params(reader.validationErrorParams);
+	for(std::string message, param; std::getline(messages, message); count++)
+	{
+		std::getline(params, param);
+		int index = std::atoi(param.c_str());
+		std::string path = (index >= 0 && index < (int) paths.size()) ? paths[index] : "";
+		errors += "\t" + param + "\t" + path + "\t" + message + "\n";
+	}
+	return file + "\t" + status + "\t" + std::to_string(count) + "\n" + errors;
+}
+
+/**
+ * Validate many specification files against the loaded validation file
+ *
+ * The files are distributed over one worker thread per core. The
+ * report ("batchReport") lists the files in the given order, every
+ * file with its status (valid, invalid, unreadable or failed) and the
+ * number of errors, followed by its errors as in "validationMessage"
+ * with the index and path of the parameter.
+ *
+ * @param files: The paths to the specification files
+ * @param reportFile: File to write the report to ("" for none)
+ * @param control: Progress and cancellation (optional)
+ * @return Bool if all files are valid (and the report could be written)
+ */
+bool BiogasSpecValiReader::
+validateSpecBatch(const std::vector<std::string>& files, std::string reportFile, TaskControl* control)
+{
+	this->batchReport = "";
+	std::vector<std::string> paths = this->entryPaths();
+	std::vector<std::string> reports(files.size());
+
+	std::atomic<int> next{0};
+	std::atomic<int> finished{0};
+	std::atomic<bool> cancelled{false};
+	std::vector<std::thread> workers;
+	int numWorkers = std::max(1u, std::thread::hardware_concurrency());
+	numWorkers = std::min(numWorkers, (int) files.size());
+	for(int w=0; w<numWorkers; w++)
+	{
+		workers.push_back(std::thread([&]()
+		{
+			for(int file = next++; file < (int) files.size() && !cancelled; file = next++)
+			{
+				reports[file] = this->validateBatchFile(files[file], paths);
+				if(!taskStep(control, 100 * (++finished) / (int) files.size()))
+					cancelled = true;
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+		worker.join();
+	if(cancelled)
+		return false;
+
+	bool valid = true;
+	for(const std::string& report : reports)
+	{
+		this->batchReport += report;
+		valid = valid && report.compare(report.find('\t'), 7, "\tvalid\t") == 0;
+	}
+
+	if(reportFile.empty())
+		return valid;
+	std::ofstream file(reportFile);
+	file << this->batchReport;
+	return file.good() && valid;
+}
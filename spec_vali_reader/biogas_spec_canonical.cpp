@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include "spec_tree.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+
+/**
+ * Generate the paths of all entries
+ *
+ * The path of an entry are the LeftCells of all its parent folders
+ * and its own LeftCell (without quotes) delimited by '.', e.g.
+ * "problem.initialValues.analysis.Lipids".
+ *
+ * @return The paths in the order of the "entries"
+ */
+std::vector<std::string> BiogasSpecValiReader::
+entryPaths() const
+{
+	std::vector<std::string> paths(this->number_of_entries);
+	std::vector<std::string> parents;
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		int indent = this->entries.indent[i];
+		if(indent < 0)
+			indent = 0;
+		parents.resize(indent);
+		std::string key = plainSpecKey(this->entries.leftCell(i));
+		paths[i] = parents.empty() ? key : parents.back() + "." + key;
+		parents.push_back(paths[i]);
+	}
+	return paths;
+}
+
+/**
+ * Normalize a default value of the validation file
+ *
+ * Default values are stored without quotes, so strings get their
+ * quotes back to be comparable with the specification.
+ *
+ * @param type: Type of the parameter
+ * @param defaultVal: The default value
+ * @return The normalized value
+ */
+static std::string normalizedDefault(const std::string& type, const std::string& defaultVal)
+{
+	if(type == "String")
+		return "\"" + defaultVal + "\"";
+	if(type == "String[]")
+		return "{\"" + defaultVal + "\"}";
+
+	SpecNode node;
+	node.value = defaultVal;
+	return node.normalizedValue();
+}
+
+/**
+ * Canonicalize a specification file
+ *
+ * Generates a normalized form of the specification which does not
+ * depend on whitespaces, comments, the order of the parameters or
+ * the notation of numbers ("canonicalSpec"): one line "path=value"
+ * per parameter, sorted by path. Parameters which are missing in the
+ * specification get the default of the loaded validation file.
+ * The "specHash" is the hash of this normalized form.
+ *
+ * @param filepath: The absolute path to the specification file
+ * @return Bool if the file could be read and parsed
+ */
+bool BiogasSpecValiReader::
+canonicalizeSpec(std::string filepath)
+{
+	this->canonicalSpec = "";
+	this->specHash = "";
+
+	std::string input;
+	SpecTree tree;
+	if(!readSpecFile(filepath, input) || !tree.parse(input))
+		return false;
+
+	std::map<std::string, const SpecNode*> leaves;
+	tree.collectLeaves(leaves);
+
+	std::map<std::string, std::string> canonical;
+	for(const std::pair<const std::string, const SpecNode*>& leaf : leaves)
+		canonical[leaf.first] = leaf.second->normalizedValue();
+
+	std::vector<std::string> paths = this->entryPaths();
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		if(this->entries.glyph[i] != 0 || this->entries.leftCell(i) == "timeTableContent" || this->entries.defaultVal(i).empty())
+			continue;
+		if(canonical.find(paths[i]) == canonical.end())
+			canonical[paths[i]] = normalizedDefault(this->entries.type(i), this->entries.defaultVal(i));
+	}
+
+	for(const std::pair<const std::string, std::string>& param : canonical)
+		this->canonicalSpec += param.first + "=" + param.second + "\n";
+	this->specHash = formatSpecHash(hashSpecString(this->canonicalSpec));
+	return true;
+}
+
+/**
+ * Store the hash of the specification with the output of a run
+ *
+ * Writes "specHash.txt" into the output directory. The first line
+ * holds the "specHash", followed by the "canonicalSpec".
+ *
+ * @param outputDir: The output directory of the run
+ * @return Bool if the file could be written
+ */
+bool BiogasSpecValiReader::
+writeSpecHash(std::string outputDir) const
+{
+	if(this->specHash.empty())
+		return false;
+
+	if(!outputDir.empty() && outputDir.back() != '/')
+		outputDir += "/";
+	std::ofstream hashFile(outputDir + "specHash.txt");
+	if(!hashFile.good())
+		return false;
+	hashFile << this->specHash << "\n" << this->canonicalSpec;
+	return hashFile.good();
+}
+
+/**
+ * Check if a run directory holds the output for the current specification
+ *
+ * @param runDir: The run directory (with trailing '/')
+ * @return Bool if "specHash.txt" matches hash and normalized form
+ */
+bool BiogasSpecValiReader::
+matchesSpecHash(std::string runDir) const
+{
+	std::ifstream hashFile(runDir + "specHash.txt");
+	if(!hashFile.good())
+		return false;
+
+	std::string hash;
+	std::getline(hashFile, hash);
+	if(hash != this->specHash)
+		return false;
+
+	std::stringstream canonical;
+	canonical << hashFile.rdbuf();
+	return canonical.str() == this->canonicalSpec;
+}
+
+/**
+ * Find a finished run of the current specification
+ *
+ * Searches the given directory and all its direct subdirectories
+ * for a "specHash.txt" with the same hash and normalized form.
+ *
+ * @param runsDir: Directory holding the output directories of all runs
+ * @return The directory of the run or "" if no run matches
+ */
+std::string BiogasSpecValiReader::
+findRunBySpecHash(std::string runsDir) const
+{
+	if(this->specHash.empty())
+		return "";
+
+	if(!runsDir.empty() && runsDir.back() != '/')
+		runsDir += "/";
+	if(this->matchesSpecHash(runsDir))
+		return runsDir;
+
+	DIR* dir = opendir(runsDir.c_str());
+	if(dir == nullptr)
+		return "";
+
+	std::string runDir = "";
+	for(struct dirent* item = readdir(dir); item != nullptr && runDir.empty(); item = readdir(dir))
+	{
+		std::string name = item->d_name;
+		if(name == "." || name == "..")
+			continue;
+		if(this->matchesSpecHash(runsDir + name + "/"))
+			runDir = runsDir + name + "/";
+	}
+	closedir(dir);
+	return runDir;
+}
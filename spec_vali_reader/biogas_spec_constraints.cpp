@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include "spec_tree.h"
+#include "spec_constraint.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+
+/**
+ * Remove all constraints from the validation input
+ *
+ * The constraints ("constraint" keyword of a parameter) are stored
+ * with the path of their parameter and removed from the "input",
+ * so the other methods parsing the validation file do not see them.
+ *
+ * @return Bool if the validation file could be parsed
+ */
+bool BiogasSpecValiReader::
+extractConstraints()
+{
+	this->constraintSources = {};
+
+	SpecTree tree;
+	if(!tree.parse(this->input))
+		return true;
+
+	std::map<std::string, const SpecNode*> leaves;
+	tree.collectLeaves(leaves);
+	for(const std::pair<const std::string, const SpecNode*>& leaf : leaves)
+	{
+		const std::string suffix = ".constraint";
+		if(leaf.first.size() <= suffix.size() || leaf.first.compare(leaf.first.size()-suffix.size(), suffix.size(), suffix) != 0)
+			continue;
+		std::string expression = leaf.second->value;
+		if(expression.size() < 2 || expression.front() != '"' || expression.back() != '"')
+			return false;
+		this->constraintSources.push_back(std::make_pair(leaf.first.substr(0, leaf.first.size()-suffix.size()),
+			expression.substr(1, expression.size()-2)));
+	}
+
+	const std::string keyword = "constraint=\"";
+	for(std::string::size_type start = this->input.find(keyword); start != std::string::npos; start = this->input.find(keyword, start))
+	{
+		std::string::size_type end = this->input.find('"', start+keyword.size());
+		if(end == std::string::npos)
+			return false;
+		++end;
+		if(end < this->input.size() && this->input[end] == ',')
+			++end;
+		else if(start > 0 && this->input[start-1] == ',')
+			--start;
+		this->input.erase(start, end-start);
+	}
+	return true;
+}
+
+/**
+ * Compile all constraints of the validation file
+ *
+ * Has to be called after "generateValues()". A path stands for its
+ * parameter, for all rows of a time table (their times) or, ending
+ * with ".*", for all parameters of a folder.
+ *
+ * @return Bool if all constraints are valid
+ */
+bool BiogasSpecValiReader::
+compileConstraints()
+{
+	std::vector<SpecConstraint> constraints;
+	std::vector<std::vector<int>> constraintsByEntry(this->number_of_entries);
+	this->constraints = std::make_shared<const std::vector<SpecConstraint>>();
+	this->constraintsByEntry = std::make_shared<const std::vector<std::vector<int>>>(constraintsByEntry);
+	this->constraintValues = {};
+	this->constraintResults = {};
+
+	std::vector<std::string> paths = this->entryPaths();
+	SpecConstraint::Resolver resolve = [this, &paths](const std::string& path, std::vector<int>& indices)
+	{
+		bool wildcard = path.size() > 2 && path.compare(path.size()-2, 2, ".*") == 0;
+		std::string prefix = wildcard ? path.substr(0, path.size()-1) : "";
+		for(int i=0; i<this->number_of_entries; i++)
+		{
+			if(this->entries.leftCell(i) == "timeTableContent")
+				continue;
+			if(wildcard)
+			{
+				if(this->entries.glyph[i] == 0 && paths[i].compare(0, prefix.size(), prefix) == 0
+						&& paths[i].find('.', prefix.size()) == std::string::npos)
+					indices.push_back(i);
+				continue;
+			}
+			if(paths[i] != path)
+				continue;
+
+			if(this->entries.glyph[i] == 0)
+				indices.push_back(i);
+			for(int row = i+1; row < this->number_of_entries && this->entries.leftCell(row) == "timeTableContent"; row++)
+				indices.push_back(row);
+			return !indices.empty();
+		}
+		return !indices.empty();
+	};
+
+	for(const std::pair<std::string, std::string>& source : this->constraintSources)
+	{
+		SpecConstraint constraint;
+		constraint.expression = source.second;
+		for(int i=0; i<this->number_of_entries && constraint.owner < 0; i++)
+			if(paths[i] == source.first)
+				constraint.owner = i;
+		if(constraint.owner < 0 || !constraint.compile(resolve))
+			return false;
+
+		for(int index : constraint.dependencies)
+			constraintsByEntry[index].push_back(constraints.size());
+		constraints.push_back(constraint);
+	}
+	this->constraintResults.assign(constraints.size(), 1);
+	this->constraints = std::make_shared<const std::vector<SpecConstraint>>(std::move(constraints));
+	this->constraintsByEntry = std::make_shared<const std::vector<std::vector<int>>>(std::move(constraintsByEntry));
+	return true;
+}
+
+/**
+ * Numerical value of a specification for the constraints
+ *
+ * @param index: Index of the parameter
+ * @param spec: The specification
+ * @return The number (1/0 for booleans, the time for rows of time tables) or NaN
+ */
+double BiogasSpecValiReader::
+constraintValue(int index, const std::string& spec) const
+{
+	double value, time;
+	if(this->entries.leftCell(index) == "timeTableContent")
+		return parseSpecTimeStamp(spec, time, value) ? time : std::numeric_limits<double>::quiet_NaN();
+	if(spec == "true" || spec == "false")
+		return spec == "true" ? 1 : 0;
+	if(parseSpecNumber(spec, value))
+		return value;
+	return std::numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * Evaluate constraints
+ *
+ * @param which: Indices of the constraints to evaluate
+ */
+void BiogasSpecValiReader::
+evaluateConstraints(const std::vector<int>& which)
+{
+	for(int constraint : which)
+		this->constraintResults[constraint] = (*this->constraints)[constraint].evaluate(this->constraintValues);
+}
+
+/**
+ * Generate the validation message of all checks
+ *
+ * Combines the result of the checks of the single parameters
+ * (done by the last "validateSpecs()") with the current results of
+ * all constraints. Constraints on parameters which are not
+ * numerical are not reported, the type check already fails.
+ *
+ * @return Bool whether the specs are valid
+ */
+bool BiogasSpecValiReader::
+generateValidationMessage()
+{
+	this->validationMessage = this->fieldValidationMessage;
+	this->validationErrorParams = this->fieldErrorParams;
+	bool isValid = this->fieldsValid;
+	const std::vector<SpecConstraint>& constraints = *this->constraints;
+	for(std::size_t i=0; i<constraints.size(); i++)
+	{
+		if(this->constraintResults[i] != 0)
+			continue;
+		this->validationMessage += "Constraint ERROR: \"" + this->entries.leftCell(constraints[i].owner)
+			+ "\" violates " + constraints[i].expression + "\n";
+		this->validationErrorParams += std::to_string(constraints[i].owner) + "\n";
+		isValid = false;
+	}
+	return isValid;
+}
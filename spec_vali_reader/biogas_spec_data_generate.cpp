@@ -88,21 +88,37 @@ generateSpecs()
 
 	std::istringstream lineIter(this->input_specModified);
 	int index = 0;
-	for(std::string line; std::getline(lineIter, line); )
+	for(std::string line; index < this->number_of_entries && std::getline(lineIter, line); )
 	{
 		size_t valuePos = line.find("="); 
     	if (valuePos == std::string::npos)
 		{
 			if(std::regex_search(line, timestamp))
-				this->entries[index].specVal = line;
+				this->entries.setSpec(index, line);
 		}
 		else
-        	this->entries[index].specVal = line.substr(valuePos+1);
+        	this->entries.setSpec(index, line.substr(valuePos+1));
 		++index;
 	}
 
+	this->generateTimeTables();
+	this->generateSpecString();
+}
+
+/**
+ * Write the "specString" from the generated "entries"
+ */
+void BiogasSpecValiReader::
+generateSpecString()
+{
+	std::string::size_type size = 0;
+	for(int i=0; i<this->number_of_entries; i++)
+		size += this->entries.spec(i).size() + 1;
+
+	this->specString = "";
+	this->specString.reserve(size);
 	for(int i=0; i<this->number_of_entries; i++)
-		this->specString += entries[i].specVal + "\n";
+		this->specString += this->entries.spec(i) + "\n";
 }
 
 
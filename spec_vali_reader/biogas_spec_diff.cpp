@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include "spec_diff.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <fnmatch.h>
+
+/**
+ * Format differences as lines "path\tbefore\tafter"
+ *
+ * @param changes: The differences
+ * @param prefix: Prefix of every line
+ * @return The lines
+ */
+static std::string formatSpecChanges(const std::vector<SpecChange>& changes, const std::string& prefix)
+{
+	std::string result = "";
+	for(const SpecChange& change : changes)
+		result += prefix + change.path + "\t" + change.before + "\t" + change.after + "\n";
+	return result;
+}
+
+/**
+ * Compare two specification files
+ *
+ * The differences are stored in "specDiff", one line per changed
+ * parameter or row of a time table (see SpecDigest).
+ *
+ * @param filepathA: The absolute path to the first specification
+ * @param filepathB: The absolute path to the second specification
+ * @return Bool if both files could be parsed
+ */
+bool BiogasSpecValiReader::
+diffSpecFiles(std::string filepathA, std::string filepathB)
+{
+	this->specDiff = "";
+
+	SpecDigest a, b;
+	if(!a.load(filepathA) || !b.load(filepathB))
+		return false;
+
+	std::vector<SpecChange> changes;
+	a.diff(b, changes);
+	this->specDiff = formatSpecChanges(changes, "");
+	return true;
+}
+
+/**
+ * Load the specifications of all runs
+ *
+ * Searches all direct subdirectories of "runsDir" for a file matching
+ * the pattern (e.g. "problemSettings.lua" or "outputSpecification_*.lua",
+ * the first match in alphabetical order is taken) and keeps the
+ * digests of these files for diffSpecCatalog().
+ *
+ * @param runsDir: Directory holding the output directories of all runs
+ * @param pattern: Name of the specification in a run directory (wildcards allowed)
+ * @return Number of runs loaded
+ */
+int BiogasSpecValiReader::
+loadSpecCatalog(std::string runsDir, std::string pattern)
+{
+	std::vector<std::pair<std::string, SpecDigest>> catalog;
+	this->specCatalog = std::make_shared<const std::vector<std::pair<std::string, SpecDigest>>>();
+	if(!runsDir.empty() && runsDir.back() != '/')
+		runsDir += "/";
+
+	std::vector<std::string> runs;
+	DIR* dir = opendir(runsDir.c_str());
+	if(dir == nullptr)
+		return 0;
+	for(struct dirent* item = readdir(dir); item != nullptr; item = readdir(dir))
+	{
+		std::string name = item->d_name;
+		if(name != "." && name != "..")
+			runs.push_back(runsDir + name + "/");
+	}
+	closedir(dir);
+	std::sort(runs.begin(), runs.end());
+
+	for(const std::string& run : runs)
+	{
+		DIR* runDir = opendir(run.c_str());
+		if(runDir == nullptr)
+			continue;
+		std::vector<std::string> matches;
+		for(struct dirent* item = readdir(runDir); item != nullptr; item = readdir(runDir))
+			if(fnmatch(pattern.c_str(), item->d_name, 0) == 0)
+				matches.push_back(item->d_name);
+		closedir(runDir);
+		if(matches.empty())
+			continue;
+
+		std::sort(matches.begin(), matches.end());
+		SpecDigest digest;
+		if(digest.load(run + matches[0]))
+			catalog.push_back(std::make_pair(run, digest));
+	}
+	this->specCatalog = std::make_shared<const std::vector<std::pair<std::string, SpecDigest>>>(std::move(catalog));
+	return this->specCatalog->size();
+}
+
+/**
+ * Compare a specification with all runs of the catalog
+ *
+ * Has to be called after loadSpecCatalog(). For every run the
+ * "specDiff" holds a line "runDir\tnumberOfChanges" followed by
+ * the changes, each line starting with a tab.
+ *
+ * @param filepath: The absolute path to the specification
+ * @return Bool if the file could be parsed
+ */
+bool BiogasSpecValiReader::
+diffSpecCatalog(std::string filepath)
+{
+	this->specDiff = "";
+
+	SpecDigest digest;
+	if(!digest.load(filepath))
+		return false;
+
+	std::vector<SpecChange> changes;
+	for(const std::pair<std::string, SpecDigest>& run : *this->specCatalog)
+	{
+		changes.clear();
+		digest.diff(run.second, changes);
+		this->specDiff += run.first + "\t" + std::to_string(changes.size()) + "\n" + formatSpecChanges(changes, "\t");
+	}
+	return true;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include <string>
+#include <vector>
+#include <sstream>
+
+/**
+ * Start a new edit history with the current entries
+ *
+ * Called whenever the rows of "entries" are created anew (new
+ * validation file).
+ */
+void BiogasSpecValiReader::
+resetSpecHistory()
+{
+	this->historyEntries = std::make_shared<const TableEntries>(this->entries);
+	this->specHistory.reset(this->entries.specs());
+}
+
+/**
+ * Record the current specification values as new version
+ *
+ * Only the rows which differ from the current version are stored.
+ *
+ * @param label: Description of the edit
+ * @return The new version (the current one if nothing changed)
+ */
+int BiogasSpecValiReader::
+recordSpecs(std::string label)
+{
+	int version = this->specHistory.position();
+	if(version < 0 || this->specHistory.rows(version) != this->number_of_entries)
+	{
+		this->resetSpecHistory();
+		return this->specHistory.position();
+	}
+
+	std::vector<std::string> values;
+	std::vector<int> bases;
+	this->specHistory.flatten(version, values, bases);
+	std::vector<std::pair<int, std::string>> changes = {};
+	for(int i=0; i<this->number_of_entries; i++)
+		if(values[i] != this->entries.spec(i))
+			changes.push_back(std::make_pair(i, this->entries.spec(i)));
+
+	return this->specHistory.setValues(changes, label);
+}
+
+/**
+ * Load the current version of the history into "entries"
+ *
+ * If both versions have the same rows, only the rows which differ are
+ * changed and the strings depending on the values are regenerated.
+ * Otherwise (time tables with a different number of rows) the rows are
+ * rebuilt and all strings for LabView are regenerated.
+ *
+ * @param previous: The version "entries" holds
+ */
+void BiogasSpecValiReader::
+applySpecVersion(int previous)
+{
+	int version = this->specHistory.position();
+	std::vector<int> rows;
+	bool sameRows = this->specHistory.diff(previous, version, rows);
+	for(std::size_t i=0; i<rows.size() && sameRows; i++)
+	{
+		int from = this->specHistory.base(previous, rows[i]);
+		int to = this->specHistory.base(version, rows[i]);
+		sameRows = (from == to || this->historyEntries->sameRow(from, to));
+	}
+
+	if(sameRows)
+	{
+		bool tableChanged = false;
+		for(int row : rows)
+		{
+			this->entries.setSpec(row, this->specHistory.value(version, row));
+			if(this->entries.leftCell(row) == "timeTableContent")
+				tableChanged = true;
+		}
+		this->resetValidation();
+		if(tableChanged)
+			this->generateTimeTables();
+		this->generateSpecString();
+		return;
+	}
+
+	std::vector<std::string> values;
+	std::vector<int> bases;
+	this->specHistory.flatten(this->specHistory.position(), values, bases);
+
+	this->entries = *this->historyEntries;
+	this->entries.selectRows(bases);
+	this->entries.setSpecs(values);
+	this->number_of_entries = this->entries.size();
+
+	this->generateTimeTables();
+	this->reindexEntries();
+	this->generateTimeTableString();
+	this->generateValiString();
+	this->generateSpecString();
+}
+
+/**
+ * List all versions of the history
+ *
+ * Generated on demand, so an edit does not rebuild the list.
+ *
+ * @return See SpecHistory::toString()
+ */
+std::string BiogasSpecValiReader::
+specHistoryText() const
+{
+	return this->specHistory.toString();
+}
+
+/**
+ * Change the specification of one parameter
+ *
+ * The change is recorded as new version of the history.
+ *
+ * @param index: Index of the parameter
+ * @param spec: The new specification
+ * @return The new version or -1 for an invalid index
+ */
+int BiogasSpecValiReader::
+editSpec(int index, std::string spec)
+{
+	if(index < 0 || index >= this->number_of_entries || this->entries.glyph[index] != 0)
+		return -1;
+
+	int version = this->specHistory.setValues({std::make_pair(index, spec)},
+		this->entries.leftCell(index) + "=" + spec);
+	this->entries.setSpec(index, spec);
+	this->constraintValues = {};
+	if(this->entries.leftCell(index) == "timeTableContent")
+	{
+		this->generateTimeTables();
+		this->generateTimeTableString();
+	}
+	this->generateSpecString();
+	return version;
+}
+
+/**
+ * Change the specifications of all parameters
+ *
+ * Takes the specifications as edited in LabView (one line per entry,
+ * as "specString"). All changed lines are recorded as one version.
+ *
+ * @param specs: The specifications
+ * @return The new version (the current one if nothing changed) or -1
+ * if the number of lines does not match
+ */
+int BiogasSpecValiReader::
+commitSpecs(std::string specs)
+{
+	std::vector<std::string> values = {};
+	std::istringstream lineIter(specs);
+	for(std::string line; std::getline(lineIter, line); )
+		values.push_back(line);
+	if((int) values.size() != this->number_of_entries)
+		return -1;
+
+	int changed = 0;
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		if(values[i] != this->entries.spec(i))
+			++changed;
+	}
+	if(changed == 0)
+		return this->specHistory.position();
+
+	this->entries.setSpecs(values);
+	this->constraintValues = {};
+	this->generateTimeTables();
+	this->generateTimeTableString();
+	this->generateSpecString();
+	return this->recordSpecs(std::to_string(changed) + " changes");
+}
+
+/**
+ * Go back to the previous version
+ *
+ * @return The current version or -1 if there is nothing to undo
+ */
+int BiogasSpecValiReader::
+undoSpec()
+{
+	int previous = this->specHistory.position();
+	int version = this->specHistory.undo();
+	if(version >= 0)
+		this->applySpecVersion(previous);
+	return version;
+}
+
+/**
+ * Go forward to the last undone version
+ *
+ * @return The current version or -1 if there is nothing to redo
+ */
+int BiogasSpecValiReader::
+redoSpec()
+{
+	int previous = this->specHistory.position();
+	int version = this->specHistory.redo();
+	if(version >= 0)
+		this->applySpecVersion(previous);
+	return version;
+}
+
+/**
+ * Go to any version of the history
+ *
+ * @param version: The version (see "specHistoryText()")
+ * @return Bool if the version exists
+ */
+bool BiogasSpecValiReader::
+checkoutSpec(int version)
+{
+	int previous = this->specHistory.position();
+	if(!this->specHistory.checkout(version))
+		return false;
+	this->applySpecVersion(previous);
+	return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Index the children of all entries
+ *
+ * Has to be called after "generateIndents()". The children of an
+ * entry are the following entries with one indentation more, up to
+ * the next entry with the same or a smaller indentation.
+ */
+void BiogasSpecValiReader::
+generateChildren()
+{
+	std::vector<std::vector<int>> children(this->number_of_entries + 1);
+	std::vector<int> parents = {-1};
+	std::vector<int> indents = {-1};
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		int indent = this->entries.indent[i];
+		while(indents.size() > 1 && indent <= indents.back())
+		{
+			parents.pop_back();
+			indents.pop_back();
+		}
+		children[parents.back()+1].push_back(i);
+		parents.push_back(i);
+		indents.push_back(indent);
+	}
+	this->entryChildren = std::make_shared<const std::vector<std::vector<int>>>(std::move(children));
+}
+
+/**
+ * Number of children of an entry
+ *
+ * @param index: Index of the entry (-1 for the top level)
+ * @return Number of children or -1 for an invalid index
+ */
+int BiogasSpecValiReader::
+childCount(int index) const
+{
+	if(index < -1 || index+1 >= (int) this->entryChildren->size())
+		return -1;
+	return (int) (*this->entryChildren)[index+1].size();
+}
+
+/**
+ * Write the children of an entry
+ *
+ * One line per child with the tab separated columns: index of the
+ * entry, number of its children, indentation, glyph, LeftCell, type,
+ * default value and value of the specification. Only the requested
+ * part is written, so a folder with a long time table can be shown
+ * page by page.
+ *
+ * @param index: Index of the entry (-1 for the top level)
+ * @param first: Position of the first child
+ * @param maxChildren: Maximal number of children (-1 for all)
+ * @param childrenString: The children (one line each)
+ * @return Number of written children or -1 for an invalid index
+ */
+int BiogasSpecValiReader::
+generateChildrenString(int index, int first, int maxChildren, std::string& childrenString) const
+{
+	childrenString = "";
+	int count = this->childCount(index);
+	if(count < 0)
+		return -1;
+
+	const std::vector<int>& children = (*this->entryChildren)[index+1];
+	int begin = std::max(0, std::min(first, count));
+	int end = (maxChildren < 0) ? count : std::min(count, begin + maxChildren);
+	for(int c=begin; c<end; c++)
+	{
+		int child = children[c];
+		childrenString += std::to_string(child) + "\t" +
+			std::to_string((*this->entryChildren)[child+1].size()) + "\t" +
+			std::to_string(this->entries.indent[child]) + "\t" +
+			std::to_string(this->entries.glyph[child]) + "\t" +
+			this->entries.leftCell(child) + "\t" +
+			this->entries.type(child) + "\t" +
+			this->entries.defaultVal(child) + "\t" +
+			this->entries.spec(child) + "\n";
+	}
+	return end - begin;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include "spec_tree.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <algorithm>
+#include <sys/stat.h>
+
+static const std::string sweepStartTime = "problem.numericalSetup.sim_starttime";
+static const std::string sweepEndTime = "problem.numericalSetup.sim_endtime";
+
+/**
+ * Whether a parameter does not influence the simulated process
+ *
+ * @param path: Path of the parameter
+ * @return Bool if the parameter may differ within the common prefix
+ */
+static bool isSweepNeutral(const std::string& path)
+{
+	return path == sweepEndTime
+		|| path.compare(0, 19, "problem.checkpoint.") == 0
+		|| path.compare(0, 20, "problem.outputSpecs.") == 0;
+}
+
+/**
+ * Time at which two time tables start to differ
+ *
+ * @param a: First time table
+ * @param b: Second time table
+ * @param endTime: Result if the tables are equal
+ * @return Time of the first row which differs
+ */
+static double timeTableDivergence(const SpecNode& a, const SpecNode& b, double endTime)
+{
+	std::size_t rows = std::min(a.children.size(), b.children.size());
+	double ta, tb;
+	for(std::size_t i=0; i<rows; i++)
+	{
+		if(a.children[i].normalizedValue() == b.children[i].normalizedValue())
+			continue;
+		parseSpecNumber(a.children[i].children[0].value, ta);
+		parseSpecNumber(b.children[i].children[0].value, tb);
+		return std::min(ta, tb);
+	}
+	if(a.children.size() > rows && parseSpecNumber(a.children[rows].children[0].value, ta))
+		return ta;
+	if(b.children.size() > rows && parseSpecNumber(b.children[rows].children[0].value, tb))
+		return tb;
+	return endTime;
+}
+
+/**
+ * Write a specification into a new directory
+ *
+ * @param tree: The specification
+ * @param dir: The directory (created if needed)
+ * @return The path to the specification or "" if it could not be written
+ */
+static std::string writeSweepSpec(const SpecTree& tree, const std::string& dir)
+{
+	mkdir(dir.c_str(), 0755);
+	std::string path = dir + "spec.lua";
+	std::ofstream file(path);
+	if(!file.good())
+		return "";
+	file << tree.write();
+	return file.good() ? path : "";
+}
+
+/**
+ * Plan a parameter sweep with a common warm-up
+ *
+ * Finds the time up to which all variants simulate the same process:
+ * all parameters have to be equal (except the end time, output and
+ * checkpoint settings) and the time tables are equal up to the first
+ * differing row. This common prefix is simulated once by a warm-up run
+ * which writes the checkpoint at its end. Every variant restarts from
+ * this checkpoint.
+ *
+ * Writes the specification of the warm-up to "<sweepDir>/warmup/spec.lua"
+ * and the specifications of the variants to "<sweepDir>/variant_<i>/spec.lua".
+ * The warm-up has to run in its directory, so the variants find the
+ * checkpoint in "checkpointDir".
+ *
+ * The plan is stored in "sweepPlan" with one line per run:
+ *
+ * Col1: Name of the run (warmup, variant_1, ...)
+ * Col2: Path to the specification
+ * Col3: Start time
+ * Col4: End time
+ *
+ * @param specFiles: The absolute paths to the specification files of all variants
+ * @param sweepDir: Directory for the generated specifications
+ * @return Bool if the variants have a common prefix
+ */
+bool BiogasSpecValiReader::
+planSweep(std::vector<std::string> specFiles, std::string sweepDir)
+{
+	this->sweepPlan = "";
+	if(specFiles.empty())
+		return false;
+	if(!sweepDir.empty() && sweepDir.back() != '/')
+		sweepDir += "/";
+
+	std::vector<SpecTree> variants(specFiles.size());
+	std::vector<std::map<std::string, const SpecNode*>> leaves(specFiles.size());
+	std::set<std::string> paths;
+	std::string input;
+	for(std::size_t i=0; i<specFiles.size(); i++)
+	{
+		if(!readSpecFile(specFiles[i], input) || !variants[i].parse(input))
+			return false;
+		variants[i].collectLeaves(leaves[i]);
+		for(const std::pair<const std::string, const SpecNode*>& leaf : leaves[i])
+			paths.insert(leaf.first);
+	}
+
+	const SpecNode* startNode = variants[0].find(sweepStartTime);
+	double startTime = 0;
+	if(startNode != nullptr && !parseSpecNumber(startNode->value, startTime))
+		return false;
+
+	double divergence = -1;
+	for(std::size_t i=0; i<variants.size(); i++)
+	{
+		const SpecNode* endNode = variants[i].find(sweepEndTime);
+		double endTime;
+		if(endNode == nullptr || !parseSpecNumber(endNode->value, endTime))
+			return false;
+		divergence = (divergence < 0) ? endTime : std::min(divergence, endTime);
+	}
+
+	for(const std::string& path : paths)
+	{
+		if(isSweepNeutral(path))
+			continue;
+
+		for(std::size_t i=1; i<variants.size() && divergence > startTime; i++)
+		{
+			std::map<std::string, const SpecNode*>::const_iterator first = leaves[0].find(path);
+			std::map<std::string, const SpecNode*>::const_iterator other = leaves[i].find(path);
+			if(first == leaves[0].end() || other == leaves[i].end())
+				divergence = startTime;
+			else if(first->second->isTimeTable() && other->second->isTimeTable())
+				divergence = std::min(divergence, timeTableDivergence(*first->second, *other->second, divergence));
+			else if(first->second->normalizedValue() != other->second->normalizedValue())
+				divergence = startTime;
+		}
+	}
+	if(divergence <= startTime)
+		return false;
+
+	std::string restartTime = formatSpecNumber(divergence);
+	std::string warmupDir = sweepDir + "warmup/";
+	mkdir(sweepDir.c_str(), 0755);
+
+	SpecTree warmup = variants[0];
+	for(const std::pair<const std::string, const SpecNode*>& leaf : leaves[0])
+	{
+		if(!leaf.second->isTimeTable())
+			continue;
+		SpecNode& table = warmup.insert(leaf.first);
+		double t;
+		table.children.erase(std::remove_if(table.children.begin(), table.children.end(),
+			[divergence, &t](const SpecNode& row)
+			{
+				return !parseSpecNumber(row.children[0].value, t) || t >= divergence;
+			}), table.children.end());
+	}
+	warmup.insert(sweepEndTime).value = restartTime;
+	warmup.insert("problem.checkpoint.doReadCheckpoint").value = "false";
+
+	std::string warmupSpec = writeSweepSpec(warmup, warmupDir);
+	if(warmupSpec.empty())
+		return false;
+	this->sweepPlan = "warmup " + warmupSpec + " " + formatSpecNumber(startTime) + " " + restartTime + "\n";
+
+	for(std::size_t i=0; i<variants.size(); i++)
+	{
+		std::string name = "variant_" + std::to_string(i+1);
+		variants[i].insert(sweepStartTime).value = restartTime;
+		variants[i].insert("problem.checkpoint.doReadCheckpoint").value = "true";
+		variants[i].insert("problem.checkpoint.checkpointDir").value = "\"" + warmupDir + "\"";
+
+		std::string variantSpec = writeSweepSpec(variants[i], sweepDir + name + "/");
+		if(variantSpec.empty())
+			return false;
+		this->sweepPlan += name + " " + variantSpec + " " + restartTime + " " +
+			variants[i].find(sweepEndTime)->normalizedValue() + "\n";
+	}
+	this->sweepPlan.resize(this->sweepPlan.size() - 1);
+	return true;
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "biogas_spec_vali_reader.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+/**
+ * Generate all time tables
+ *
+ * Every folder whose children are "timeTableContent" rows is a
+ * time table. The rows are parsed into the numerical columns of
+ * a "TimeTable". Rows without a valid "{t,v}" value (e.g. before
+ * a specification was loaded) are stored as NaN.
+ */
+void BiogasSpecValiReader::
+generateTimeTables()
+{
+	this->timeTables = {};
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	for(int i=0; i<this->number_of_entries-1; i++)
+	{
+		if(this->entries.glyph[i] != 15 || this->entries.leftCell(i+1) != "timeTableContent")
+			continue;
+
+		TimeTable table;
+		table.entryIndex = i;
+		table.firstRow = i+1;
+		int row = i+1;
+		while(row < this->number_of_entries && this->entries.leftCell(row) == "timeTableContent")
+		{
+			double t, v;
+			if(!parseSpecTimeStamp(this->entries.spec(row), t, v))
+			{
+				t = nan;
+				v = nan;
+			}
+			table.time.push_back(t);
+			table.value.push_back(v);
+			++row;
+		}
+		this->timeTables.push_back(std::make_shared<TimeTable>(table));
+		i = row-1;
+	}
+
+	this->generateTimeTableString();
+}
+
+/**
+ * Write the "timeTableString" from the generated "timeTables"
+ *
+ * Col1: Index of the time table folder
+ * Col2: Number of rows
+ * Col3: LeftCell of the time table folder
+ */
+void BiogasSpecValiReader::
+generateTimeTableString()
+{
+	this->timeTableString = "";
+	for(const std::shared_ptr<TimeTable>& table : this->timeTables)
+	{
+		this->timeTableString += std::to_string(table->entryIndex) + " " +
+			std::to_string(table->size()) + " " +
+			this->entries.leftCell(table->entryIndex) + "\n";
+	}
+	if(!this->timeTableString.empty())
+		this->timeTableString.resize(this->timeTableString.size() - 1);
+}
+
+/**
+ * Find a time table by the index of its folder
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @return Position in "timeTables" or -1 if there is no such table
+ */
+int BiogasSpecValiReader::
+findTimeTable(int entryIndex) const
+{
+	for(int i=0; i<(int) this->timeTables.size(); i++)
+		if(this->timeTables[i]->entryIndex == entryIndex)
+			return i;
+	return -1;
+}
+
+/**
+ * A time table of this copy alone (copied if it is shared)
+ *
+ * Copies of the reader share their time tables, only the changed
+ * tables are copied.
+ *
+ * @param table: The time table in "timeTables"
+ * @return The time table
+ */
+TimeTable& BiogasSpecValiReader::
+ownTimeTable(std::shared_ptr<TimeTable>& table)
+{
+	if(table.use_count() > 1)
+		table = std::make_shared<TimeTable>(*table);
+	return *table;
+}
+
+/**
+ * Getter method for a time table
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @return The time table or nullptr if there is no such table
+ */
+const TimeTable* BiogasSpecValiReader::
+getTimeTable(int entryIndex) const
+{
+	int pos = this->findTimeTable(entryIndex);
+	if(pos < 0)
+		return nullptr;
+	return this->timeTables[pos].get();
+}
+
+/**
+ * Write a time table back into the specification
+ *
+ * The numerical columns are the master copy. If the number of rows
+ * changed, "timeTableContent" rows are inserted or removed from the
+ * "entries" so the LabView tree matches the table, and everything
+ * indexed by the entries is rebuilt (see reindexEntries()). The change
+ * is recorded in the "specHistory". Afterwards all strings for LabView
+ * are regenerated.
+ *
+ * @param pos: Position of the table in "timeTables"
+ */
+void BiogasSpecValiReader::
+writeTimeTable(int pos)
+{
+	const TimeTable& table = *this->timeTables[pos];
+	int oldRows = 0;
+	while(table.firstRow+oldRows < this->number_of_entries
+			&& this->entries.leftCell(table.firstRow+oldRows) == "timeTableContent")
+		++oldRows;
+
+	int diff = table.size() - oldRows;
+	if(diff > 0)
+	{
+		this->entries.insertRows(table.firstRow+oldRows, diff, table.firstRow);
+	}
+	else if(diff < 0)
+	{
+		this->entries.eraseRows(table.firstRow+table.size(), table.firstRow+oldRows);
+	}
+	this->number_of_entries = this->entries.size();
+
+	for(int i=pos+1; i<(int) this->timeTables.size() && diff != 0; i++)
+	{
+		TimeTable& next = ownTimeTable(this->timeTables[i]);
+		next.entryIndex += diff;
+		next.firstRow += diff;
+	}
+
+	for(int i=0; i<table.size(); i++)
+	{
+		this->entries.setSpec(table.firstRow+i, "{" + formatSpecNumber(table.time[i]) + ","
+			+ formatSpecNumber(table.value[i]) + "}");
+	}
+
+	std::vector<std::string> rows(this->entries.specs().begin()+table.firstRow,
+		this->entries.specs().begin()+table.firstRow+table.size());
+	this->specHistory.replaceRows(table.firstRow, oldRows, rows, this->entries.leftCell(table.entryIndex));
+
+	this->reindexEntries();
+	this->generateTimeTableString();
+	this->generateValiString();
+	this->generateSpecString();
+}
+
+/**
+ * Replace a time table with new columns
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @param time: Array of times
+ * @param value: Array of values
+ * @param rows: Number of rows (at least one)
+ * @return Bool if the table exists and all times and values are finite
+ */
+bool BiogasSpecValiReader::
+setTimeTable(int entryIndex, const double* time, const double* value, int rows)
+{
+	int pos = this->findTimeTable(entryIndex);
+	if(pos < 0 || rows < 1 || time == nullptr || value == nullptr)
+		return false;
+	for(int i=0; i<rows; i++)
+		if(!std::isfinite(time[i]) || !std::isfinite(value[i]))
+			return false;
+
+	TimeTable& table = ownTimeTable(this->timeTables[pos]);
+	table.time.assign(time, time+rows);
+	table.value.assign(value, value+rows);
+	this->writeTimeTable(pos);
+	return true;
+}
+
+/**
+ * Import a time table from a CSV file
+ *
+ * Each line holds a time and a value, delimited by ',', ';',
+ * tabs or whitespaces, optionally followed by a comment ('#').
+ * Empty lines, lines starting with '#' and one header line before
+ * the first row are skipped. Any other line, and times or values
+ * which are not finite, make the import fail.
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @param filepath: The absolute path to the CSV file
+ * @return Bool if the file could be read and all rows are valid
+ */
+bool BiogasSpecValiReader::
+importTimeTableCSV(int entryIndex, std::string filepath)
+{
+	int pos = this->findTimeTable(entryIndex);
+	if(pos < 0)
+		return false;
+
+	std::ifstream CSVFile(filepath);
+	if(!CSVFile.good())
+		return false;
+	std::stringstream buffer;
+	buffer << CSVFile.rdbuf();
+	std::string content = buffer.str();
+
+	std::vector<double> time;
+	std::vector<double> value;
+	time.reserve(content.size()/8);
+	value.reserve(content.size()/8);
+
+	bool header = false;
+	const char* pos_c = content.c_str();
+	const char* end = pos_c + content.size();
+	while(pos_c < end)
+	{
+		const char* lineEnd = pos_c;
+		while(lineEnd < end && *lineEnd != '\n')
+			++lineEnd;
+
+		const char* c = pos_c;
+		while(c < lineEnd && isspace(*c))
+			++c;
+		if(c < lineEnd && *c != '#')
+		{
+			char* next;
+			double t = std::strtod(c, &next);
+			bool valid = (next != c);
+			double v = 0.0;
+			if(valid)
+			{
+				c = next;
+				while(c < lineEnd && (isspace(*c) || *c == ',' || *c == ';'))
+					++c;
+				v = std::strtod(c, &next);
+				valid = (next != c && next <= lineEnd);
+			}
+			if(valid)
+			{
+				c = next;
+				while(c < lineEnd && isspace(*c))
+					++c;
+				valid = (c == lineEnd || *c == '#');
+			}
+
+			if(valid)
+			{
+				if(!std::isfinite(t) || !std::isfinite(v))
+					return false;
+				time.push_back(t);
+				value.push_back(v);
+			}
+			else if(time.empty() && !header)
+				header = true;
+			else
+				return false;
+		}
+		pos_c = lineEnd+1;
+	}
+
+	if(time.empty())
+		return false;
+
+	TimeTable& table = ownTimeTable(this->timeTables[pos]);
+	table.time = std::move(time);
+	table.value = std::move(value);
+	this->writeTimeTable(pos);
+	return true;
+}
+
+/**
+ * Export a time table into a CSV file
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @param filepath: The absolute path to the CSV file
+ * @return Bool if the file could be written
+ */
+bool BiogasSpecValiReader::
+exportTimeTableCSV(int entryIndex, std::string filepath) const
+{
+	const TimeTable* table = this->getTimeTable(entryIndex);
+	if(table == nullptr)
+		return false;
+
+	std::string content = "# " + this->entries.leftCell(entryIndex) + "\n";
+	content.reserve(content.size() + 32*table->size());
+	for(int i=0; i<table->size(); i++)
+		content += formatSpecNumber(table->time[i]) + "," + formatSpecNumber(table->value[i]) + "\n";
+
+	std::ofstream CSVFile(filepath);
+	if(!CSVFile.good())
+		return false;
+	CSVFile << content;
+	return CSVFile.good();
+}
+
+/**
+ * Check a time table
+ *
+ * All rows are checked at once: every time and value has to be a
+ * valid number, integers for tables of type "Integer", the values
+ * have to suit the range of the time table folder and the times
+ * have to be strictly increasing. Only if a check fails, the rows
+ * are scanned again to generate the "validationMessage".
+ *
+ * @param table: The time table to check
+ * @return Bool whether the time table is valid
+ */
+bool BiogasSpecValiReader::
+checkTimeTable(const TimeTable& table)
+{
+	const int folder = table.entryIndex;
+	const std::string& type = this->entries.type(table.firstRow);
+	const double* t = table.time.data();
+	const double* v = table.value.data();
+	const int n = table.size();
+
+	bool hasRange = this->entries.hasRange(folder);
+	double rangeMin = hasRange ? this->entries.rangeMin[folder] : -std::numeric_limits<double>::infinity();
+	double rangeMax = hasRange ? this->entries.rangeMax[folder] : std::numeric_limits<double>::infinity();
+	bool isInteger = (type == "Integer");
+
+	bool typeOk = true;
+	bool rangeOk = true;
+	bool orderOk = true;
+	for(int i=0; i<n; i++)
+	{
+		typeOk &= (t[i] == t[i]) & (v[i] == v[i]);
+		rangeOk &= (v[i] >= rangeMin) & (v[i] <= rangeMax);
+	}
+	if(isInteger)
+		for(int i=0; i<n; i++)
+			typeOk &= (t[i] == std::floor(t[i])) & (v[i] == std::floor(v[i]));
+	for(int i=1; i<n; i++)
+		orderOk &= (t[i] > t[i-1]);
+
+	if(typeOk && rangeOk && orderOk)
+		return true;
+
+	for(int i=0; i<n; i++)
+	{
+		bool rowTypeOk = (t[i] == t[i]) && (v[i] == v[i])
+			&& (!isInteger || (t[i] == std::floor(t[i]) && v[i] == std::floor(v[i])));
+		if(!rowTypeOk)
+		{
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(folder) + "\" row " + std::to_string(i+1)
+				+ " should be of type " + type + "\n";
+			this->validationErrorParams += std::to_string(table.firstRow+i) + "\n";
+		}
+		else if(hasRange && (v[i] < rangeMin || v[i] > rangeMax))
+		{
+			this->validationMessage += "Range ERROR: " + this->entries.leftCell(folder) + " row " + std::to_string(i+1)
+				+ " should be in Range {" + TableEntries::rangeText(rangeMin) + "," + TableEntries::rangeText(rangeMax) + "}\n";
+			this->validationErrorParams += std::to_string(table.firstRow+i) + "\n";
+		}
+		else if(i > 0 && !(t[i] > t[i-1]))
+		{
+			this->validationMessage += "Order ERROR: " + this->entries.leftCell(folder) + " row " + std::to_string(i+1)
+				+ " should have a larger time than the previous row\n";
+			this->validationErrorParams += std::to_string(table.firstRow+i) + "\n";
+		}
+	}
+	return false;
+}
+
+/**
+ * Validate a single time table
+ *
+ * Checks the numerical columns of the time table and generates
+ * a new "validationMessage" and "validationErrorParams".
+ *
+ * @param entryIndex: Index of the time table folder in "entries"
+ * @return Bool whether the time table is valid
+ */
+bool BiogasSpecValiReader::
+validateTimeTable(int entryIndex)
+{
+	this->validationMessage = "";
+	this->validationErrorParams = "";
+
+	const TimeTable* table = this->getTimeTable(entryIndex);
+	if(table == nullptr)
+		return false;
+
+	return this->checkTimeTable(*table);
+}
@@ -10,6 +10,7 @@
  */
 
 #include "biogas_spec_vali_reader.h"
+#include "spec_tree.h"
 #include <string>
 #include <vector>
 #include <fstream>	
@@ -18,25 +19,54 @@
 
 #include "biogas_vali_data_generate.cpp"
 #include "biogas_spec_data_generate.cpp"
+#include "biogas_spec_timetable.cpp"
+#include "spec_tree.cpp"
+#include "biogas_spec_canonical.cpp"
+#include "biogas_spec_sweep.cpp"
+#include "spec_constraint.cpp"
+#include "biogas_spec_constraints.cpp"
+#include "spec_diff.cpp"
+#include "biogas_spec_diff.cpp"
+#include "biogas_spec_subtree.cpp"
+#include "spec_history.cpp"
+#include "biogas_spec_history.cpp"
 
 /**
  * Initialize validation input
  *
  * Main method for validation files. Loads the
  * file and calls all methods to read in the data.
+ * The input is released afterwards (see releaseInput()).
  *
+ * @param control: Optional progress report and cancellation
  * @return Bool if file could be read
  */
 bool BiogasSpecValiReader::
-init_Vali(const char* filepath_vali)
+init_Vali(const char* filepath_vali, TaskControl* control)
 {
+	if(!taskStep(control, 0))
+		return false;
+
 	if(this->readInput((std::string) filepath_vali))
 	{
+		if(!taskStep(control, 20) || !this->extractConstraints())
+			return false;
 		this->transformValiInput();
+		if(!taskStep(control, 50))
+			return false;
 		this->generateIndents();
 		this->generateGlyphs();
+		this->generateChildren();
+		if(!taskStep(control, 60))
+			return false;
 		this->generateValues();
-		return true;
+		if(!taskStep(control, 90))
+			return false;
+		this->generateTimeTables();
+		this->resetSpecHistory();
+		this->releaseInput();
+		this->resetValidation();
+		return this->compileConstraints();
 	}
 	
 	return false;
@@ -47,20 +77,145 @@ init_Vali(const char* filepath_vali)
  *
  * Main method for specification files. Loads the
  * file and calls all methods to read in the data.
+ * The input is released afterwards (see releaseInput()).
  *
+ * @param control: Optional progress report and cancellation
  * @return Bool if file could be read
  */
 bool BiogasSpecValiReader::
-init_Spec(const char* filepath_spec)
+init_Spec(const char* filepath_spec, TaskControl* control)
 {
-	if(this->readInput((std::string) filepath_spec))
-	{
-		this->transformSpecInput();
-		this->generateSpecs();
-		return true;
-	}
+	if(!this->parse_Spec(filepath_spec, control))
+		return false;
+	this->applySpecInput((std::string) filepath_spec);
+	return true;
+}
 
-	return false;
+/**
+ * Load and transform a specification file without applying it
+ *
+ * The parsed file can be applied to another reader with adoptSpec(),
+ * so the file can be parsed on a worker thread.
+ *
+ * @param control: Optional progress report and cancellation
+ * @return Bool if file could be read
+ */
+bool BiogasSpecValiReader::
+parse_Spec(const char* filepath_spec, TaskControl* control)
+{
+	if(!taskStep(control, 0) || !this->readInput((std::string) filepath_spec))
+		return false;
+	if(!taskStep(control, 20))
+		return false;
+	this->transformSpecInput();
+	return taskStep(control, 60);
+}
+
+/**
+ * Apply a specification file parsed by another reader
+ *
+ * Only the specifications are taken over, edits made since the file
+ * was parsed stay in the history.
+ *
+ * @param parsed: Reader which parsed the file with parse_Spec()
+ * @param filepath_spec: Path of the file (label of the new version)
+ */
+void BiogasSpecValiReader::
+adoptSpec(const BiogasSpecValiReader& parsed, std::string filepath_spec)
+{
+	this->input_specModified = parsed.input_specModified;
+	this->applySpecInput(filepath_spec);
+}
+
+/**
+ * Take over a validation file loaded by another reader
+ *
+ * Only the data defined by the validation file are taken over, the
+ * results of other calls (e.g. "batchReport", "specDiff") stay.
+ *
+ * @param loaded: Reader which loaded the file with init_Vali()
+ */
+void BiogasSpecValiReader::
+adoptVali(const BiogasSpecValiReader& loaded)
+{
+	this->number_of_entries = loaded.number_of_entries;
+	this->valiString = loaded.valiString;
+	this->specString = loaded.specString;
+	this->timeTableString = loaded.timeTableString;
+	this->entries = loaded.entries;
+	this->timeTables = loaded.timeTables;
+	this->constraintSources = loaded.constraintSources;
+	this->constraints = loaded.constraints;
+	this->constraintsByEntry = loaded.constraintsByEntry;
+	this->constraintValues = loaded.constraintValues;
+	this->constraintResults = loaded.constraintResults;
+	this->fieldValidationMessage = loaded.fieldValidationMessage;
+	this->fieldErrorParams = loaded.fieldErrorParams;
+	this->fieldsValid = loaded.fieldsValid;
+	this->validatedTables = loaded.validatedTables;
+	this->entryChildren = loaded.entryChildren;
+	this->specHistory = loaded.specHistory;
+	this->historyEntries = loaded.historyEntries;
+}
+
+/**
+ * Apply the transformed specification input to the entries
+ *
+ * @param filepath_spec: Path of the file (label of the new version)
+ */
+void BiogasSpecValiReader::
+applySpecInput(std::string filepath_spec)
+{
+	this->generateSpecs();
+	this->releaseInput();
+	this->resetValidation();
+	this->recordSpecs("loaded " + filepath_spec);
+}
+
+/**
+ * Release the input files once they are parsed
+ *
+ * Every edit in LabView publishes a copy of the reader (see
+ * VersionedStore), so it should not carry the files along.
+ */
+void BiogasSpecValiReader::
+releaseInput()
+{
+	this->input = "";
+	this->input_valiModified = "";
+	this->input_specModified = "";
+}
+
+/**
+ * Regenerate all data indexed by the position of the entries
+ *
+ * Has to be called whenever rows are inserted into or removed from
+ * the "entries" (time tables with a different number of rows). The
+ * constraints are compiled again for the new rows and the results of
+ * the last "validateSpecs()" are dropped, they refer to the old rows.
+ */
+void BiogasSpecValiReader::
+reindexEntries()
+{
+	this->generateChildren();
+	this->compileConstraints();
+	this->resetValidation();
+}
+
+/**
+ * Drop the results of the last "validateSpecs()"
+ *
+ * Called whenever the specifications are replaced as a whole, the
+ * next "validateSpecEdit()" starts from the current entries again.
+ */
+void BiogasSpecValiReader::
+resetValidation()
+{
+	this->constraintValues = {};
+	this->fieldValidationMessage = "";
+	this->fieldErrorParams = "";
+	this->fieldsValid = true;
+	this->validatedTables = {};
 }
 
 /**
@@ -73,32 +228,5 @@ init_Spec(const char* filepath_spec)
 bool BiogasSpecValiReader::
 readInput(std::string filepath)
 {
-	this->input = "";
-
-	std::ifstream LUATable(filepath);
-	if(!LUATable.good())
-	{
-		return false;
-	}
-
-	for(std::string line; getline(LUATable,line);)
-	{
-		line.erase(remove_if(line.begin(), line.end(), isspace), line.end());
-		std::string prefix("--");
-		if (line.compare(0, prefix.size(), prefix))
-		{
-			if(!line.empty())
-			{
-				if (line.find("--") != std::string::npos)
-				{
-					this->input += line.substr(0, line.find("--"));
-				}
-				else
-				{
-					this->input += line;
-				}		
-			}
-		}	
-	}
-	return true;
+	return readSpecFile(filepath, this->input);
 }
@@ -11,8 +11,15 @@
 
 #pragma once 
 #include "table_entry.h"
+#include "time_table.h"
+#include "spec_constraint.h"
+#include "spec_diff.h"
+#include "spec_history.h"
+#include "../common/task_control.h"
+#include "../common/result_buffer.h"
 #include <string>
 #include <vector>
+#include <memory>
 
 /**
  * Class to save all Data from a specification and validation file
@@ -25,13 +32,35 @@
  * @param validationErrorParams: All names of parameters where the validation failed
  * @param validationMessage: Message to display in LabView
  * @param outputSpecs: String to write into specification file (after editing in LabView)
+ * @param timeTableString: All time tables of the specification (CSV-style string)
+ * @param canonicalSpec: Normalized form of a specification (see canonicalizeSpec())
+ * @param specHash: Hash of the "canonicalSpec"
+ * @param sweepPlan: Runs of a planned parameter sweep (see planSweep())
+ * @param specDiff: Differences of specifications (see diffSpecFiles() and diffSpecCatalog())
+ * @param batchReport: Results of many specification files (see validateSpecBatch())
  *
- * Following parameters are internal:
+ * Following parameters are internal. The data which only changes when
+ * a file is loaded is shared between copies of the reader, so the
+ * copy published for every edit (see VersionedStore) stays small:
  *
- * @param input: Input specification/validation file
+ * @param input: Input specification/validation file (only while it is parsed)
  * @param input_valiModified: Modified validation input for easier parsing
  * @param input_specModified: Modified specification input for easier parsing
  * @param entries: Internal container for all vali/spec data
+ * @param timeTables: Internal container for all time tables (numerical columns, shared until a table is changed)
+ * @param constraintSources: Path of the parameter and expression of all constraints in the validation file
+ * @param constraints: The compiled constraints
+ * @param constraintsByEntry: Indices of the constraints depending on a parameter
+ * @param constraintValues: Numerical values of the last validated specifications
+ * @param constraintResults: Results of the constraints (see SpecConstraint::evaluate())
+ * @param fieldValidationMessage: Messages of the checks of single parameters
+ * @param fieldErrorParams: Failed parameters of the checks of single parameters
+ * @param fieldsValid: Whether the checks of single parameters succeeded
+ * @param validatedTables: The time tables as checked last (see validateSpecEdit())
+ * @param specCatalog: Run directories and digests of their specifications (see loadSpecCatalog())
+ * @param entryChildren: Indices of the children of all entries (first: top level, then by entry index)
+ * @param specHistory: Edit history of the specification values
+ * @param historyEntries: The entries the history started with (rows of all versions are copies of them)
  */
 class BiogasSpecValiReader { 
 	public:
@@ -42,27 +71,101 @@ class BiogasSpecValiReader {
 		std::string validationErrorParams;
 		std::string validationMessage;
 		std::string outputSpecs;
+		std::string timeTableString;
+		std::string canonicalSpec;
+		std::string specHash;
+		std::string sweepPlan;
+		std::string specDiff;
+		std::string batchReport;
 
 	private:
 		std::string input;
 		std::string input_valiModified;
 		std::string input_specModified;
 
-		std::vector<TableEntry> entries;
+		TableEntries entries;
+		std::vector<std::shared_ptr<TimeTable>> timeTables;
+
+		std::vector<std::pair<std::string, std::string>> constraintSources;
+		std::shared_ptr<const std::vector<SpecConstraint>> constraints = std::make_shared<const std::vector<SpecConstraint>>();
+		std::shared_ptr<const std::vector<std::vector<int>>> constraintsByEntry = std::make_shared<const std::vector<std::vector<int>>>();
+		std::vector<double> constraintValues;
+		std::vector<int> constraintResults;
+		std::string fieldValidationMessage;
+		std::string fieldErrorParams;
+		bool fieldsValid = true;
+		std::vector<std::shared_ptr<TimeTable>> validatedTables;
+
+		std::shared_ptr<const std::vector<std::pair<std::string, SpecDigest>>> specCatalog = std::make_shared<const std::vector<std::pair<std::string, SpecDigest>>>();
+		std::shared_ptr<const std::vector<std::vector<int>>> entryChildren = std::make_shared<const std::vector<std::vector<int>>>();
+		SpecHistory specHistory;
+		std::shared_ptr<const TableEntries> historyEntries = std::make_shared<const TableEntries>();
 
 	public:
 		BiogasSpecValiReader(){};	
-		bool init_Vali(const char* filepath_vali);
-		bool init_Spec(const char* filepath_spec);
+		bool init_Vali(const char* filepath_vali, TaskControl* control = nullptr);
+		bool init_Spec(const char* filepath_spec, TaskControl* control = nullptr);
+		bool parse_Spec(const char* filepath_spec, TaskControl* control = nullptr);
+		void adoptSpec(const BiogasSpecValiReader&, std::string);
+		void adoptVali(const BiogasSpecValiReader&);
 		bool validateSpecs(std::string);
+		bool validateSpecEdit(int, std::string);
 		bool writeOutputSpecs(std::string);
+		const TimeTable* getTimeTable(int) const;
+		bool setTimeTable(int, const double*, const double*, int);
+		bool importTimeTableCSV(int, std::string);
+		bool exportTimeTableCSV(int, std::string) const;
+		bool validateTimeTable(int);
+		BiogasResultBuffer* createValiBuffer() const;
+		std::vector<std::string> entryPaths() const;
+		bool canonicalizeSpec(std::string);
+		bool writeSpecHash(std::string) const;
+		std::string findRunBySpecHash(std::string) const;
+		bool planSweep(std::vector<std::string>, std::string);
+		bool diffSpecFiles(std::string, std::string);
+		int loadSpecCatalog(std::string, std::string);
+		bool diffSpecCatalog(std::string);
+		int childCount(int) const;
+		int generateChildrenString(int, int, int, std::string&) const;
+		bool validateSpecBatch(const std::vector<std::string>&, std::string, TaskControl* control = nullptr);
+		int editSpec(int, std::string);
+		int commitSpecs(std::string);
+		int undoSpec();
+		int redoSpec();
+		bool checkoutSpec(int);
+		bool exportSpecVersion(int, std::string);
+		std::string specHistoryText() const;
 	private:
 		bool readInput(std::string);	
 		void transformValiInput();
 		void transformSpecInput();
 		void generateIndents();
 		void generateGlyphs();
+		void generateChildren();
+		void reindexEntries();
+		void resetValidation();
+		void releaseInput();
+		void applySpecInput(std::string);
 		void generateValues();
 		void generateSpecs();	
+		void generateValiString();
+		void generateSpecString();
+		void generateTimeTables();
+		void generateTimeTableString();
+		void writeTimeTable(int);
+		static TimeTable& ownTimeTable(std::shared_ptr<TimeTable>&);
+		bool checkSpecField(int, const std::string&);
+		bool checkTimeTable(const TimeTable&);
+		int findTimeTable(int) const;
+		bool matchesSpecHash(std::string) const;
+		bool extractConstraints();
+		bool compileConstraints();
+		double constraintValue(int, const std::string&) const;
+		void evaluateConstraints(const std::vector<int>&);
+		bool generateValidationMessage();
+		std::string validateBatchFile(const std::string&, const std::vector<std::string>&) const;
+		void resetSpecHistory();
+		int recordSpecs(std::string);
+		void applySpecVersion(int);
 };
 
@@ -14,12 +14,18 @@
 #include <vector>
 #include <fstream>	
 #include <regex>
+#include <limits>
+#include <sstream>
+#include <cstdlib>
 
 /**
  * Validates specifications
  *
  * Verifies if given specificaions are the correct data
- * type and if they suit the range restrictions.
+ * type and if they suit the range restrictions. Time tables
+ * are parsed into numerical columns and checked as a whole
+ * (see "checkTimeTable()"). Afterwards all constraints over several
+ * parameters are evaluated (see SpecConstraint).
  * Parameters where the validation failed are added into the
  * "validationErrorParams" and a corresponding "validationMessage"
  * to display in LabView is generated.
@@ -39,97 +45,228 @@ validateSpecs(std::string specs)
 	
 	this->validationMessage = "";
 	this->validationErrorParams = "";
-	std::regex isBool ("true|false");
-	std::regex isString ("\"[a-zA-Z0-9_.]+\"");
-	std::regex isStringArr ("\\{\"[a-zA-Z0-9_]+\"\\}");
-	std::regex isInt ("[0-9\\*]+");
-	std::regex isDouble ("[0-9E.\\*\\-]+");
-	std::regex isDoubleTimestamp ("\\{[0-9E.\\*\\-]+,[0-9E.\\*\\-]+\\}");
-	std::regex isIntTimestamp ("\\{[0-9\\*]+,[0-9\\*]+\\}");
 
 	bool isValid = true;
 	for(int i=0; i<this->number_of_entries; i++)
 	{
-		if(this->entries[i].type == "Boolean")
+		if(this->entries.leftCell(i) == "timeTableContent")
+			continue;
+		if(!this->checkSpecField(i, inputSpecs[i]))
+			isValid = false;
+	}
+
+	this->validatedTables = {};
+
+	for(const std::shared_ptr<TimeTable>& table : this->timeTables)
+	{
+		std::shared_ptr<TimeTable> inputTable = std::make_shared<TimeTable>(*table);
+		for(int i=0; i<table->size(); i++)
 		{
-			if(!std::regex_match(inputSpecs[i], isBool))
+			int row = table->firstRow+i;
+			if(row >= (int) inputSpecs.size() || !parseSpecTimeStamp(inputSpecs[row], inputTable->time[i], inputTable->value[i]))
 			{
-				this->validationMessage += "Type ERROR: \"" + this->entries[i].leftCell + "\" should be of type " +  this->entries[i].type + "\n";
-				this->validationErrorParams += std::to_string(i) + "\n";
-				isValid = false;
+				inputTable->time[i] = std::numeric_limits<double>::quiet_NaN();
+				inputTable->value[i] = std::numeric_limits<double>::quiet_NaN();
 			}
 		}
+		if(!this->checkTimeTable(*inputTable))
+			isValid = false;
+		this->validatedTables.push_back(inputTable);
+	}
+
+	this->fieldValidationMessage = this->validationMessage;
+	this->fieldErrorParams = this->validationErrorParams;
+	this->fieldsValid = isValid;
 
-		if(this->entries[i].type == "Double")
+	this->constraintValues.resize(this->number_of_entries);
+	for(int i=0; i<this->number_of_entries; i++)
+		this->constraintValues[i] = this->constraintValue(i, i < (int) inputSpecs.size() ? inputSpecs[i] : "");
+	std::vector<int> all(this->constraints->size());
+	for(std::size_t i=0; i<all.size(); i++)
+		all[i] = i;
+	this->evaluateConstraints(all);
+	
+	return this->generateValidationMessage();
+}
+
+/**
+ * Validate one edited specification
+ *
+ * Only the edited parameter (or the time table of an edited row) and
+ * the constraints depending on it are checked again, the results of
+ * all other checks are kept from the last "validateSpecs()" (or the
+ * loaded specification file). A time table is checked with the rows
+ * validated last and the edited row replaced, so the errors of its
+ * other rows are kept. The "validationMessage" and
+ * "validationErrorParams" are updated.
+ *
+ * @param index: Index of the edited parameter
+ * @param spec: The new specification
+ * @return Bool whether the specs are valid
+ */
+bool BiogasSpecValiReader::
+validateSpecEdit(int index, std::string spec)
+{
+	if(index < 0 || index >= this->number_of_entries)
+		return false;
+
+	if(this->constraintValues.empty())
+	{
+		this->constraintValues.resize(this->number_of_entries);
+		for(int i=0; i<this->number_of_entries; i++)
+			this->constraintValues[i] = this->constraintValue(i, this->entries.spec(i));
+		std::vector<int> all(this->constraints->size());
+		for(std::size_t i=0; i<all.size(); i++)
+			all[i] = i;
+		this->evaluateConstraints(all);
+	}
+	if(this->validatedTables.size() != this->timeTables.size())
+		this->validatedTables = this->timeTables;
+
+	int pos = -1;
+	for(int i=0; i<(int) this->timeTables.size() && pos < 0; i++)
+		if(index >= this->timeTables[i]->firstRow && index < this->timeTables[i]->firstRow+this->timeTables[i]->size())
+			pos = i;
+	int first = (pos < 0) ? index : this->timeTables[pos]->firstRow;
+	int last = (pos < 0) ? index : this->timeTables[pos]->firstRow+this->timeTables[pos]->size()-1;
+
+	this->validationMessage = "";
+	this->validationErrorParams = "";
+	std::istringstream messages(this->fieldValidationMessage);
+	std::istringstream params(this->fieldErrorParams);
+	for(std::string message, param; std::getline(messages, message) && std::getline(params, param); )
+	{
+		int errorIndex = std::atoi(param.c_str());
+		if(errorIndex >= first && errorIndex <= last)
+			continue;
+		this->validationMessage += message + "\n";
+		this->validationErrorParams += param + "\n";
+	}
+	if(pos < 0)
+		this->checkSpecField(index, spec);
+	else
+	{
+		TimeTable& inputTable = ownTimeTable(this->validatedTables[pos]);
+		int row = index - inputTable.firstRow;
+		if(!parseSpecTimeStamp(spec, inputTable.time[row], inputTable.value[row]))
 		{
-			if(!std::regex_match(inputSpecs[i], isDouble) &&
-					!std::regex_match(inputSpecs[i], isDoubleTimestamp))
-			{
-				this->validationMessage += "Type ERROR: \"" + this->entries[i].leftCell + "\" should be of type " +  this->entries[i].type + "\n";
-				this->validationErrorParams += std::to_string(i) + "\n";
-				isValid = false;
-			}
-			if(!this->entries[i].rangeMin.empty() && !this->entries[i].rangeMax.empty())
-			{ 
-				if(std::regex_match(inputSpecs[i], isDouble) 
-						&& (std::stod(inputSpecs[i])<std::stod(this->entries[i].rangeMin) || std::stod(inputSpecs[i])>std::stod(this->entries[i].rangeMax)))
-				{
-					this->validationMessage += "Range ERROR: "
-						+ this->entries[i].leftCell
-						+ " should be in Range {" 
-						+ this->entries[i].rangeMin + "," 
-						+ this->entries[i].rangeMax + "}\n";
-					this->validationErrorParams += std::to_string(i) + "\n";
-					isValid = false;
-				}
-			}
+			inputTable.time[row] = std::numeric_limits<double>::quiet_NaN();
+			inputTable.value[row] = std::numeric_limits<double>::quiet_NaN();
+		}
+		this->checkTimeTable(inputTable);
+	}
+	this->fieldValidationMessage = this->validationMessage;
+	this->fieldErrorParams = this->validationErrorParams;
+	this->fieldsValid = this->fieldErrorParams.empty();
+
+	this->constraintValues[index] = this->constraintValue(index, spec);
+	if(index < (int) this->constraintsByEntry->size())
+		this->evaluateConstraints((*this->constraintsByEntry)[index]);
+	return this->generateValidationMessage();
+}
+
+/**
+ * Check the type and range of one specification
+ *
+ * Parameters where the check failed are added into the
+ * "validationErrorParams" with a corresponding "validationMessage".
+ * Rows of time tables are checked as a whole (see "checkTimeTable()").
+ *
+ * @param index: Index of the parameter
+ * @param spec: The specification
+ * @return Bool whether the specification is valid
+ */
+bool BiogasSpecValiReader::
+checkSpecField(int index, const std::string& spec)
+{
+	static const std::regex isBool ("true|false");
+	static const std::regex isString ("\"[a-zA-Z0-9_.]+\"");
+	static const std::regex isStringArr ("\\{\"[a-zA-Z0-9_]+\"\\}");
+	static const std::regex isInt ("[0-9\\*]+");
+	static const std::regex isDouble ("[0-9E.\\*\\-]+");
+	static const std::regex isDoubleTimestamp ("\\{[0-9E.\\*\\-]+,[0-9E.\\*\\-]+\\}");
+	static const std::regex isIntTimestamp ("\\{[0-9\\*]+,[0-9\\*]+\\}");
+
+	bool isValid = true;
+	if(this->entries.type(index) == "Boolean")
+	{
+		if(!std::regex_match(spec, isBool))
+		{
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(index) + "\" should be of type " +  this->entries.type(index) + "\n";
+			this->validationErrorParams += std::to_string(index) + "\n";
+			isValid = false;
 		}
+	}
 
-		if(this->entries[i].type == "Integer")
+	if(this->entries.type(index) == "Double")
+	{
+		if(!std::regex_match(spec, isDouble) &&
+				!std::regex_match(spec, isDoubleTimestamp))
 		{
-			if(!std::regex_match(inputSpecs[i], isInt) &&
-					!std::regex_match(inputSpecs[i], isIntTimestamp))
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(index) + "\" should be of type " +  this->entries.type(index) + "\n";
+			this->validationErrorParams += std::to_string(index) + "\n";
+			isValid = false;
+		}
+		if(this->entries.hasRange(index))
+		{ 
+			if(std::regex_match(spec, isDouble) 
+					&& (std::stod(spec)<this->entries.rangeMin[index] || std::stod(spec)>this->entries.rangeMax[index]))
 			{
-				this->validationMessage += "Type ERROR: \"" + this->entries[i].leftCell + "\" should be of type " +  this->entries[i].type + "\n";
-				this->validationErrorParams += std::to_string(i) + "\n";
+				this->validationMessage += "Range ERROR: "
+					+ this->entries.leftCell(index)
+					+ " should be in Range {" 
+					+ TableEntries::rangeText(this->entries.rangeMin[index]) + "," 
+					+ TableEntries::rangeText(this->entries.rangeMax[index]) + "}\n";
+				this->validationErrorParams += std::to_string(index) + "\n";
 				isValid = false;
 			}
-			if(!this->entries[i].rangeMin.empty() && !this->entries[i].rangeMax.empty())
-			{ 
-				if(std::regex_match(inputSpecs[i], isInt) 
-						&& (std::stoi(inputSpecs[i])<std::stoi(this->entries[i].rangeMin) || std::stoi(inputSpecs[i])>std::stoi(this->entries[i].rangeMax)))
-				{
-					this->validationMessage += "Range ERROR: "
-						+ this->entries[i].leftCell
-						+ " should be in Range {" 
-						+ this->entries[i].rangeMin + "," 
-						+ this->entries[i].rangeMax + "}\n";
-					this->validationErrorParams += std::to_string(i) + "\n";
-					isValid = false;
-				}
-			}
 		}
+	}
 
-		if(this->entries[i].type == "String")
+	if(this->entries.type(index) == "Integer")
+	{
+		if(!std::regex_match(spec, isInt) &&
+				!std::regex_match(spec, isIntTimestamp))
 		{
-			if(!std::regex_match(inputSpecs[i], isString))
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(index) + "\" should be of type " +  this->entries.type(index) + "\n";
+			this->validationErrorParams += std::to_string(index) + "\n";
+			isValid = false;
+		}
+		if(this->entries.hasRange(index))
+		{ 
+			if(std::regex_match(spec, isInt) 
+					&& (std::stoi(spec)<this->entries.rangeMin[index] || std::stoi(spec)>this->entries.rangeMax[index]))
 			{
-				this->validationMessage += "Type ERROR: \"" + this->entries[i].leftCell + "\" should be of type " +  this->entries[i].type + "\n";
-				this->validationErrorParams += std::to_string(i) + "\n";
+				this->validationMessage += "Range ERROR: "
+					+ this->entries.leftCell(index)
+					+ " should be in Range {" 
+					+ TableEntries::rangeText(this->entries.rangeMin[index]) + "," 
+					+ TableEntries::rangeText(this->entries.rangeMax[index]) + "}\n";
+				this->validationErrorParams += std::to_string(index) + "\n";
 				isValid = false;
 			}
 		}
+	}
 
-		if(this->entries[i].type == "String[]")
+	if(this->entries.type(index) == "String")
+	{
+		if(!std::regex_match(spec, isString))
 		{
-			if(!std::regex_match(inputSpecs[i], isStringArr))
-			{
-				this->validationMessage += "Type ERROR: \"" + this->entries[i].leftCell + "\" should be of type " +  this->entries[i].type + "\n";
-				this->validationErrorParams += std::to_string(i) + "\n";
-				isValid = false;
-			}
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(index) + "\" should be of type " +  this->entries.type(index) + "\n";
+			this->validationErrorParams += std::to_string(index) + "\n";
+			isValid = false;
 		}
 	}
-	
+
+	if(this->entries.type(index) == "String[]")
+	{
+		if(!std::regex_match(spec, isStringArr))
+		{
+			this->validationMessage += "Type ERROR: \"" + this->entries.leftCell(index) + "\" should be of type " +  this->entries.type(index) + "\n";
+			this->validationErrorParams += std::to_string(index) + "\n";
+			isValid = false;
+		}
+	}
+
 	return isValid;
 }
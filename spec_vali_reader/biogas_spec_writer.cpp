@@ -38,28 +38,28 @@ writeOutputSpecs(std::string specs)
 		}
 		for(int i=0; i<this->number_of_entries-1; i++)
 		{
-			this->outputSpecs += std::string(this->entries[i].indent, '\t');
-			if(this->entries[i].glyph == 15)
-				this->outputSpecs += this->entries[i].leftCell + "={\n";
+			this->outputSpecs += std::string(this->entries.indent[i], '\t');
+			if(this->entries.glyph[i] == 15)
+				this->outputSpecs += this->entries.leftCell(i) + "={\n";
 			else
 			{
-				if (this->entries[i].leftCell.rfind("\"", 0) == 0)
-					this->outputSpecs += "[" + this->entries[i].leftCell + "]=" + inputSpecs[i] + ",\n";
-				else if(this->entries[i].leftCell == "timeTableContent")
+				if (this->entries.leftCell(i).rfind("\"", 0) == 0)
+					this->outputSpecs += "[" + this->entries.leftCell(i) + "]=" + inputSpecs[i] + ",\n";
+				else if(this->entries.leftCell(i) == "timeTableContent")
 					this->outputSpecs += inputSpecs[i] + ",\n";
 				else
-					this->outputSpecs += this->entries[i].leftCell + "=" + inputSpecs[i] + ",\n";
+					this->outputSpecs += this->entries.leftCell(i) + "=" + inputSpecs[i] + ",\n";
 			}
 
-			if(this->entries[i].indent>this->entries[i+1].indent)
+			if(this->entries.indent[i]>this->entries.indent[i+1])
 			{
-				int num_closing_par = (this->entries[i].indent)-(this->entries[i+1].indent);
+				int num_closing_par = (this->entries.indent[i])-(this->entries.indent[i+1]);
 				for(int j=0; j<num_closing_par; j++)
-					this->outputSpecs += std::string(this->entries[i].indent-j-1,'\t') + "},\n";
+					this->outputSpecs += std::string(this->entries.indent[i]-j-1,'\t') + "},\n";
 			}
 		}
 
-		int num_closing_par_end = this->entries[this->number_of_entries-1].indent;
+		int num_closing_par_end = this->entries.indent[this->number_of_entries-1];
 		for(int i=0; i<num_closing_par_end-1; i++)
 			this->outputSpecs += std::string(num_closing_par_end-i-1,'\t') + "},\n";		
 		this->outputSpecs += "}";
@@ -70,3 +70,32 @@ writeOutputSpecs(std::string specs)
 	return true;
 }
 
+/**
+ * Write a version of the history into a specification file
+ *
+ * Uses the spec writer ("writeOutputSpecs()") on the version, so the
+ * version has to be valid. The loaded data stays at the current
+ * version, only "outputSpecs" and the validation results are set.
+ *
+ * @param version: The version
+ * @param filepath: The specification file
+ * @return Bool if the version is valid and the file could be written
+ */
+bool BiogasSpecValiReader::
+exportSpecVersion(int version, std::string filepath)
+{
+	BiogasSpecValiReader reader(*this);
+	if(!reader.checkoutSpec(version))
+		return false;
+
+	bool valid = reader.writeOutputSpecs(reader.specString);
+	this->outputSpecs = reader.outputSpecs;
+	this->validationMessage = reader.validationMessage;
+	this->validationErrorParams = reader.validationErrorParams;
+	if(!valid)
+		return false;
+
+	std::ofstream file(filepath);
+	file << this->outputSpecs;
+	return file.good();
+}
@@ -14,6 +14,7 @@
 #include <vector>
 #include <fstream>	
 #include <regex>
+#include <limits>
 #include <boost/algorithm/string.hpp>
 
 /**
@@ -84,23 +85,21 @@ transformValiInput()
  * Generate indentations
  *
  * Parse all paranthesis to assign the correct indentation.
- * This method also creates the TableEntry Objects. 
+ * This method also creates the rows of "entries". 
  * Therefor it has to be called first!
  */
 void BiogasSpecValiReader::
 generateIndents()
 {
 	int ind = -1;
-	this->entries = {};
+	this->entries.clear();
 
 	for(int i=0; i<this->input_valiModified.size(); i++)
 	{
 		if(this->input_valiModified.at(i) == '{')
 		{
 			ind += 1;
-			TableEntry* newEntry = new TableEntry();
-			newEntry->indent = ind;
-			this->entries.push_back(*newEntry);
+			this->entries.add(ind);
 		}
 		else if(this->input_valiModified.at(i) == '}')
 			ind -= 1;
@@ -120,9 +119,9 @@ generateGlyphs()
 {
 	for(int i=0; i<this->number_of_entries-1; i++)
 	{
-		if(this->entries[i].indent<this->entries[i+1].indent)
+		if(this->entries.indent[i]<this->entries.indent[i+1])
 		{
-			this->entries[i].glyph = 15;
+			this->entries.glyph[i] = 15;
 		}
 	}
 }
@@ -160,27 +159,27 @@ generateValues()
 		if(std::regex_search(line, names_re))
 		{
 			++index;
-			this->entries[index].leftCell = line.substr(0,line.size()-2);
+			this->entries.setLeftCell(index, line.substr(0,line.size()-2));
 			if(std::regex_search(line, table_entry))
 			{
-				this->entries[index].type = last_type;	
-				this->entries[index].defaultVal = last_default;
+				this->entries.setType(index, last_type);	
+				this->entries.setDefaultVal(index, last_default);
 			}
 		}
 
 		if(std::regex_search(line, type_re))
 		{
 			last_type = line.substr(6,line.size()-7);
-			if(entries[index].glyph == 0)
-				this->entries[index].type = last_type;
+			if(entries.glyph[index] == 0)
+				this->entries.setType(index, last_type);
 		}
 
 		if(std::regex_search(line, default_re))
 		{
 			boost::replace_all(line, "\"", "");
 			last_default = line.substr(8,line.size()-8);
-			if(entries[index].glyph == 0)
-				this->entries[index].defaultVal = last_default;
+			if(entries.glyph[index] == 0)
+				this->entries.setDefaultVal(index, last_default);
 		}
 
 		if(std::regex_search(line, range_re))
@@ -188,19 +187,78 @@ generateValues()
 			std::string::size_type min_pos = line.find("[");
 			std::string::size_type max_pos = line.find("-");
 			std::string::size_type end_pos = line.find("]");
-			this->entries[index].rangeMin = line.substr(min_pos+1,max_pos-min_pos-1);
-			this->entries[index].rangeMax = line.substr(max_pos+1,end_pos-max_pos-1);
+			if(!parseSpecNumber(line.substr(min_pos+1,max_pos-min_pos-1), this->entries.rangeMin[index])
+					|| !parseSpecNumber(line.substr(max_pos+1,end_pos-max_pos-1), this->entries.rangeMax[index]))
+			{
+				this->entries.rangeMin[index] = std::numeric_limits<double>::quiet_NaN();
+				this->entries.rangeMax[index] = std::numeric_limits<double>::quiet_NaN();
+			}
 		}
 	}
 
+	this->generateValiString();
+}
+
+/**
+ * Write the "valiString" from the generated "entries"
+ */
+void BiogasSpecValiReader::
+generateValiString()
+{
+	std::string::size_type size = 0;
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		size += this->entries.leftCell(i).size() + this->entries.type(i).size() + 
+			this->entries.defaultVal(i).size() + 12;
+	}
+
 	this->valiString = "";
+	this->valiString.reserve(size);
 	for(int i=0; i<this->number_of_entries; i++)
 	{
-		this->valiString += std::to_string(this->entries[i].indent) + " " + 
-			std::to_string(this->entries[i].glyph) + " " + 
-			this->entries[i].leftCell + " " +
-			this->entries[i].type + " " +
-			this->entries[i].defaultVal + "\n";		
+		this->valiString += std::to_string(this->entries.indent[i]) + " " + 
+			std::to_string(this->entries.glyph[i]) + " " + 
+			this->entries.leftCell(i) + " " +
+			this->entries.type(i) + " " +
+			this->entries.defaultVal(i) + "\n";		
 	}
 	this->valiString.resize(this->valiString.size() - 1);
 }
+
+/**
+ * Create a result buffer with all validation data
+ *
+ * Same content as "valiString" (plus the ranges) as
+ * fixed-layout records (see result_buffer.h).
+ *
+ * @return The buffer (release with releaseResultBuffer())
+ */
+BiogasResultBuffer* BiogasSpecValiReader::
+createValiBuffer() const
+{
+	typedef ResultBufferBuilder<BiogasValiRecord> Builder;
+	uint32_t arenaSize = 0;
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		arenaSize += Builder::arenaSize(this->entries.leftCell(i)) + Builder::arenaSize(this->entries.type(i))
+			+ Builder::arenaSize(this->entries.defaultVal(i)) + Builder::arenaSize(TableEntries::rangeText(this->entries.rangeMin[i]))
+			+ Builder::arenaSize(TableEntries::rangeText(this->entries.rangeMax[i]));
+	}
+
+	Builder builder(this->number_of_entries, arenaSize);
+	if(builder.result() == nullptr)
+		return nullptr;
+
+	for(int i=0; i<this->number_of_entries; i++)
+	{
+		BiogasValiRecord& record = builder.record(i);
+		record.indent = this->entries.indent[i];
+		record.glyph = this->entries.glyph[i];
+		record.leftCell = builder.add(this->entries.leftCell(i));
+		record.type = builder.add(this->entries.type(i));
+		record.defaultVal = builder.add(this->entries.defaultVal(i));
+		record.rangeMin = builder.add(TableEntries::rangeText(this->entries.rangeMin[i]));
+		record.rangeMax = builder.add(TableEntries::rangeText(this->entries.rangeMax[i]));
+	}
+	return builder.result();
+}
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "spec_constraint.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+/**
+ * Compile the expression
+ *
+ * @param resolve: Finds the parameters of a path (their indices)
+ * @return Bool if the expression is valid and all paths exist
+ */
+bool SpecConstraint::
+compile(const Resolver& resolve)
+{
+	this->program = {};
+	this->dependencies = {};
+	this->pos = 0;
+	this->resolver = &resolve;
+
+	bool valid = this->parseOr();
+	while(this->pos < this->expression.size() && isspace(this->expression[this->pos]))
+		++this->pos;
+	this->resolver = nullptr;
+	if(!valid || this->pos != this->expression.size())
+	{
+		this->program = {};
+		this->dependencies = {};
+		return false;
+	}
+
+	std::sort(this->dependencies.begin(), this->dependencies.end());
+	this->dependencies.erase(std::unique(this->dependencies.begin(), this->dependencies.end()), this->dependencies.end());
+	return true;
+}
+
+/**
+ * Append an instruction to the program
+ */
+void SpecConstraint::
+emit(int op, int arg, double constant)
+{
+	SpecInstruction instruction;
+	instruction.op = op;
+	instruction.arg = arg;
+	instruction.constant = constant;
+	this->program.push_back(instruction);
+}
+
+/**
+ * Skip whitespaces and consume a token if it follows
+ *
+ * @param token: The token
+ * @return Bool if the token was consumed
+ */
+bool SpecConstraint::
+accept(const char* token)
+{
+	while(this->pos < this->expression.size() && isspace(this->expression[this->pos]))
+		++this->pos;
+	std::size_t length = std::strlen(token);
+	if(this->expression.compare(this->pos, length, token) != 0)
+		return false;
+	this->pos += length;
+	return true;
+}
+
+bool SpecConstraint::
+parseOr()
+{
+	if(!this->parseAnd())
+		return false;
+	while(this->accept("||"))
+	{
+		if(!this->parseAnd())
+			return false;
+		this->emit(Or);
+	}
+	return true;
+}
+
+bool SpecConstraint::
+parseAnd()
+{
+	if(!this->parseComparison())
+		return false;
+	while(this->accept("&&"))
+	{
+		if(!this->parseComparison())
+			return false;
+		this->emit(And);
+	}
+	return true;
+}
+
+bool SpecConstraint::
+parseComparison()
+{
+	if(!this->parseSum())
+		return false;
+
+	int op;
+	if(this->accept("<="))
+		op = LessEqual;
+	else if(this->accept(">="))
+		op = GreaterEqual;
+	else if(this->accept("=="))
+		op = Equal;
+	else if(this->accept("!=") || this->accept("~="))
+		op = NotEqual;
+	else if(this->accept("<"))
+		op = Less;
+	else if(this->accept(">"))
+		op = Greater;
+	else
+		return true;
+
+	if(!this->parseSum())
+		return false;
+	this->emit(op);
+	return true;
+}
+
+bool SpecConstraint::
+parseSum()
+{
+	if(!this->parseTerm())
+		return false;
+	for(;;)
+	{
+		int op;
+		if(this->accept("+"))
+			op = Add;
+		else if(this->accept("-"))
+			op = Subtract;
+		else
+			return true;
+		if(!this->parseTerm())
+			return false;
+		this->emit(op);
+	}
+}
+
+bool SpecConstraint::
+parseTerm()
+{
+	if(!this->parseUnary())
+		return false;
+	for(;;)
+	{
+		int op;
+		if(this->accept("*"))
+			op = Multiply;
+		else if(this->accept("/"))
+			op = Divide;
+		else
+			return true;
+		if(!this->parseUnary())
+			return false;
+		this->emit(op);
+	}
+}
+
+bool SpecConstraint::
+parseUnary()
+{
+	if(this->accept("-"))
+	{
+		if(!this->parseUnary())
+			return false;
+		this->emit(Negate);
+		return true;
+	}
+	while(this->pos < this->expression.size() && isspace(this->expression[this->pos]))
+		++this->pos;
+	if(this->pos+1 < this->expression.size() && this->expression[this->pos] == '!' && this->expression[this->pos+1] != '=')
+	{
+		++this->pos;
+		if(!this->parseUnary())
+			return false;
+		this->emit(Not);
+		return true;
+	}
+	return this->parsePrimary();
+}
+
+/**
+ * Read a path (or a function name)
+ *
+ * A '*' is only part of the path if it is a whole key ("folder.*").
+ *
+ * @return The path or "" if there is none
+ */
+std::string SpecConstraint::
+parsePath()
+{
+	const std::string& expr = this->expression;
+	std::string::size_type start = this->pos;
+	while(this->pos < expr.size() && (isalnum(expr[this->pos]) || expr[this->pos] == '_' || expr[this->pos] == '.'
+			|| (expr[this->pos] == '*' && this->pos > start && expr[this->pos-1] == '.')))
+		++this->pos;
+	return expr.substr(start, this->pos-start);
+}
+
+/**
+ * Parse the arguments of min, max and sum
+ *
+ * An argument which is a path may stand for several parameters,
+ * all of them are pushed.
+ *
+ * @param count: Number of values pushed
+ * @return Bool if the arguments are valid
+ */
+bool SpecConstraint::
+parseArguments(int& count)
+{
+	count = 0;
+	do
+	{
+		std::string::size_type start = this->pos;
+		while(this->pos < this->expression.size() && isspace(this->expression[this->pos]))
+			++this->pos;
+		std::string path = (this->pos < this->expression.size() && isalpha(this->expression[this->pos])) ? this->parsePath() : "";
+		std::vector<int> indices;
+		if(!path.empty() && (this->accept(",") || this->accept(")")) && (*this->resolver)(path, indices) && !indices.empty())
+		{
+			--this->pos;
+			for(int index : indices)
+			{
+				this->emit(Parameter, index);
+				this->dependencies.push_back(index);
+			}
+			count += indices.size();
+			continue;
+		}
+
+		this->pos = start;
+		if(!this->parseOr())
+			return false;
+		++count;
+	}
+	while(this->accept(","));
+	return this->accept(")") && count > 0;
+}
+
+bool SpecConstraint::
+parsePrimary()
+{
+	if(this->accept("("))
+		return this->parseOr() && this->accept(")");
+
+	const std::string& expr = this->expression;
+	if(this->pos < expr.size() && (isdigit(expr[this->pos]) || expr[this->pos] == '.'))
+	{
+		char* end;
+		double value = std::strtod(expr.c_str()+this->pos, &end);
+		this->pos = end - expr.c_str();
+		this->emit(Constant, 0, value);
+		return true;
+	}
+
+	std::string word = this->parsePath();
+	if(word.empty())
+		return false;
+
+	if(word == "true" || word == "false")
+	{
+		this->emit(Constant, 0, word == "true" ? 1 : 0);
+		return true;
+	}
+
+	if(this->accept("("))
+	{
+		int count;
+		if(!this->parseArguments(count))
+			return false;
+		if(word == "abs" && count == 1)
+			this->emit(Abs);
+		else if(word == "min")
+			this->emit(Min, count);
+		else if(word == "max")
+			this->emit(Max, count);
+		else if(word == "sum")
+			this->emit(Sum, count);
+		else
+			return false;
+		return true;
+	}
+
+	std::vector<int> indices;
+	if(!(*this->resolver)(word, indices) || indices.size() != 1)
+		return false;
+	this->emit(Parameter, indices[0]);
+	this->dependencies.push_back(indices[0]);
+	return true;
+}
+
+/**
+ * Evaluate the constraint
+ *
+ * @param values: Numerical values of all parameters (NaN if not numerical)
+ * @return 1 if the constraint holds, 0 if not, -1 if a used value is not numerical
+ */
+int SpecConstraint::
+evaluate(const std::vector<double>& values) const
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	std::vector<double> stack;
+	stack.reserve(this->program.size());
+
+	for(const SpecInstruction& instruction : this->program)
+	{
+		switch(instruction.op)
+		{
+			case Constant:
+				stack.push_back(instruction.constant);
+				continue;
+			case Parameter:
+				stack.push_back(instruction.arg < (int) values.size() ? values[instruction.arg] : nan);
+				continue;
+			case Negate:
+				stack.back() = -stack.back();
+				continue;
+			case Not:
+				stack.back() = std::isnan(stack.back()) ? nan : (stack.back() == 0);
+				continue;
+			case Abs:
+				stack.back() = std::fabs(stack.back());
+				continue;
+			case Min:
+			case Max:
+			case Sum:
+			{
+				double result = stack[stack.size()-instruction.arg];
+				for(std::size_t i=stack.size()-instruction.arg+1; i<stack.size(); i++)
+				{
+					if(std::isnan(stack[i]) || std::isnan(result))
+						result = nan;
+					else if(instruction.op == Min)
+						result = std::min(result, stack[i]);
+					else if(instruction.op == Max)
+						result = std::max(result, stack[i]);
+					else
+						result += stack[i];
+				}
+				stack.resize(stack.size()-instruction.arg);
+				stack.push_back(result);
+				continue;
+			}
+		}
+
+		double right = stack.back();
+		stack.pop_back();
+		double& left = stack.back();
+		if(std::isnan(left) || std::isnan(right))
+		{
+			left = nan;
+			continue;
+		}
+		switch(instruction.op)
+		{
+			case Add: left += right; break;
+			case Subtract: left -= right; break;
+			case Multiply: left *= right; break;
+			case Divide: left /= right; break;
+			case Less: left = left < right; break;
+			case LessEqual: left = left <= right; break;
+			case Greater: left = left > right; break;
+			case GreaterEqual: left = left >= right; break;
+			case Equal: left = left == right; break;
+			case NotEqual: left = left != right; break;
+			case And: left = (left != 0) && (right != 0); break;
+			case Or: left = (left != 0) || (right != 0); break;
+		}
+	}
+
+	if(stack.size() != 1 || std::isnan(stack.back()))
+		return -1;
+	return stack.back() != 0 ? 1 : 0;
+}
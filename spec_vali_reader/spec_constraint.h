@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+
+/**
+ * Class to represent one instruction of a compiled constraint
+ *
+ * @param op: Operation (see SpecConstraint::Op)
+ * @param arg: Index of the parameter or number of arguments
+ * @param constant: Value of a constant
+ */
+class SpecInstruction {
+	public:
+		SpecInstruction(){};
+
+		int op = 0;
+		int arg = 0;
+		double constant = 0.0;
+};
+
+/**
+ * Class to represent a constraint over several parameters
+ *
+ * A constraint is an expression given in the validation file by the
+ * keyword "constraint" of a parameter, e.g.
+ *
+ *   sim_endtime = {
+ *       type = "Double",
+ *       constraint = "problem.numericalSetup.sim_endtime>problem.numericalSetup.sim_starttime"
+ *   }
+ *
+ * Parameters are referenced by their path. Supported are numbers,
+ * + - * /, the comparisons < <= > >= == != (also ~=), && || !,
+ * parentheses and the functions abs(x), min(...), max(...) and
+ * sum(...). Within the functions a path may end with ".*" (all
+ * parameters of a folder) and a time table stands for the times of
+ * all its rows, e.g.
+ *
+ *   abs(sum(problem.feeding.stoidisintegration.*)-1)<1E-6
+ *   max(problem.feeding.timetable)<=problem.numericalSetup.sim_endtime
+ *
+ * Booleans are 1 (true) and 0 (false). Whitespaces are not needed,
+ * they are removed from the validation file anyway.
+ *
+ * The expression is compiled once into a program for a stack machine.
+ *
+ * @param expression: The expression
+ * @param owner: Index of the parameter holding the constraint
+ * @param program: The compiled expression
+ * @param dependencies: Indices of all parameters used by the constraint
+ */
+class SpecConstraint {
+	public:
+		enum Op {Constant, Parameter, Negate, Not, Add, Subtract, Multiply, Divide,
+			Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, And, Or, Abs, Min, Max, Sum};
+		typedef std::function<bool(const std::string&, std::vector<int>&)> Resolver;
+
+		SpecConstraint(){};
+
+		std::string expression = "";
+		int owner = -1;
+		std::vector<SpecInstruction> program;
+		std::vector<int> dependencies;
+
+		bool compile(const Resolver&);
+		int evaluate(const std::vector<double>&) const;
+
+	private:
+		std::string::size_type pos = 0;
+		const Resolver* resolver = nullptr;
+
+		bool parseOr();
+		bool parseAnd();
+		bool parseComparison();
+		bool parseSum();
+		bool parseTerm();
+		bool parseUnary();
+		bool parsePrimary();
+		bool parseArguments(int&);
+		std::string parsePath();
+		bool accept(const char*);
+		void emit(int, int = 0, double = 0.0);
+};
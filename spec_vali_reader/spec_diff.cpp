@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "spec_diff.h"
+#include "spec_tree.h"
+#include "time_table.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Build the digest of a parsed specification
+ *
+ * @param tree: The specification
+ */
+void SpecDigest::
+build(const SpecTree& tree)
+{
+	this->nodes.clear();
+	this->nodes.resize(1);
+	this->fill(0, tree.root);
+}
+
+/**
+ * Read a specification file and build its digest
+ *
+ * @param filepath: The absolute path to the specification file
+ * @return Bool if the file could be read and parsed
+ */
+bool SpecDigest::
+load(const std::string& filepath)
+{
+	std::string input;
+	SpecTree tree;
+	this->nodes.clear();
+	if(!readSpecFile(filepath, input) || !tree.parse(input))
+		return false;
+	this->build(tree);
+	return true;
+}
+
+/**
+ * Hash of the whole specification
+ *
+ * @return The hash of the root
+ */
+unsigned long long SpecDigest::
+hash() const
+{
+	return this->nodes.empty() ? 0 : this->nodes[0].hash;
+}
+
+/**
+ * Fill a node and, recursively, its children
+ *
+ * The children are appended as one block, so "nodes" may be
+ * reallocated and is only accessed by index.
+ *
+ * @param index: Index of the node
+ * @param node: The node of the parsed specification
+ */
+void SpecDigest::
+fill(int index, const SpecNode& node)
+{
+	this->nodes[index].key = node.key;
+
+	bool leaf = !node.isTable || node.isArray();
+	for(std::size_t i=0; i<node.children.size() && leaf; i++)
+		leaf = !node.children[i].isTable;
+	if(leaf)
+	{
+		this->nodes[index].value = node.normalizedValue();
+		this->nodes[index].hash = hashSpecString(this->nodes[index].value, hashSpecString(node.key + "="));
+		return;
+	}
+
+	std::vector<const SpecNode*> children;
+	for(const SpecNode& child : node.children)
+		children.push_back(&child);
+	bool isArray = node.isArray();
+	if(!isArray)
+		std::sort(children.begin(), children.end(),
+			[](const SpecNode* a, const SpecNode* b) { return a->key < b->key; });
+
+	int first = this->nodes.size();
+	this->nodes.resize(first + children.size());
+	this->nodes[index].first = first;
+	this->nodes[index].count = children.size();
+	this->nodes[index].isArray = isArray;
+	this->nodes[index].isTimeTable = node.isTimeTable();
+
+	unsigned long long hash = hashSpecString(node.key + (isArray ? "[" : "{"));
+	for(std::size_t i=0; i<children.size(); i++)
+	{
+		this->fill(first+i, *children[i]);
+		if(this->nodes[index].isTimeTable)
+			parseSpecNumber(children[i]->children[0].value, this->nodes[first+i].time);
+
+		unsigned long long childHash = this->nodes[first+i].hash;
+		for(int byte=0; byte<8; byte++)
+		{
+			hash ^= (childHash >> (8*byte)) & 255;
+			hash *= 1099511628211ULL;
+		}
+	}
+	this->nodes[index].hash = hash;
+}
+
+/**
+ * Compare with another specification
+ *
+ * If both specifications consist of one table with different names
+ * (e.g. "problem" of a specification file and "pSettings" of a
+ * problemSettings.lua), the contents of the tables are compared and
+ * the paths start with the name of this specification.
+ *
+ * @param other: The other specification
+ * @param changes: Vector to append all differences to
+ */
+void SpecDigest::
+diff(const SpecDigest& other, std::vector<SpecChange>& changes) const
+{
+	if(this->nodes.empty() || other.nodes.empty())
+		return;
+
+	const SpecDigestNode& root = this->nodes[0];
+	const SpecDigestNode& otherRoot = other.nodes[0];
+	if(root.count == 1 && otherRoot.count == 1 && !root.isArray && !otherRoot.isArray
+			&& this->nodes[root.first].key != other.nodes[otherRoot.first].key)
+		this->diffNodes(root.first, other, otherRoot.first, this->nodes[root.first].key, changes);
+	else
+		this->diffNodes(0, other, 0, "", changes);
+}
+
+/**
+ * Compare two nodes with the same path
+ *
+ * @param index: Index of the node in this digest
+ * @param other: The other digest
+ * @param otherIndex: Index of the node in the other digest
+ * @param path: Path of the nodes
+ * @param changes: Vector to append all differences to
+ */
+void SpecDigest::
+diffNodes(int index, const SpecDigest& other, int otherIndex, const std::string& path, std::vector<SpecChange>& changes) const
+{
+	const SpecDigestNode& node = this->nodes[index];
+	const SpecDigestNode& otherNode = other.nodes[otherIndex];
+	if(node.hash == otherNode.hash)
+		return;
+
+	if(node.first < 0 && otherNode.first < 0)
+	{
+		if(node.value != otherNode.value)
+		{
+			SpecChange change;
+			change.path = path;
+			change.before = node.value;
+			change.after = otherNode.value;
+			changes.push_back(change);
+		}
+		return;
+	}
+	if(node.first < 0 || otherNode.first < 0 || node.isArray != otherNode.isArray)
+	{
+		this->collect(index, path, true, changes);
+		other.collect(otherIndex, path, false, changes);
+		return;
+	}
+	if(node.isTimeTable && otherNode.isTimeTable)
+	{
+		this->diffTimeTables(index, other, otherIndex, path, changes);
+		return;
+	}
+
+	int i = node.first, end = node.first + node.count;
+	int j = otherNode.first, otherEnd = otherNode.first + otherNode.count;
+	while(i < end || j < otherEnd)
+	{
+		int order = (i == end) ? 1 : (j == otherEnd) ? -1 : node.isArray ? 0
+			: this->nodes[i].key.compare(other.nodes[j].key);
+		if(order < 0)
+		{
+			this->collect(i, this->childPath(index, path, i), true, changes);
+			++i;
+		}
+		else if(order > 0)
+		{
+			other.collect(j, other.childPath(otherIndex, path, j), false, changes);
+			++j;
+		}
+		else
+		{
+			this->diffNodes(i, other, j, this->childPath(index, path, i), changes);
+			++i;
+			++j;
+		}
+	}
+}
+
+/**
+ * Compare two time tables row by row
+ *
+ * Rows are matched by their time (time tables are sorted by time).
+ *
+ * @param index: Index of the time table in this digest
+ * @param other: The other digest
+ * @param otherIndex: Index of the time table in the other digest
+ * @param path: Path of the time tables
+ * @param changes: Vector to append all differences to
+ */
+void SpecDigest::
+diffTimeTables(int index, const SpecDigest& other, int otherIndex, const std::string& path, std::vector<SpecChange>& changes) const
+{
+	int i = this->nodes[index].first, end = i + this->nodes[index].count;
+	int j = other.nodes[otherIndex].first, otherEnd = j + other.nodes[otherIndex].count;
+	while(i < end || j < otherEnd)
+	{
+		SpecChange change;
+		if(j == otherEnd || (i < end && this->nodes[i].time < other.nodes[j].time))
+		{
+			change.path = this->childPath(index, path, i);
+			change.before = this->nodes[i++].value;
+		}
+		else if(i == end || other.nodes[j].time < this->nodes[i].time)
+		{
+			change.path = other.childPath(otherIndex, path, j);
+			change.after = other.nodes[j++].value;
+		}
+		else
+		{
+			change.path = this->childPath(index, path, i);
+			change.before = this->nodes[i++].value;
+			change.after = other.nodes[j++].value;
+			if(change.before == change.after)
+				continue;
+		}
+		changes.push_back(change);
+	}
+}
+
+/**
+ * Report all leaves of a subtree as added or removed
+ *
+ * @param index: Index of the subtree
+ * @param path: Path of the subtree
+ * @param removed: Whether the subtree was removed (else added)
+ * @param changes: Vector to append the differences to
+ */
+void SpecDigest::
+collect(int index, const std::string& path, bool removed, std::vector<SpecChange>& changes) const
+{
+	const SpecDigestNode& node = this->nodes[index];
+	if(node.first < 0)
+	{
+		SpecChange change;
+		change.path = path;
+		(removed ? change.before : change.after) = node.value;
+		changes.push_back(change);
+		return;
+	}
+	for(int i=node.first; i<node.first+node.count; i++)
+		this->collect(i, this->childPath(index, path, i), removed, changes);
+}
+
+/**
+ * Path of a child
+ *
+ * @param parent: Index of the parent
+ * @param path: Path of the parent
+ * @param index: Index of the child
+ * @return "path.key", "path[key]" for arrays or "path[t=time]" for rows of time tables
+ */
+std::string SpecDigest::
+childPath(int parent, const std::string& path, int index) const
+{
+	if(this->nodes[parent].isTimeTable)
+		return path + "[t=" + formatSpecNumber(this->nodes[index].time) + "]";
+	if(this->nodes[parent].isArray)
+		return path + "[" + this->nodes[index].key + "]";
+	return path.empty() ? this->nodes[index].key : path + "." + this->nodes[index].key;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "spec_tree.h"
+#include <string>
+#include <vector>
+
+/**
+ * Class to represent one node of a SpecDigest
+ *
+ * Leaves are parameters, arrays of leaves (e.g. {"simpleTwoStage"})
+ * and the rows of time tables. The children of a node are stored
+ * one after another, the elements of tables sorted by their key.
+ *
+ * @param key: Plain key of the node
+ * @param value: Normalized value of a leaf (see SpecNode::normalizedValue())
+ * @param hash: Hash of the key and the value or, for tables, of the key and all children
+ * @param time: Time of a row of a time table
+ * @param first: Index of the first child (-1 for leaves)
+ * @param count: Number of children
+ * @param isArray: Whether the children are positional elements
+ * @param isTimeTable: Whether the children are the rows of a time table
+ */
+class SpecDigestNode {
+	public:
+		SpecDigestNode(){};
+
+		std::string key = "";
+		std::string value = "";
+		unsigned long long hash = 0;
+		double time = 0.0;
+		int first = -1;
+		int count = 0;
+		bool isArray = false;
+		bool isTimeTable = false;
+};
+
+/**
+ * Class to represent one difference of two specifications
+ *
+ * @param path: Path of the parameter, e.g. "problem.feeding.drymass",
+ *              "problem.reactionSetup.activeReactions" or, for a row of a
+ *              time table, "problem.feeding.timetable[t=24]"
+ * @param before: Value in the first specification ("" if added)
+ * @param after: Value in the second specification ("" if removed)
+ */
+class SpecChange {
+	public:
+		SpecChange(){};
+
+		std::string path = "";
+		std::string before = "";
+		std::string after = "";
+};
+
+/**
+ * Class to hold a hash tree (Merkle tree) of a specification
+ *
+ * Every node holds the hash of its whole subtree, so two digests are
+ * compared by descending only into subtrees whose hashes differ.
+ * Equal specifications are recognized by the hash of the root alone.
+ * The hashes do not depend on whitespaces, comments, the order of
+ * the parameters or the notation of numbers.
+ *
+ * Rows of time tables are matched by their time, so an inserted row
+ * is reported as one added row and not as a change of all rows
+ * behind it.
+ *
+ * @param nodes: All nodes, the root first
+ */
+class SpecDigest {
+	public:
+		SpecDigest(){};
+
+		std::vector<SpecDigestNode> nodes;
+
+		void build(const SpecTree&);
+		bool load(const std::string&);
+		unsigned long long hash() const;
+		void diff(const SpecDigest&, std::vector<SpecChange>&) const;
+
+	private:
+		void fill(int, const SpecNode&);
+		void diffNodes(int, const SpecDigest&, int, const std::string&, std::vector<SpecChange>&) const;
+		void diffTimeTables(int, const SpecDigest&, int, const std::string&, std::vector<SpecChange>&) const;
+		void collect(int, const std::string&, bool, std::vector<SpecChange>&) const;
+		std::string childPath(int, const std::string&, int) const;
+};
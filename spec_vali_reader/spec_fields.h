@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include "spec_tree.h"
+#include "time_table.h"
+#include <string>
+#include <vector>
+#include <cmath>
+
+/**
+ * Helpers for the parsers generated by biogas_spec_codegen
+ *
+ * Every helper reads one parameter of a parsed specification into a
+ * typed field. A parameter missing in the specification keeps its
+ * default, a parameter of the wrong type returns false.
+ */
+
+/**
+ * Class to hold a time table of a generated specification struct
+ *
+ * @param time: The times of all rows
+ * @param value: The values of all rows
+ */
+struct SpecTimeTable {
+	std::vector<double> time;
+	std::vector<double> value;
+};
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, double& field)
+{
+	const SpecNode* node = tree.find(path);
+	return node == nullptr || (!node->isTable && parseSpecNumber(node->value, field));
+}
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, int& field)
+{
+	const SpecNode* node = tree.find(path);
+	double value;
+	if(node == nullptr)
+		return true;
+	if(node->isTable || !parseSpecNumber(node->value, value) || value != std::floor(value))
+		return false;
+	field = (int) value;
+	return true;
+}
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, bool& field)
+{
+	const SpecNode* node = tree.find(path);
+	if(node == nullptr)
+		return true;
+	if(node->value != "true" && node->value != "false")
+		return false;
+	field = node->value == "true";
+	return true;
+}
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, std::string& field)
+{
+	const SpecNode* node = tree.find(path);
+	if(node == nullptr)
+		return true;
+	if(node->isTable || node->value.size() < 2 || node->value.front() != '"' || node->value.back() != '"')
+		return false;
+	field = node->value.substr(1, node->value.size()-2);
+	return true;
+}
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, std::vector<std::string>& field)
+{
+	const SpecNode* node = tree.find(path);
+	if(node == nullptr)
+		return true;
+	if(!node->isArray())
+		return false;
+	field.resize(node->children.size());
+	for(std::size_t i=0; i<node->children.size(); i++)
+	{
+		const std::string& value = node->children[i].value;
+		if(value.size() < 2 || value.front() != '"' || value.back() != '"')
+			return false;
+		field[i] = value.substr(1, value.size()-2);
+	}
+	return true;
+}
+
+inline bool parseSpecField(const SpecTree& tree, const char* path, SpecTimeTable& field)
+{
+	const SpecNode* node = tree.find(path);
+	if(node == nullptr)
+		return true;
+	if(!node->isTimeTable())
+		return false;
+	field.time.resize(node->children.size());
+	field.value.resize(node->children.size());
+	for(std::size_t i=0; i<node->children.size(); i++)
+	{
+		parseSpecNumber(node->children[i].children[0].value, field.time[i]);
+		parseSpecNumber(node->children[i].children[1].value, field.value[i]);
+	}
+	return true;
+}
+
+/**
+ * Check the range of a parameter of a generated specification struct
+ *
+ * @param value: The value
+ * @param min: Minimum of the range
+ * @param max: Maximum of the range
+ * @param name: Name of the parameter
+ * @param message: Message to append a "Range ERROR" to
+ * @return Bool if the value is in range
+ */
+inline bool checkSpecRange(double value, double min, double max, const char* name, std::string& message)
+{
+	if(value >= min && value <= max)
+		return true;
+	message += std::string("Range ERROR: ") + name + " should be in Range {"
+		+ formatSpecNumber(min) + "," + formatSpecNumber(max) + "}\n";
+	return false;
+}
+
+/**
+ * Check the order of a time table of a generated specification struct
+ *
+ * @param table: The time table
+ * @param name: Name of the time table
+ * @param message: Message to append an "Order ERROR" to
+ * @return Bool if the times are increasing
+ */
+inline bool checkSpecTimeTable(const SpecTimeTable& table, const char* name, std::string& message)
+{
+	for(std::size_t i=1; i<table.time.size(); i++)
+	{
+		if(table.time[i] <= table.time[i-1])
+		{
+			message += std::string("Order ERROR: ") + name + " row " + std::to_string(i+1)
+				+ " should have a larger time than the previous row\n";
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "spec_history.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+
+/**
+ * Start a new history
+ *
+ * Removes all versions. The first version holds the given values,
+ * row i is row i of the original entries.
+ *
+ * @param values: Specification of all rows
+ */
+void SpecHistory::
+reset(const std::vector<std::string>& values)
+{
+	this->chunks = {};
+	this->count = 0;
+	this->current = -1;
+	this->commit(this->build(values, 0, (int) values.size(), std::numeric_limits<uint32_t>::max(), -1), "loaded");
+}
+
+/**
+ * Change the values of some rows
+ *
+ * @param changes: Index and new value of the changed rows
+ * @param label: Description of the edit
+ * @return The new version (the current one if nothing changed)
+ */
+int SpecHistory::
+setValues(const std::vector<std::pair<int, std::string>>& changes, std::string label)
+{
+	if(changes.empty() || this->current < 0)
+		return this->current;
+
+	NodePtr root = this->version(this->current).root;
+	for(const std::pair<int, std::string>& change : changes)
+	{
+		if(change.first < 0 || change.first >= this->rows(this->current))
+			return -1;
+		root = this->set(root, change.first, change.second);
+	}
+	return this->commit(root, label);
+}
+
+/**
+ * Replace a range of rows (e.g. the rows of a time table)
+ *
+ * The new rows are copies of the first replaced row (or of the row
+ * before, if no row is replaced).
+ *
+ * @param position: Index of the first replaced row
+ * @param count: Number of replaced rows
+ * @param values: Specification of the new rows
+ * @param label: Description of the edit
+ * @return The new version or -1 for an invalid range
+ */
+int SpecHistory::
+replaceRows(int position, int count, const std::vector<std::string>& values, std::string label)
+{
+	int n = (this->current < 0) ? 0 : this->rows(this->current);
+	if(position < 0 || count < 0 || position+count > n || n == 0)
+		return -1;
+
+	int base = this->base(this->current, (position < n) ? position : n-1);
+	NodePtr before, range, after;
+	this->split(this->version(this->current).root, position, before, range);
+	this->split(range, count, range, after);
+	range = this->build(values, 0, (int) values.size(), std::numeric_limits<uint32_t>::max(), base);
+	return this->commit(this->merge(this->merge(before, range), after), label);
+}
+
+/**
+ * Make a version the current one
+ *
+ * @param version: The version
+ * @return Bool if the version exists
+ */
+bool SpecHistory::
+checkout(int version)
+{
+	if(version < 0 || version >= this->size())
+		return false;
+	this->current = version;
+	return true;
+}
+
+/**
+ * Go back to the version the current one was derived from
+ *
+ * @return The new current version or -1 if there is nothing to undo
+ */
+int SpecHistory::
+undo()
+{
+	if(this->current < 0 || this->version(this->current).parent < 0)
+		return -1;
+	int parent = this->version(this->current).parent;
+	this->ownVersion(parent).redo = this->current;
+	this->current = parent;
+	return this->current;
+}
+
+/**
+ * Go to the version of the last undo (or the last edit) of the current one
+ *
+ * @return The new current version or -1 if there is nothing to redo
+ */
+int SpecHistory::
+redo()
+{
+	if(this->current < 0 || this->version(this->current).redo < 0)
+		return -1;
+	this->current = this->version(this->current).redo;
+	return this->current;
+}
+
+/**
+ * Number of rows of a version
+ *
+ * @param version: The version
+ * @return Number of rows
+ */
+int SpecHistory::
+rows(int version) const
+{
+	const NodePtr& root = this->version(version).root;
+	return root ? root->size : 0;
+}
+
+/**
+ * Getter method for the specification of a row
+ *
+ * @param version: The version
+ * @param index: Index of the row
+ * @return The specification
+ */
+const std::string& SpecHistory::
+value(int version, int index) const
+{
+	return this->find(this->version(version).root, index)->value;
+}
+
+/**
+ * Getter method for the original row of a row
+ *
+ * @param version: The version
+ * @param index: Index of the row
+ * @return Index of the row in the entries the history started with
+ */
+int SpecHistory::
+base(int version, int index) const
+{
+	return this->find(this->version(version).root, index)->base;
+}
+
+/**
+ * Write all rows of a version into two arrays
+ *
+ * @param version: The version
+ * @param values: Specification of the rows
+ * @param bases: Original row of the rows (see "base()")
+ */
+void SpecHistory::
+flatten(int version, std::vector<std::string>& values, std::vector<int>& bases) const
+{
+	values = {};
+	bases = {};
+	values.reserve(this->rows(version));
+	bases.reserve(this->rows(version));
+
+	std::vector<const SpecHistoryNode*> stack = {};
+	const SpecHistoryNode* node = this->version(version).root.get();
+	while(node != nullptr || !stack.empty())
+	{
+		while(node != nullptr)
+		{
+			stack.push_back(node);
+			node = node->left.get();
+		}
+		node = stack.back();
+		stack.pop_back();
+		values.push_back(node->value);
+		bases.push_back(node->base);
+		node = node->right.get();
+	}
+}
+
+/**
+ * Rows which differ between two versions
+ *
+ * Subtrees shared by both versions are skipped, so two versions which
+ * differ in k rows (at the same positions) are compared in O(k log n).
+ *
+ * @param from: The first version
+ * @param to: The second version
+ * @param rows: Indices of the rows whose value or original row differ
+ * @return Bool if both versions have the same number of rows
+ */
+bool SpecHistory::
+diff(int from, int to, std::vector<int>& rows) const
+{
+	rows = {};
+	if(this->rows(from) != this->rows(to))
+		return false;
+	this->diff(this->version(from).root, this->version(to).root, 0, rows);
+	return true;
+}
+
+/**
+ * List all versions
+ *
+ * @return One line "version\tparent\tcurrent\tlabel" per version
+ * (current is 1 for the current version)
+ */
+std::string SpecHistory::
+toString() const
+{
+	std::string list = "";
+	for(int i=0; i<this->size(); i++)
+	{
+		list += std::to_string(i) + "\t" + std::to_string(this->version(i).parent) + "\t"
+			+ (i == this->current ? "1" : "0") + "\t" + this->version(i).label + "\n";
+	}
+	return list;
+}
+
+/**
+ * Getter method for a version
+ *
+ * @param version: The version
+ * @return The version
+ */
+const SpecVersion& SpecHistory::
+version(int version) const
+{
+	return (*this->chunks[version/chunkSize])[version%chunkSize];
+}
+
+/**
+ * A version of this copy alone (its chunk is copied if it is shared)
+ *
+ * @param version: The version
+ * @return The version
+ */
+SpecVersion& SpecHistory::
+ownVersion(int version)
+{
+	std::shared_ptr<std::vector<SpecVersion>>& chunk = this->chunks[version/chunkSize];
+	if(chunk.use_count() > 1)
+		chunk = std::make_shared<std::vector<SpecVersion>>(*chunk);
+	return (*chunk)[version%chunkSize];
+}
+
+/**
+ * Add a version derived from the current one
+ *
+ * @param root: Rows of the version
+ * @param label: Description of the edit
+ * @return The new (current) version
+ */
+int SpecHistory::
+commit(NodePtr root, std::string label)
+{
+	SpecVersion version;
+	version.root = root;
+	version.parent = this->current;
+	version.label = label;
+
+	int index = this->count;
+	if(index % chunkSize == 0)
+	{
+		this->chunks.push_back(std::make_shared<std::vector<SpecVersion>>());
+		this->chunks.back()->reserve(chunkSize);
+	}
+	else if(this->chunks.back().use_count() > 1)
+		this->chunks.back() = std::make_shared<std::vector<SpecVersion>>(*this->chunks.back());
+	this->chunks.back()->push_back(version);
+	++this->count;
+
+	if(this->current >= 0)
+		this->ownVersion(this->current).redo = index;
+	this->current = index;
+	return index;
+}
+
+/**
+ * Next priority of the treap (xorshift)
+ */
+uint32_t SpecHistory::
+nextPriority()
+{
+	this->seed ^= this->seed << 13;
+	this->seed ^= this->seed >> 17;
+	this->seed ^= this->seed << 5;
+	return this->seed;
+}
+
+/**
+ * Build a balanced subtree of rows
+ *
+ * @param values: Specification of the rows
+ * @param begin: First row of the subtree
+ * @param end: Behind the last row of the subtree
+ * @param maxPriority: Upper bound of the priorities (priority of the parent)
+ * @param base: Original row of all rows (-1: the index in "values")
+ * @return Root of the subtree
+ */
+SpecHistory::NodePtr SpecHistory::
+build(const std::vector<std::string>& values, int begin, int end, uint32_t maxPriority, int base)
+{
+	if(begin >= end)
+		return nullptr;
+
+	int mid = begin + (end-begin)/2;
+	SpecHistoryNode row;
+	row.value = values[mid];
+	row.base = (base < 0) ? mid : base;
+	row.priority = (maxPriority == 0) ? 0 : this->nextPriority() % maxPriority;
+	NodePtr left = this->build(values, begin, mid, row.priority, base);
+	NodePtr right = this->build(values, mid+1, end, row.priority, base);
+	return this->node(row, left, right);
+}
+
+/**
+ * Create a node
+ *
+ * @param row: Value, original row and priority of the node
+ * @param left: Rows before the node
+ * @param right: Rows after the node
+ * @return The node
+ */
+SpecHistory::NodePtr SpecHistory::
+node(const SpecHistoryNode& row, NodePtr left, NodePtr right) const
+{
+	std::shared_ptr<SpecHistoryNode> node = std::make_shared<SpecHistoryNode>(row);
+	node->size = 1 + (left ? left->size : 0) + (right ? right->size : 0);
+	node->left = left;
+	node->right = right;
+	return node;
+}
+
+/**
+ * Find a row
+ *
+ * @param root: Root of the rows
+ * @param index: Index of the row
+ * @return The row
+ */
+const SpecHistoryNode* SpecHistory::
+find(NodePtr root, int index) const
+{
+	const SpecHistoryNode* node = root.get();
+	while(true)
+	{
+		int leftSize = node->left ? node->left->size : 0;
+		if(index == leftSize)
+			return node;
+		if(index < leftSize)
+			node = node->left.get();
+		else
+		{
+			index -= leftSize + 1;
+			node = node->right.get();
+		}
+	}
+}
+
+/**
+ * Rows which differ between two subtrees with the same number of rows
+ *
+ * Subtrees with the same shape are compared node by node, otherwise
+ * row by row.
+ *
+ * @param first: Root of the first rows
+ * @param second: Root of the second rows
+ * @param offset: Index of the first row of the subtrees
+ * @param rows: Indices of the differing rows (appended in order)
+ */
+void SpecHistory::
+diff(NodePtr first, NodePtr second, int offset, std::vector<int>& rows) const
+{
+	if(first == second)
+		return;
+
+	int leftSize = first->left ? first->left->size : 0;
+	if(leftSize != (second->left ? second->left->size : 0))
+	{
+		for(int i=0; i<first->size; i++)
+		{
+			const SpecHistoryNode* a = this->find(first, i);
+			const SpecHistoryNode* b = this->find(second, i);
+			if(a->value != b->value || a->base != b->base)
+				rows.push_back(offset+i);
+		}
+		return;
+	}
+
+	this->diff(first->left, second->left, offset, rows);
+	if(first->value != second->value || first->base != second->base)
+		rows.push_back(offset+leftSize);
+	this->diff(first->right, second->right, offset+leftSize+1, rows);
+}
+
+/**
+ * Change the value of a row
+ *
+ * Copies the nodes on the path to the row.
+ *
+ * @param root: Root of the rows
+ * @param index: Index of the row
+ * @param value: The new value
+ * @return Root of the changed rows
+ */
+SpecHistory::NodePtr SpecHistory::
+set(NodePtr root, int index, const std::string& value) const
+{
+	int leftSize = root->left ? root->left->size : 0;
+	if(index < leftSize)
+		return this->node(*root, this->set(root->left, index, value), root->right);
+	if(index > leftSize)
+		return this->node(*root, root->left, this->set(root->right, index-leftSize-1, value));
+
+	SpecHistoryNode row = *root;
+	row.value = value;
+	return this->node(row, root->left, root->right);
+}
+
+/**
+ * Split rows into the first "count" rows and the rest
+ *
+ * @param root: Root of the rows
+ * @param count: Number of rows of the first part
+ * @param first: Root of the first part
+ * @param rest: Root of the rest
+ */
+void SpecHistory::
+split(NodePtr root, int count, NodePtr& first, NodePtr& rest) const
+{
+	if(!root)
+	{
+		first = nullptr;
+		rest = nullptr;
+		return;
+	}
+
+	int leftSize = root->left ? root->left->size : 0;
+	if(count <= leftSize)
+	{
+		NodePtr left;
+		this->split(root->left, count, first, left);
+		rest = this->node(*root, left, root->right);
+	}
+	else
+	{
+		NodePtr right;
+		this->split(root->right, count-leftSize-1, right, rest);
+		first = this->node(*root, root->left, right);
+	}
+}
+
+/**
+ * Concatenate two sequences of rows
+ *
+ * @param first: Root of the first rows
+ * @param second: Root of the rows behind
+ * @return Root of all rows
+ */
+SpecHistory::NodePtr SpecHistory::
+merge(NodePtr first, NodePtr second) const
+{
+	if(!first)
+		return second;
+	if(!second)
+		return first;
+	if(first->priority >= second->priority)
+		return this->node(*first, first->left, this->merge(first->right, second));
+	return this->node(*second, this->merge(first, second->left), second->right);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+/**
+ * Class to represent one row of a version in a SpecHistory
+ *
+ * Nodes form an implicit treap (ordered by position, heap ordered
+ * by priority) and are never changed once created, so all versions
+ * share the nodes they have in common.
+ *
+ * @param value: Specification of the row
+ * @param base: Index of the row in the entries the history started with
+ * @param priority: Heap priority of the treap
+ * @param size: Number of rows in this subtree
+ * @param left: Rows before this one
+ * @param right: Rows after this one
+ */
+class SpecHistoryNode {
+	public:
+		SpecHistoryNode(){};
+
+		std::string value = "";
+		int base = 0;
+		uint32_t priority = 0;
+		int size = 1;
+		std::shared_ptr<const SpecHistoryNode> left;
+		std::shared_ptr<const SpecHistoryNode> right;
+};
+
+/**
+ * Class to represent one version of a SpecHistory
+ *
+ * @param root: Root of the rows
+ * @param parent: Version the edit was applied to (-1 for the first version)
+ * @param redo: Version "redo()" returns to (-1 for none)
+ * @param label: Description of the edit
+ */
+class SpecVersion {
+	public:
+		SpecVersion(){};
+
+		std::shared_ptr<const SpecHistoryNode> root;
+		int parent = -1;
+		int redo = -1;
+		std::string label = "";
+};
+
+/**
+ * Class to hold the edit history of a specification
+ *
+ * Every version is a persistent sequence of the specification values
+ * of all rows of "entries". An edit copies only the O(log n) nodes on
+ * the path to the changed rows, all other nodes are shared with the
+ * previous version. Time table rows can be inserted and removed, each
+ * row remembers which row of the original entries it was copied from.
+ *
+ * Versions form a tree: an edit after an undo starts a new branch, the
+ * undone versions stay reachable with "checkout()".
+ *
+ * The versions are stored in chunks of "chunkSize", copies of the
+ * history share the chunks until one of them changes a version of the
+ * chunk. Copying the history for an edit copies only the chunk pointers
+ * and the last chunk.
+ *
+ * @param chunks: All versions, the initial one first
+ * @param count: Number of versions
+ * @param current: The current version
+ * @param seed: State of the generator for the priorities
+ */
+class SpecHistory {
+	public:
+		SpecHistory(){};
+
+		typedef std::shared_ptr<const SpecHistoryNode> NodePtr;
+
+		void reset(const std::vector<std::string>&);
+		int setValues(const std::vector<std::pair<int, std::string>>&, std::string);
+		int replaceRows(int, int, const std::vector<std::string>&, std::string);
+		bool checkout(int);
+		int undo();
+		int redo();
+		int size() const { return this->count; }
+		int position() const { return this->current; }
+		int rows(int) const;
+		const std::string& value(int, int) const;
+		int base(int, int) const;
+		void flatten(int, std::vector<std::string>&, std::vector<int>&) const;
+		bool diff(int, int, std::vector<int>&) const;
+		std::string toString() const;
+
+	private:
+		static const int chunkSize = 64;
+
+		std::vector<std::shared_ptr<std::vector<SpecVersion>>> chunks;
+		int count = 0;
+		int current = -1;
+		uint32_t seed = 2463534242u;
+
+		const SpecVersion& version(int) const;
+		SpecVersion& ownVersion(int);
+		int commit(NodePtr, std::string);
+		uint32_t nextPriority();
+		NodePtr build(const std::vector<std::string>&, int, int, uint32_t, int);
+		NodePtr node(const SpecHistoryNode&, NodePtr, NodePtr) const;
+		const SpecHistoryNode* find(NodePtr, int) const;
+		void diff(NodePtr, NodePtr, int, std::vector<int>&) const;
+		NodePtr set(NodePtr, int, const std::string&) const;
+		void split(NodePtr, int, NodePtr&, NodePtr&) const;
+		NodePtr merge(NodePtr, NodePtr) const;
+};
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "spec_tree.h"
+#include "time_table.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+
+/**
+ * Find a direct child by its key
+ *
+ * @param key: The plain key
+ * @return The child or nullptr
+ */
+const SpecNode* SpecNode::
+child(const std::string& key) const
+{
+	for(const SpecNode& node : this->children)
+		if(node.key == key)
+			return &node;
+	return nullptr;
+}
+
+/**
+ * Whether the node is a table with positional elements only
+ *
+ * Arrays like {"simpleTwoStage"} or a time table {{0,243},{24,243}}
+ * are handled as one value.
+ *
+ * @return Bool if the node is an array
+ */
+bool SpecNode::
+isArray() const
+{
+	if(!this->isTable)
+		return false;
+	for(std::size_t i=0; i<this->children.size(); i++)
+		if(this->children[i].key != std::to_string(i+1))
+			return false;
+	return true;
+}
+
+/**
+ * Whether the node is a time table {{t,v},{t,v},...}
+ *
+ * @return Bool if all elements are pairs of numbers
+ */
+bool SpecNode::
+isTimeTable() const
+{
+	if(!this->isArray() || this->children.empty())
+		return false;
+	double number;
+	for(const SpecNode& row : this->children)
+	{
+		if(!row.isArray() || row.children.size() != 2
+				|| !parseSpecNumber(row.children[0].value, number)
+				|| !parseSpecNumber(row.children[1].value, number))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Normalized value of the node
+ *
+ * Numbers are evaluated (e.g. "10*243" -> "2430", "1.50" -> "1.5"),
+ * other values are kept. Arrays keep their order, the elements of
+ * other tables are sorted by their key.
+ *
+ * @return The normalized value
+ */
+std::string SpecNode::
+normalizedValue() const
+{
+	if(!this->isTable)
+	{
+		double number;
+		if(parseSpecNumber(this->value, number))
+			return formatSpecNumber(number);
+		return this->value;
+	}
+
+	std::string result = "{";
+	if(this->isArray())
+	{
+		for(std::size_t i=0; i<this->children.size(); i++)
+			result += (i>0 ? "," : "") + this->children[i].normalizedValue();
+	}
+	else
+	{
+		std::vector<const SpecNode*> sorted;
+		for(const SpecNode& node : this->children)
+			sorted.push_back(&node);
+		std::sort(sorted.begin(), sorted.end(),
+			[](const SpecNode* a, const SpecNode* b) { return a->key < b->key; });
+		for(std::size_t i=0; i<sorted.size(); i++)
+			result += (i>0 ? "," : "") + sorted[i]->key + "=" + sorted[i]->normalizedValue();
+	}
+	return result + "}";
+}
+
+/**
+ * Write the node as LUA
+ *
+ * Tables are written with one element per line, except arrays
+ * of leafs and the rows of time tables (e.g. {0,243}).
+ *
+ * @param output: String to append to
+ * @param indent: Number of tabs in front of the node
+ */
+void SpecNode::
+write(std::string& output, int indent) const
+{
+	output.append(indent, '\t');
+	if(!this->key.empty() && (this->key[0] < '0' || this->key[0] > '9'))
+	{
+		bool identifier = true;
+		for(char c : this->key)
+			identifier = identifier && (isalnum(c) || c == '_');
+		output += identifier ? this->key + " = " : "[\"" + this->key + "\"] = ";
+	}
+
+	if(!this->isTable)
+	{
+		output += this->value;
+		return;
+	}
+
+	bool inline_ = this->isArray();
+	for(const SpecNode& node : this->children)
+		inline_ = inline_ && !node.isTable;
+	if(inline_)
+	{
+		output += "{";
+		for(std::size_t i=0; i<this->children.size(); i++)
+			output += (i>0 ? ", " : "") + this->children[i].value;
+		output += "}";
+		return;
+	}
+
+	output += "{\n";
+	for(const SpecNode& node : this->children)
+	{
+		node.write(output, indent+1);
+		output += ",\n";
+	}
+	output.append(indent, '\t');
+	output += "}";
+}
+
+/**
+ * Parse a specification
+ *
+ * Every top level assignment "name={...}" becomes a child of "root".
+ *
+ * @param input: The specification without comments and whitespaces
+ * @return Bool if the input could be parsed
+ */
+bool SpecTree::
+parse(const std::string& input)
+{
+	this->root = SpecNode();
+	this->root.isTable = true;
+
+	std::string::size_type pos = 0;
+	int position = 0;
+	while(pos < input.size())
+	{
+		if(input[pos] == ',' || input[pos] == ';')
+		{
+			++pos;
+			continue;
+		}
+		if(!this->parseField(input, pos, this->root, ++position))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Parse a table "{...}"
+ *
+ * @param input: The specification
+ * @param pos: Position of the '{', afterwards behind the '}'
+ * @param node: The node to fill
+ * @return Bool if the table could be parsed
+ */
+bool SpecTree::
+parseTable(const std::string& input, std::string::size_type& pos, SpecNode& node)
+{
+	node.isTable = true;
+	++pos;
+	int position = 0;
+	while(pos < input.size() && input[pos] != '}')
+	{
+		if(!this->parseField(input, pos, node, ++position))
+			return false;
+		if(pos < input.size() && (input[pos] == ',' || input[pos] == ';'))
+			++pos;
+	}
+	if(pos >= input.size())
+		return false;
+	++pos;
+	return true;
+}
+
+/**
+ * Parse one field "key=value", "[\"key\"]=value" or "value"
+ *
+ * @param input: The specification
+ * @param pos: Start of the field, afterwards behind the value
+ * @param parent: The table the field belongs to
+ * @param position: Position of the field (key of positional fields)
+ * @return Bool if the field could be parsed
+ */
+bool SpecTree::
+parseField(const std::string& input, std::string::size_type& pos, SpecNode& parent, int position)
+{
+	SpecNode node;
+	node.key = std::to_string(position);
+
+	if(input[pos] == '[')
+	{
+		std::string::size_type end = input.find("]=", pos);
+		if(end == std::string::npos)
+			return false;
+		node.key = plainSpecKey(input.substr(pos, end-pos+1));
+		pos = end+2;
+	}
+	else
+	{
+		std::string::size_type end = pos;
+		while(end < input.size() && (isalnum(input[end]) || input[end] == '_'))
+			++end;
+		if(end > pos && end < input.size() && input[end] == '=' && (end+1 >= input.size() || input[end+1] != '='))
+		{
+			node.key = input.substr(pos, end-pos);
+			pos = end+1;
+		}
+	}
+
+	if(pos >= input.size())
+		return false;
+
+	if(input[pos] == '{')
+	{
+		if(!this->parseTable(input, pos, node))
+			return false;
+	}
+	else
+	{
+		std::string::size_type start = pos;
+		bool quoted = false;
+		while(pos < input.size() && (quoted || (input[pos] != ',' && input[pos] != '}' && input[pos] != ';')))
+		{
+			if(input[pos] == '"')
+				quoted = !quoted;
+			++pos;
+		}
+		node.value = input.substr(start, pos-start);
+		if(node.value.empty())
+			return false;
+	}
+
+	parent.children.push_back(node);
+	return true;
+}
+
+/**
+ * Find a node by its path
+ *
+ * @param path: Keys delimited by '.', e.g. "problem.feeding.drymass"
+ * @return The node or nullptr
+ */
+const SpecNode* SpecTree::
+find(const std::string& path) const
+{
+	const SpecNode* node = &this->root;
+	std::string::size_type start = 0;
+	while(node != nullptr && start <= path.size())
+	{
+		std::string::size_type end = path.find('.', start);
+		if(end == std::string::npos)
+			end = path.size();
+		node = node->child(path.substr(start, end-start));
+		start = end+1;
+	}
+	return node;
+}
+
+/**
+ * Find a node by its path and create it if it does not exist
+ *
+ * Missing parents are created as tables.
+ *
+ * @param path: Keys delimited by '.', e.g. "problem.checkpoint.checkpointDir"
+ * @return The node
+ */
+SpecNode& SpecTree::
+insert(const std::string& path)
+{
+	SpecNode* node = &this->root;
+	std::string::size_type start = 0;
+	while(start <= path.size())
+	{
+		std::string::size_type end = path.find('.', start);
+		if(end == std::string::npos)
+			end = path.size();
+		std::string key = path.substr(start, end-start);
+
+		SpecNode* next = nullptr;
+		for(SpecNode& child : node->children)
+			if(child.key == key)
+				next = &child;
+		if(next == nullptr)
+		{
+			if(!node->isTable)
+			{
+				node->isTable = true;
+				node->value = "";
+			}
+			node->children.push_back(SpecNode());
+			next = &node->children.back();
+			next->key = key;
+		}
+		node = next;
+		start = end+1;
+	}
+	return *node;
+}
+
+/**
+ * Write the specification as LUA
+ *
+ * Comments and the formatting of the original file are not kept.
+ *
+ * @return The specification
+ */
+std::string SpecTree::
+write() const
+{
+	std::string output = "";
+	for(const SpecNode& node : this->root.children)
+	{
+		node.write(output, 0);
+		output += "\n\n";
+	}
+	return output;
+}
+
+/**
+ * Collect all parameters with their paths
+ *
+ * Leafs and arrays (e.g. time tables) are parameters,
+ * all other tables are folders.
+ *
+ * @param leaves: Map from path to node
+ */
+void SpecTree::
+collectLeaves(std::map<std::string, const SpecNode*>& leaves) const
+{
+	for(const SpecNode& node : this->root.children)
+		this->collectLeaves(node, "", leaves);
+}
+
+void SpecTree::
+collectLeaves(const SpecNode& node, const std::string& prefix, std::map<std::string, const SpecNode*>& leaves) const
+{
+	std::string path = prefix.empty() ? node.key : prefix + "." + node.key;
+	if(!node.isTable || node.isArray())
+	{
+		leaves[path] = &node;
+		return;
+	}
+	for(const SpecNode& child : node.children)
+		this->collectLeaves(child, path, leaves);
+}
+
+/**
+ * Read a validation/specification file
+ *
+ * Loads the file and removes all comments and whitespaces.
+ *
+ * @param filepath: The absolute path to the file
+ * @param input: The content of the file
+ * @return Bool if file could be read
+ */
+bool readSpecFile(const std::string& filepath, std::string& input)
+{
+	input = "";
+
+	std::ifstream LUATable(filepath);
+	if(!LUATable.good())
+	{
+		return false;
+	}
+
+	for(std::string line; getline(LUATable,line);)
+	{
+		line.erase(remove_if(line.begin(), line.end(), isspace), line.end());
+		std::string prefix("--");
+		if (line.compare(0, prefix.size(), prefix))
+		{
+			if(!line.empty())
+			{
+				if (line.find("--") != std::string::npos)
+				{
+					input += line.substr(0, line.find("--"));
+				}
+				else
+				{
+					input += line;
+				}		
+			}
+		}	
+	}
+	return true;
+}
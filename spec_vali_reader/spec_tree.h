@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * Class to represent one node of a parsed LUA table
+ *
+ * @param key: Name of the node (without brackets and quotes), positional elements are numbered from 1
+ * @param value: Value of a leaf as written in the file (e.g. "10*243", "\"CSTR\"")
+ * @param isTable: Whether the node is a table
+ * @param children: Elements of a table
+ */
+class SpecNode {
+	public:
+		SpecNode(){};
+
+		std::string key = "";
+		std::string value = "";
+		bool isTable = false;
+		std::vector<SpecNode> children;
+
+		const SpecNode* child(const std::string&) const;
+		bool isArray() const;
+		bool isTimeTable() const;
+		std::string normalizedValue() const;
+		void write(std::string&, int) const;
+};
+
+/**
+ * Class to hold a parsed specification file
+ *
+ * In contrast to the "entries" of the BiogasSpecValiReader, which
+ * follow the order of the validation file, the SpecTree keeps the
+ * structure of the specification itself, so parameters can be found
+ * by their path (e.g. "problem.numericalSetup.sim_endtime") no matter
+ * in which order they are written.
+ *
+ * The input is expected without comments and whitespaces, as
+ * produced by BiogasSpecValiReader::readInput().
+ *
+ * @param root: Table holding all top level assignments
+ */
+class SpecTree {
+	public:
+		SpecTree(){};
+
+		SpecNode root;
+
+		bool parse(const std::string&);
+		const SpecNode* find(const std::string&) const;
+		SpecNode& insert(const std::string&);
+		void collectLeaves(std::map<std::string, const SpecNode*>&) const;
+		std::string write() const;
+
+	private:
+		bool parseTable(const std::string&, std::string::size_type&, SpecNode&);
+		bool parseField(const std::string&, std::string::size_type&, SpecNode&, int);
+		void collectLeaves(const SpecNode&, const std::string&, std::map<std::string, const SpecNode*>&) const;
+};
+
+/**
+ * Remove brackets and quotes from a key (e.g. ["Lipids"] -> Lipids)
+ *
+ * @param key: The key as written in the file
+ * @return The plain key
+ */
+inline std::string plainSpecKey(std::string key)
+{
+	if(key.size() >= 2 && key.front() == '[' && key.back() == ']')
+		key = key.substr(1, key.size()-2);
+	if(key.size() >= 2 && key.front() == '"' && key.back() == '"')
+		key = key.substr(1, key.size()-2);
+	return key;
+}
+
+/**
+ * 64 bit FNV-1a hash of a string
+ *
+ * Stable over platforms and program runs, used to identify
+ * specifications and subtrees.
+ *
+ * @param str: The string
+ * @param hash: Start value (to chain several strings)
+ * @return The hash
+ */
+inline unsigned long long hashSpecString(const std::string& str, unsigned long long hash = 14695981039346656037ULL)
+{
+	for(unsigned char c : str)
+	{
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * Format a hash as 16 hexadecimal digits
+ *
+ * @param hash: The hash
+ * @return The hash as string
+ */
+inline std::string formatSpecHash(unsigned long long hash)
+{
+	static const char digits[] = "0123456789abcdef";
+	std::string result(16, '0');
+	for(int i=15; i>=0; i--)
+	{
+		result[i] = digits[hash & 15];
+		hash >>= 4;
+	}
+	return result;
+}
+
+bool readSpecFile(const std::string&, std::string&);
@@ -1,41 +1,218 @@
 /*
  * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
  * Author: Paul Zügel
- * 
- * 
+ *
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
  * GNU Lesser General Public License for more details.
  */
 
+#pragma once
+#include "../common/string_pool.h"
+#include "time_table.h"
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <memory>
 
 /**
- * Class to represents one row in the LabView Tree structure
+ * Class to represent the rows of the LabView Tree structure
  *
  * Contains all information given by a validation and specification
- * file concerning one parameter.
+ * file, one column per field and one row per parameter. Names, types,
+ * defaults and ranges repeat a lot, they are stored once in a
+ * StringPool and the columns only hold their ids. The range is
+ * stored as numbers. Copies share the StringPool until one of them
+ * adds a string, and the specifications until one of them is changed.
  *
  * @param indent: The indentation in the tree structure
  * @param glyph: Visual symbol in the tree strucutre (e.g. a folder symbol)
- * @param leftCell: Name of the parameter
- * @param type: Data type of the parameter (e.g. int, string)
- * @param defaultVal: Default value given by the validation file
- * @param specVal: Specification of the parameter
- * @param rangeMin: Optional range minimum (onyl for validation)
- * @param rangeMax: Optional range maximum (onyl for validation)
+ * @param rangeMin: Optional range minimum (onyl for validation, NaN for none)
+ * @param rangeMax: Optional range maximum (onyl for validation, NaN for none)
+ *
+ * Interned columns (see the getter and setter methods):
+ * leftCell: Name of the parameter
+ * type: Data type of the parameter (e.g. int, string)
+ * defaultVal: Default value given by the validation file
+ *
+ * Shared column (see "spec()" and "setSpec()"):
+ * specVal: Specification of the parameter
  */
-class TableEntry { 
+class TableEntries {
 	public:
-		TableEntry(){};
-		
-		int indent = 0;
-		int glyph = 0;
-		std::string leftCell = "";
-		std::string type = "";
-		std::string defaultVal = "";
-		std::string specVal = "";
-		std::string rangeMin = "";
-		std::string rangeMax = "";
+		TableEntries(){};
+
+		std::vector<int16_t> indent;
+		std::vector<uint8_t> glyph;
+		std::vector<double> rangeMin;
+		std::vector<double> rangeMax;
+
+		/**
+		 * Number of rows
+		 */
+		int size() const { return (int) this->indent.size(); }
+
+		/**
+		 * Remove all rows and strings
+		 */
+		void clear() { *this = TableEntries(); }
+
+		/**
+		 * Append an empty row
+		 *
+		 * @param ind: The indentation of the row
+		 */
+		void add(int ind)
+		{
+			this->indent.push_back((int16_t) ind);
+			this->glyph.push_back(0);
+			this->ownSpecs().push_back("");
+			this->rangeMin.push_back(std::numeric_limits<double>::quiet_NaN());
+			this->rangeMax.push_back(std::numeric_limits<double>::quiet_NaN());
+			for(std::vector<uint32_t>* column : this->stringColumns())
+				column->push_back(0);
+		}
+
+		/**
+		 * Insert copies of a row
+		 *
+		 * @param position: Index of the first inserted row
+		 * @param count: Number of copies
+		 * @param row: Index of the copied row (before the insertion)
+		 */
+		void insertRows(int position, int count, int row)
+		{
+			int16_t ind = this->indent[row];
+			uint8_t gly = this->glyph[row];
+			std::string value = this->spec(row);
+			double min = this->rangeMin[row];
+			double max = this->rangeMax[row];
+			this->indent.insert(this->indent.begin()+position, count, ind);
+			this->glyph.insert(this->glyph.begin()+position, count, gly);
+			std::vector<std::string>& specs = this->ownSpecs();
+			specs.insert(specs.begin()+position, count, value);
+			this->rangeMin.insert(this->rangeMin.begin()+position, count, min);
+			this->rangeMax.insert(this->rangeMax.begin()+position, count, max);
+			for(std::vector<uint32_t>* column : this->stringColumns())
+			{
+				uint32_t id = (*column)[row];
+				column->insert(column->begin()+position, count, id);
+			}
+		}
+
+		/**
+		 * Remove the rows [first, last)
+		 */
+		void eraseRows(int first, int last)
+		{
+			this->indent.erase(this->indent.begin()+first, this->indent.begin()+last);
+			this->glyph.erase(this->glyph.begin()+first, this->glyph.begin()+last);
+			std::vector<std::string>& specs = this->ownSpecs();
+			specs.erase(specs.begin()+first, specs.begin()+last);
+			this->rangeMin.erase(this->rangeMin.begin()+first, this->rangeMin.begin()+last);
+			this->rangeMax.erase(this->rangeMax.begin()+first, this->rangeMax.begin()+last);
+			for(std::vector<uint32_t>* column : this->stringColumns())
+				column->erase(column->begin()+first, column->begin()+last);
+		}
+
+		/**
+		 * Keep only the given rows
+		 *
+		 * @param rows: Indices of the kept rows in their new order (may repeat)
+		 */
+		void selectRows(const std::vector<int>& rows)
+		{
+			TableEntries selected = *this;
+			this->indent = {};
+			this->glyph = {};
+			this->specVal = std::make_shared<std::vector<std::string>>();
+			this->rangeMin = {};
+			this->rangeMax = {};
+			for(std::vector<uint32_t>* column : this->stringColumns())
+				*column = {};
+			std::vector<std::vector<uint32_t>*> from = selected.stringColumns();
+			std::vector<std::vector<uint32_t>*> to = this->stringColumns();
+			for(int row : rows)
+			{
+				this->indent.push_back(selected.indent[row]);
+				this->glyph.push_back(selected.glyph[row]);
+				this->specVal->push_back(selected.spec(row));
+				this->rangeMin.push_back(selected.rangeMin[row]);
+				this->rangeMax.push_back(selected.rangeMax[row]);
+				for(std::size_t c=0; c<to.size(); c++)
+					to[c]->push_back((*from[c])[row]);
+			}
+		}
+
+		/**
+		 * Whether two rows only differ in their specification
+		 */
+		bool sameRow(int a, int b) const
+		{
+			return this->indent[a] == this->indent[b] && this->glyph[a] == this->glyph[b]
+				&& this->leftCellIds[a] == this->leftCellIds[b] && this->typeIds[a] == this->typeIds[b]
+				&& this->defaultValIds[a] == this->defaultValIds[b]
+				&& (this->rangeMin[a] == this->rangeMin[b] || (std::isnan(this->rangeMin[a]) && std::isnan(this->rangeMin[b])))
+				&& (this->rangeMax[a] == this->rangeMax[b] || (std::isnan(this->rangeMax[a]) && std::isnan(this->rangeMax[b])));
+		}
+
+		const std::string& leftCell(int i) const { return this->strings->get(this->leftCellIds[i]); }
+		const std::string& type(int i) const { return this->strings->get(this->typeIds[i]); }
+		const std::string& defaultVal(int i) const { return this->strings->get(this->defaultValIds[i]); }
+		const std::string& spec(int i) const { return (*this->specVal)[i]; }
+		const std::vector<std::string>& specs() const { return *this->specVal; }
+
+		void setLeftCell(int i, const std::string& value) { this->leftCellIds[i] = this->ownStrings().intern(value); }
+		void setType(int i, const std::string& value) { this->typeIds[i] = this->ownStrings().intern(value); }
+		void setDefaultVal(int i, const std::string& value) { this->defaultValIds[i] = this->ownStrings().intern(value); }
+		void setSpec(int i, const std::string& value) { this->ownSpecs()[i] = value; }
+		void setSpecs(const std::vector<std::string>& values) { this->specVal = std::make_shared<std::vector<std::string>>(values); }
+
+		/**
+		 * Whether a parameter has a range
+		 */
+		bool hasRange(int i) const { return !std::isnan(this->rangeMin[i]) && !std::isnan(this->rangeMax[i]); }
+
+		/**
+		 * Range bound as written for LabView
+		 *
+		 * @param bound: rangeMin[i] or rangeMax[i]
+		 * @return The number or "" if there is no range
+		 */
+		static std::string rangeText(double bound) { return std::isnan(bound) ? "" : formatSpecNumber(bound); }
+
+	private:
+		std::shared_ptr<StringPool> strings = std::make_shared<StringPool>();
+		std::shared_ptr<std::vector<std::string>> specVal = std::make_shared<std::vector<std::string>>();
+		std::vector<uint32_t> leftCellIds;
+		std::vector<uint32_t> typeIds;
+		std::vector<uint32_t> defaultValIds;
+
+		/**
+		 * The StringPool of this copy alone (copied if it is shared)
+		 */
+		StringPool& ownStrings()
+		{
+			if(this->strings.use_count() > 1)
+				this->strings = std::make_shared<StringPool>(*this->strings);
+			return *this->strings;
+		}
+
+		/**
+		 * The specifications of this copy alone (copied if they are shared)
+		 */
+		std::vector<std::string>& ownSpecs()
+		{
+			if(this->specVal.use_count() > 1)
+				this->specVal = std::make_shared<std::vector<std::string>>(*this->specVal);
+			return *this->specVal;
+		}
+
+		std::vector<std::vector<uint32_t>*> stringColumns()
+		{
+			return {&this->leftCellIds, &this->typeIds, &this->defaultValIds};
+		}
 };
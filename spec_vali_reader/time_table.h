@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Class to represent one time table of a specification (e.g. a feeding plan)
+ *
+ * Time tables are stored as two contiguous columns of doubles instead of
+ * one "{t,v}" string per row, so they can be imported, checked and written
+ * back in bulk.
+ *
+ * @param entryIndex: Index of the time table folder in the "entries" container
+ * @param firstRow: Index of the first "timeTableContent" row in "entries"
+ * @param time: Times of the table rows (first column)
+ * @param value: Values of the table rows (second column)
+ */
+class TimeTable {
+	public:
+		TimeTable(){};
+
+		int entryIndex = 0;
+		int firstRow = 0;
+		std::vector<double> time;
+		std::vector<double> value;
+
+		int size() const { return (int) this->time.size(); }
+};
+
+/**
+ * Parse a numerical value of a specification
+ *
+ * Values in specification files may be written as products,
+ * e.g. "10*243" or "4.23*1E-9". Every factor is parsed with
+ * strtod and the product is returned.
+ *
+ * @param str: The value as written in the specification
+ * @param result: The parsed value
+ * @return Bool if the string is a valid number
+ */
+inline bool parseSpecNumber(const std::string& str, double& result)
+{
+	if(str.empty())
+		return false;
+
+	result = 1.0;
+	const char* pos = str.c_str();
+	const char* end = pos + str.size();
+	while(pos < end)
+	{
+		char* factorEnd;
+		double factor = std::strtod(pos, &factorEnd);
+		if(factorEnd == pos)
+			return false;
+		result *= factor;
+		pos = factorEnd;
+		if(pos < end)
+		{
+			if(*pos != '*')
+				return false;
+			++pos;
+			if(pos == end)
+				return false;
+		}
+	}
+	return std::isfinite(result);
+}
+
+/**
+ * Parse one time table row of the form "{t,v}"
+ *
+ * @param str: The row as written in the specification
+ * @param t: The parsed time
+ * @param v: The parsed value
+ * @return Bool if the row is valid
+ */
+inline bool parseSpecTimeStamp(const std::string& str, double& t, double& v)
+{
+	if(str.size() < 5 || str.front() != '{' || str.back() != '}')
+		return false;
+
+	std::string::size_type comma = str.find(',');
+	if(comma == std::string::npos)
+		return false;
+
+	return parseSpecNumber(str.substr(1, comma-1), t)
+		&& parseSpecNumber(str.substr(comma+1, str.size()-comma-2), v);
+}
+
+/**
+ * Format a numerical value for a specification
+ *
+ * Uses the shortest representation (up to 17 digits) which
+ * reads back to the same double. The notation is the one the
+ * specification reader accepts: integral values up to 1E21 are
+ * written without exponent (so they stay valid for "Integer"
+ * parameters), exponents as "E" without "+" and leading zeros
+ * (e.g. "2.5E-7" instead of "2.5e-07").
+ *
+ * @param val: The value
+ * @return The value as string
+ */
+inline std::string formatSpecNumber(double val)
+{
+	char buffer[32];
+	if(val == std::floor(val) && std::fabs(val) < 1e21)
+	{
+		std::snprintf(buffer, sizeof(buffer), "%.0f", val + 0.0);
+		return buffer;
+	}
+
+	std::snprintf(buffer, sizeof(buffer), "%.15g", val);
+	if(std::strtod(buffer, nullptr) != val)
+		std::snprintf(buffer, sizeof(buffer), "%.17g", val);
+
+	std::string result = buffer;
+	std::string::size_type exponent = result.find('e');
+	if(exponent == std::string::npos)
+		return result;
+	std::string::size_type digits = exponent+1;
+	std::string sign = "";
+	if(result[digits] == '-')
+		sign = "-";
+	if(result[digits] == '-' || result[digits] == '+')
+		++digits;
+	while(digits+1 < result.size() && result[digits] == '0')
+		++digits;
+	return result.substr(0, exponent) + "E" + sign + result.substr(digits);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "../common/checkpoint_store.cpp"
+#include <string>
+#include <iostream>
+#include <cstdlib>
+
+/**
+ * Compressed storage of ug4 checkpoint series (see CheckpointStore)
+ *
+ *   biogas_checkpoint_store convert <dir> [-keyframe <n>] [-remove]
+ *   biogas_checkpoint_store list <store>
+ *   biogas_checkpoint_store restore <store> <id> <dir>
+ *
+ * "convert" adds the myCheckpoint*.ug4vec files of a directory to its
+ * store myCheckpoint.ug4store (every n-th checkpoint in full, default
+ * 16); "-remove" deletes the files once they are stored. "restore"
+ * writes myCheckpoint<id>.ug4vec and myCheckpoint.lua to restart ug4.
+ * Exit code: 0 on success, 1 if the store could not be read or
+ * written, 2 for wrong arguments.
+ */
+
+int main(int argc, char** argv)
+{
+	std::string command = argc > 1 ? argv[1] : "";
+	if(!((command == "convert" && argc >= 3) || (command == "list" && argc == 3)
+			|| (command == "restore" && argc == 5)))
+	{
+		std::cerr << "Usage: " << argv[0] << " convert <dir> [-keyframe <n>] [-remove]" << std::endl
+			<< "       " << argv[0] << " list <store>" << std::endl
+			<< "       " << argv[0] << " restore <store> <id> <dir>" << std::endl;
+		return 2;
+	}
+
+	CheckpointStore store;
+	if(command == "convert")
+	{
+		bool removeOriginals = false;
+		for(int i=3; i<argc; i++)
+		{
+			std::string arg = argv[i];
+			if(arg == "-remove")
+				removeOriginals = true;
+			else if(arg == "-keyframe" && i+1 < argc)
+				store.keyframeInterval = std::max(1, std::atoi(argv[++i]));
+			else
+			{
+				std::cerr << "Unknown argument " << arg << std::endl;
+				return 2;
+			}
+		}
+		int converted = store.convert(argv[2], removeOriginals);
+		if(converted < 0)
+		{
+			std::cerr << "Could not open the store in " << argv[2] << std::endl;
+			return 1;
+		}
+		std::cout << "Added " << converted << " checkpoints, " << store.records.size() << " stored in "
+			<< store.storedBytes() << " bytes (" << store.originalBytes() << " as .ug4vec)" << std::endl;
+		return 0;
+	}
+
+	if(!store.open(argv[2], store.keyframeInterval))
+	{
+		std::cerr << "Could not read the store " << argv[2] << std::endl;
+		return 1;
+	}
+
+	if(command == "list")
+	{
+		std::cout << "id\tvalues\tbytes\tkeyframe" << std::endl;
+		for(const CheckpointRecord& record : store.records)
+			std::cout << record.id << "\t" << record.size << "\t" << record.bytes << "\t"
+				<< (record.keyframe ? 1 : 0) << std::endl;
+		return 0;
+	}
+
+	int index = store.find(argv[3]);
+	if(index < 0)
+	{
+		std::cerr << "No checkpoint " << argv[3] << " in " << argv[2] << std::endl;
+		return 1;
+	}
+	if(!store.restore(index, argv[4]))
+	{
+		std::cerr << "Could not write the checkpoint to " << argv[4] << std::endl;
+		return 1;
+	}
+	return 0;
+}
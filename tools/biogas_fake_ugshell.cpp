@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "../spec_vali_reader/biogas_spec_vali_reader.cpp"
+#include "../common/shared_series.cpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <unistd.h>
+
+/**
+ * Synthetic stand-in for ugshell
+ *
+ * Behaves like "ugshell -ex Biogas.lua -p spec.lua" as seen from the
+ * outside, without solving anything: it writes problemSettings.lua,
+ * outputFiles.lua and the output files in the format of a real run
+ * into the current directory, one row per time step at a fixed rate,
+ * so live plotting, tailing and scheduling can be tested and
+ * benchmarked repeatably.
+ *
+ *   biogas_fake_ugshell -ex Biogas.lua -p spec.lua [options]
+ *
+ * Options:
+ *   -rate <rows/s>     Time steps per second (0: as fast as possible, default 10)
+ *   -dt <h>            Simulated time per step (default 0.2)
+ *   -series <n>        Number of columns of the additional file dbg_synthetic.txt (default 0)
+ *   -checkpoint <n>    Write a .ug4vec checkpoint every n steps (default 0: only at the end)
+ *   -vecsize <n>       Number of doubles per checkpoint (default 1024)
+ *   -chatter <n>       0: silent, 1: one line per step (default), n: n-1 solver lines per step
+ *   -shared <name>     Also publish all rows as shared series "name"
+ *
+ * The time span is taken from problem.numericalSetup of the
+ * specification (sim_starttime, sim_endtime). The values are smooth
+ * deterministic functions of the time, so two runs with the same
+ * arguments produce identical files.
+ */
+
+/**
+ * Class to describe one output file of the fake run
+ *
+ * @param key: Key in outputFiles.lua
+ * @param filename: Name of the output file
+ * @param columns: Names of the value columns (the time is column 1)
+ * @param units: Units of the value columns
+ * @param file: The opened file
+ */
+class FakeOutputFile {
+	public:
+		FakeOutputFile(){};
+
+		std::string key = "";
+		std::string filename = "";
+		std::vector<std::string> columns;
+		std::vector<std::string> units;
+		std::ofstream file;
+};
+
+/**
+ * Value of an argument ("-name value")
+ *
+ * @param argc: Number of arguments
+ * @param argv: The arguments
+ * @param name: Name of the argument (e.g. "-rate")
+ * @param fallback: Value if the argument is not given
+ * @return The value
+ */
+static std::string fakeParam(int argc, char** argv, const std::string& name, const std::string& fallback)
+{
+	for(int i=1; i+1<argc; i++)
+		if(name == argv[i])
+			return argv[i+1];
+	return fallback;
+}
+
+/**
+ * Number of a specification parameter
+ *
+ * @param tree: The specification
+ * @param path: Path of the parameter
+ * @param fallback: Value if the parameter is missing or not a number
+ * @return The value
+ */
+static double fakeSpecNumber(const SpecTree& tree, const std::string& path, double fallback)
+{
+	const SpecNode* node = tree.find(path);
+	double value;
+	if(node == nullptr || node->isTable || !parseSpecNumber(node->value, value))
+		return fallback;
+	return value;
+}
+
+/**
+ * Write outputFiles.lua in the format of Biogas.lua
+ *
+ * @param files: The output files
+ * @return Bool if the file could be written
+ */
+static bool writeFakeOutputFiles(const std::vector<FakeOutputFile*>& files)
+{
+	std::string output = "outputFiles = {\n";
+	for(std::size_t f=0; f<files.size(); f++)
+	{
+		const FakeOutputFile& info = *files[f];
+		output += "    " + info.key + "={\n";
+		output += "      filename=\"" + info.filename + "\",\n";
+		output += "      keys={\n        y={\n";
+		for(std::size_t c=0; c<info.columns.size(); c++)
+		{
+			output += "          " + info.columns[c] + "={\n";
+			output += "            unit=\"[" + info.units[c] + "]\",\n";
+			output += "            col=" + std::to_string(c+2) + "\n";
+			output += std::string("          }") + (c+1 < info.columns.size() ? "," : "") + "\n";
+		}
+		output += "        },\n        type=\"CSV\",\n        comment=\"#\",\n        delimiter=\"\\t\",\n";
+		output += "        x={\n          Time={\n            unit=\"[h]\",\n            col=1\n          }\n        }\n";
+		output += std::string("      }\n    }") + (f+1 < files.size() ? "," : "") + "\n";
+	}
+	output += "}\n";
+
+	std::ofstream file("outputFiles.lua");
+	file << output;
+	return file.good();
+}
+
+/**
+ * Write a checkpoint of the solution
+ *
+ * Writes "myCheckpoint<id>.ug4vec" (header: uint32 1, uint32 size of
+ * the file, uint64 number of doubles, followed by the doubles) and
+ * updates "myCheckpoint.lua" as ug4 does.
+ *
+ * @param id: Id of the checkpoint (step number or "SimulationEnd")
+ * @param time: Simulated time
+ * @param size: Number of doubles
+ * @param argc: Number of arguments of the fake run
+ * @param argv: The arguments
+ * @return Bool if the checkpoint could be written
+ */
+static bool writeFakeCheckpoint(const std::string& id, double time, uint64_t size, int argc, char** argv)
+{
+	std::string filename = "myCheckpoint" + id + ".ug4vec";
+	std::vector<double> values(size);
+	for(uint64_t i=0; i<size; i++)
+		values[i] = std::sin(0.01*i + 0.1*time) + 0.001*time;
+
+	uint32_t version = 1;
+	uint32_t fileSize = (uint32_t) (16 + size*sizeof(double));
+	std::ofstream vec(filename, std::ios::binary);
+	vec.write((const char*) &version, sizeof(version));
+	vec.write((const char*) &fileSize, sizeof(fileSize));
+	vec.write((const char*) &size, sizeof(size));
+	vec.write((const char*) values.data(), size*sizeof(double));
+	if(!vec.good())
+		return false;
+
+	std::string commandline = "";
+	std::string lua = "function LoadTheCheckpoint()\ncheckpoint = checkpoint or {}\n";
+	lua += "\tcheckpoint[\"ugargv\"] = \tcheckpoint[\"ugargv\"] or {}\n";
+	for(int i=0; i<argc; i++)
+	{
+		lua += "\t\tcheckpoint[\"ugargv\"][" + std::to_string(i+1) + "] = \"" + argv[i] + "\"\n";
+		commandline += std::string(argv[i]) + " ";
+	}
+	lua += "\tcheckpoint[\"lastFilename\"] = \"" + filename + "\"\n";
+	lua += "\tcheckpoint[\"lastId\"] = \"" + id + "\"\n";
+	lua += "\tcheckpoint[\"commandline\"] = \"" + commandline + "\"\n";
+	lua += "\tcheckpoint[\"ugargc\"] = " + std::to_string(argc) + "\n";
+	lua += "\tcheckpoint[\"stdData\"] = \tcheckpoint[\"stdData\"] or {}\n";
+	lua += "\t\tcheckpoint[\"stdData\"][\"numCores\"] = 1\nreturn checkpoint\nend\n";
+
+	std::ofstream file("myCheckpoint.lua");
+	file << lua;
+	return file.good();
+}
+
+int main(int argc, char** argv)
+{
+	std::string script = fakeParam(argc, argv, "-ex", "");
+	std::string specPath = fakeParam(argc, argv, "-p", "");
+	if(script.empty() || specPath.empty())
+	{
+		std::cerr << "Usage: " << argv[0] << " -ex <Biogas.lua> -p <spec.lua> [-rate <rows/s>] [-dt <h>]"
+			<< " [-series <n>] [-checkpoint <n>] [-vecsize <n>] [-chatter <n>] [-shared <name>]" << std::endl;
+		return 1;
+	}
+	double rate = std::atof(fakeParam(argc, argv, "-rate", "10").c_str());
+	double dt = std::atof(fakeParam(argc, argv, "-dt", "0.2").c_str());
+	int numSeries = std::atoi(fakeParam(argc, argv, "-series", "0").c_str());
+	int checkpointSteps = std::atoi(fakeParam(argc, argv, "-checkpoint", "0").c_str());
+	long long vecSize = std::atoll(fakeParam(argc, argv, "-vecsize", "1024").c_str());
+	int chatter = std::atoi(fakeParam(argc, argv, "-chatter", "1").c_str());
+	std::string sharedName = fakeParam(argc, argv, "-shared", "");
+	if(dt <= 0 || numSeries < 0 || vecSize < 0)
+	{
+		std::cerr << "Invalid arguments" << std::endl;
+		return 1;
+	}
+
+	std::string input;
+	SpecTree tree;
+	if(!readSpecFile(specPath, input) || !tree.parse(input))
+	{
+		std::cerr << "ERROR: Could not load " << specPath << std::endl;
+		return 1;
+	}
+	if(chatter > 0)
+		std::cout << "LOADED " << specPath << std::endl << "Start of Biogas-MAIN" << std::endl;
+
+	double startTime = fakeSpecNumber(tree, "problem.numericalSetup.sim_starttime", 0);
+	double endTime = fakeSpecNumber(tree, "problem.numericalSetup.sim_endtime", 10);
+
+	const SpecNode* problem = tree.find("problem");
+	std::string settings = "pSettings = ";
+	if(problem != nullptr)
+	{
+		SpecNode node = *problem;
+		node.key = "";
+		node.write(settings, 0);
+	}
+	else
+		settings += "{}";
+	std::ofstream settingsFile("problemSettings.lua");
+	settingsFile << settings << "\n";
+	if(!settingsFile.good())
+	{
+		std::cerr << "ERROR: Could not write problemSettings.lua" << std::endl;
+		return 1;
+	}
+
+	FakeOutputFile reactorState, cumulative, hourly, synthetic;
+	reactorState.key = "reactorState";
+	reactorState.filename = "reactorState.txt";
+	reactorState.columns = {"FOS", "COD", "pH"};
+	reactorState.units = {"g/L", "g/L", "1"};
+	cumulative.key = "producedNormVolumeCumulative";
+	cumulative.filename = "producedNormVolumeCumulative.txt";
+	cumulative.columns = {"Methane", "Carbondioxide", "Sum"};
+	cumulative.units = {"NL", "NL", "NL"};
+	hourly.key = "producedNormVolumeHourly";
+	hourly.filename = "producedNormVolumeHourly.txt";
+	hourly.columns = cumulative.columns;
+	hourly.units = cumulative.units;
+	synthetic.key = "dbg_synthetic";
+	synthetic.filename = "dbg_synthetic.txt";
+	for(int i=0; i<numSeries; i++)
+	{
+		synthetic.columns.push_back("Series" + std::to_string(i+1));
+		synthetic.units.push_back("1");
+	}
+
+	std::vector<FakeOutputFile*> files = {&reactorState, &cumulative, &hourly};
+	if(numSeries > 0)
+		files.push_back(&synthetic);
+	int numColumns = 1;
+	for(FakeOutputFile* info : files)
+	{
+		info->file.open(info->filename, std::ios::trunc);
+		info->file.precision(14);
+		info->file << "# Time [h]";
+		for(std::size_t c=0; c<info->columns.size(); c++)
+			info->file << "\t" << info->columns[c] << " [" << info->units[c] << "]";
+		info->file << "\n";
+		info->file.flush();
+		if(!info->file.good())
+		{
+			std::cerr << "ERROR: Could not write " << info->filename << std::endl;
+			return 1;
+		}
+		numColumns += info->columns.size();
+	}
+	if(!writeFakeOutputFiles(files))
+	{
+		std::cerr << "ERROR: Could not write outputFiles.lua" << std::endl;
+		return 1;
+	}
+
+	SharedSeries shared;
+	if(!sharedName.empty() && !shared.create(sharedName, numColumns, 4096))
+	{
+		std::cerr << "ERROR: Could not create the shared series " << sharedName << std::endl;
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<double> row(numColumns);
+	double methane = 0, carbondioxide = 0;
+	long long numSteps = (long long) std::ceil((endTime - startTime) / dt - 1e-9);
+	for(long long step = 1; step <= numSteps; step++)
+	{
+		if(rate > 0)
+			std::this_thread::sleep_until(start + std::chrono::duration<double>(step / rate));
+
+		double time = std::min(endTime, startTime + step*dt);
+		if(chatter > 0)
+		{
+			std::cout << "++++++ TIMESTEP " << step << " BEGIN (current time: " << time << ") ++++++\n";
+			for(int i=1; i<chatter; i++)
+				std::cout << "    % Newton step " << i << ": defect " << std::exp(-3.0*i) << "\n";
+			std::cout.flush();
+		}
+
+		double hourlyMethane = 1.5 + std::sin(0.25*time) + 0.5*std::exp(-0.05*time);
+		double hourlyCarbondioxide = 0.6 + 0.3*std::cos(0.25*time);
+		methane += hourlyMethane * dt;
+		carbondioxide += hourlyCarbondioxide * dt;
+
+		std::vector<double> values = {
+			1.2 + 0.4*std::sin(0.1*time), 1.25 - 0.05*std::cos(0.07*time), 7.4 + 0.6*std::exp(-0.02*time),
+			methane, carbondioxide, methane + carbondioxide,
+			hourlyMethane, hourlyCarbondioxide, hourlyMethane + hourlyCarbondioxide};
+		for(int i=0; i<numSeries; i++)
+			values.push_back(std::sin(0.05*(i+1)*time + i));
+
+		row[0] = time;
+		std::size_t col = 0;
+		for(FakeOutputFile* info : files)
+		{
+			info->file << time;
+			for(std::size_t c=0; c<info->columns.size(); c++, col++)
+			{
+				info->file << "\t" << values[col];
+				row[col+1] = values[col];
+			}
+			info->file << "\n";
+			info->file.flush();
+		}
+		if(!sharedName.empty())
+			shared.publish(row.data());
+
+		if(checkpointSteps > 0 && step % checkpointSteps == 0 && step < numSteps)
+			writeFakeCheckpoint(std::to_string(step), time, vecSize, argc, argv);
+	}
+
+	writeFakeCheckpoint("SimulationEnd", endTime, vecSize, argc, argv);
+	if(!sharedName.empty())
+		shared.close();
+	if(chatter > 0)
+		std::cout << "End of Biogas-MAIN" << std::endl;
+	return 0;
+}
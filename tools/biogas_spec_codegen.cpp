@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "../spec_vali_reader/biogas_spec_vali_reader.cpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <iostream>
+
+/**
+ * Code generator for typed specification structs
+ *
+ * Reads a validation file and writes a header with a struct tree of
+ * the specification (one nested struct per folder, one typed field
+ * per parameter) and a source with its parser and validator:
+ *
+ *   biogas_spec_codegen <vali.lua> <output base> [struct name]
+ *
+ * writes "<output base>.h" and "<output base>.cpp". Types map to
+ * double, int, bool, std::string, std::vector<std::string> and
+ * SpecTimeTable (time tables). Defaults and ranges of the validation
+ * file become compile-time constants, so a default or range which
+ * does not fit the type fails when the generated code is compiled.
+ */
+
+/**
+ * C++ identifier for a key of the validation file
+ *
+ * @param key: The key (LeftCell)
+ * @return The identifier
+ */
+static std::string codegenIdentifier(const std::string& key)
+{
+	static const std::set<std::string> keywords = {"auto", "bool", "break", "case", "char", "class",
+		"const", "continue", "default", "delete", "do", "double", "else", "enum", "explicit", "extern",
+		"false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "namespace", "new",
+		"operator", "private", "protected", "public", "register", "return", "short", "signed", "sizeof",
+		"static", "struct", "switch", "template", "this", "throw", "true", "try", "typedef", "typename",
+		"union", "unsigned", "using", "virtual", "void", "volatile", "while"};
+
+	std::string identifier = plainSpecKey(key);
+	for(char& c : identifier)
+		if(!isalnum(c) && c != '_')
+			c = '_';
+	if(identifier.empty() || isdigit(identifier[0]))
+		identifier = "_" + identifier;
+	if(keywords.count(identifier) > 0)
+		identifier += "_";
+	return identifier;
+}
+
+/**
+ * C++ type of a parameter
+ *
+ * @param type: Type in the validation file
+ * @return The C++ type or "" if the type is unknown
+ */
+static std::string codegenType(const std::string& type)
+{
+	if(type == "Double")
+		return "double";
+	if(type == "Integer")
+		return "int";
+	if(type == "Boolean")
+		return "bool";
+	if(type == "String")
+		return "std::string";
+	if(type == "String[]")
+		return "std::vector<std::string>";
+	return "";
+}
+
+/**
+ * Initializer of a field from the default of the validation file
+ *
+ * Numbers and booleans are written as they are, so an invalid
+ * default fails to compile.
+ *
+ * @param type: Type in the validation file
+ * @param defaultVal: The default
+ * @return The initializer
+ */
+static std::string codegenDefault(const std::string& type, const std::string& defaultVal)
+{
+	if(type == "String")
+		return "\"" + defaultVal + "\"";
+	if(type == "String[]")
+		return defaultVal.empty() ? "{}" : "{\"" + defaultVal + "\"}";
+	if(defaultVal.empty())
+		return type == "Boolean" ? "false" : "0";
+	return defaultVal;
+}
+
+/**
+ * Default of the rows of a table in the validation file
+ *
+ * The reader passes the last default it has read on to the rows of a
+ * table ("values" of "tableContent"). If the folder of the table has
+ * no default, that is the default of an earlier parameter, so the
+ * default is looked up in the folder itself.
+ *
+ * @param vali: The parsed validation file
+ * @param rowPath: Path of the row
+ * @return The default of the folder ("" if it has none)
+ */
+static std::string codegenTableDefault(const SpecTree& vali, const std::string& rowPath)
+{
+	const SpecNode* folder = vali.find(rowPath.substr(0, rowPath.find_last_of('.')));
+	const SpecNode* node = (folder == nullptr) ? nullptr : folder->child("default");
+	if(node == nullptr)
+		return "";
+	std::string defaultVal = node->value;
+	boost::replace_all(defaultVal, "\"", "");
+	return defaultVal;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " <vali.lua> <output base> [struct name]" << std::endl;
+		return 1;
+	}
+
+	std::string base = argv[2];
+	std::string include = base.substr(base.find_last_of('/') == std::string::npos ? 0 : base.find_last_of('/')+1);
+	std::string structName = argc > 3 ? argv[3] : codegenIdentifier(include);
+
+	BiogasSpecValiReader reader;
+	std::string valiInput;
+	SpecTree vali;
+	if(!reader.init_Vali(argv[1]) || !readSpecFile(argv[1], valiInput) || !vali.parse(valiInput))
+	{
+		std::cerr << "Could not read the validation file " << argv[1] << std::endl;
+		return 1;
+	}
+
+	BiogasResultBuffer* buffer = reader.createValiBuffer();
+	const BiogasValiRecord* records = (const BiogasValiRecord*) ((const char*) buffer + buffer->recordsOffset);
+	const char* arena = (const char*) buffer + buffer->arenaOffset;
+	std::vector<std::string> paths = reader.entryPaths();
+	int numRecords = buffer->numRecords;
+
+	std::string header = "";
+	std::string parser = "";
+	std::string validator = "";
+	std::vector<std::string> scopes = {"this->"};
+	std::vector<int> indents = {};
+
+	header += "/*\n * Generated by biogas_spec_codegen from " + std::string(argv[1]) + "\n * Do not edit.\n */\n\n";
+	header += "#pragma once\n#include \"spec_vali_reader/spec_fields.h\"\n#include <string>\n#include <vector>\n\n";
+	header += "struct " + structName + " {\n";
+
+	for(int i=0; i<=numRecords; i++)
+	{
+		int indent = (i < numRecords) ? records[i].indent : -1;
+		while(!indents.empty() && indent <= indents.back())
+		{
+			std::string member = scopes.back().substr(scopes[scopes.size()-2].size());
+			member = member.substr(0, member.size()-1);
+			indents.pop_back();
+			scopes.pop_back();
+			header += std::string(indents.size()+1, '\t') + "} " + member + ";\n";
+		}
+		if(i == numRecords)
+			break;
+
+		std::string leftCell = arena + records[i].leftCell.offset;
+		std::string type = arena + records[i].type.offset;
+		std::string defaultVal = (leftCell[0] == '"') ? codegenTableDefault(vali, paths[i])
+			: std::string(arena + records[i].defaultVal.offset);
+		std::string rangeMin = arena + records[i].rangeMin.offset;
+		std::string rangeMax = arena + records[i].rangeMax.offset;
+		std::string name = codegenIdentifier(leftCell);
+		std::string tabs(indents.size()+1, '\t');
+		std::string field = scopes.back() + name;
+
+		if(leftCell == "timeTableContent")
+			continue;
+
+		bool timeTable = i+1 < numRecords && std::string(arena + records[i+1].leftCell.offset) == "timeTableContent";
+		if(records[i].glyph == 15 && !timeTable)
+		{
+			std::string typeName = name;
+			typeName[0] = toupper(typeName[0]);
+			header += tabs + "struct " + typeName + "Section {\n";
+			indents.push_back(records[i].indent);
+			scopes.push_back(field + ".");
+			continue;
+		}
+
+		parser += "\tvalid = parseSpecField(tree, \"" + paths[i] + "\", " + field + ") && valid;\n";
+		if(timeTable)
+		{
+			header += tabs + "SpecTimeTable " + name + ";\n";
+			validator += "\tvalid = checkSpecTimeTable(" + field + ", \"" + name + "\", message) && valid;\n";
+			continue;
+		}
+
+		std::string cppType = codegenType(type);
+		if(cppType.empty())
+		{
+			std::cerr << "Unknown type \"" << type << "\" of " << paths[i] << std::endl;
+			std::free(buffer);
+			return 1;
+		}
+		header += tabs + cppType + " " + name + " = " + codegenDefault(type, defaultVal) + ";\n";
+
+		if((type == "Double" || type == "Integer") && !rangeMin.empty() && !rangeMax.empty())
+		{
+			header += tabs + "static constexpr double " + name + "_min = " + rangeMin + ";\n";
+			header += tabs + "static constexpr double " + name + "_max = " + rangeMax + ";\n";
+			header += tabs + "static_assert(" + name + "_min <= " + name + "_max, \"invalid range of " + paths[i] + "\");\n";
+			validator += "\tvalid = checkSpecRange(" + field + ", " + field + "_min, " + field + "_max, \"" + name + "\", message) && valid;\n";
+		}
+	}
+	std::free(buffer);
+
+	header += "\n\tbool parse(const std::string& filepath);\n";
+	header += "\tbool validate(std::string& message) const;\n";
+	header += "};\n";
+
+	std::string source = "/*\n * Generated by biogas_spec_codegen from " + std::string(argv[1]) + "\n * Do not edit.\n */\n\n";
+	source += "#include \"" + include + ".h\"\n#include \"spec_vali_reader/spec_tree.h\"\n#include <string>\n\n";
+	source += "/**\n * Read a specification file\n *\n * Parameters missing in the file keep their defaults.\n *\n";
+	source += " * @param filepath: The absolute path to the specification file\n";
+	source += " * @return Bool if the file could be read and all parameters have the correct type\n */\n";
+	source += "bool " + structName + "::\nparse(const std::string& filepath)\n{\n";
+	source += "\tstd::string input;\n\tSpecTree tree;\n";
+	source += "\tif(!readSpecFile(filepath, input) || !tree.parse(input))\n\t\treturn false;\n\n";
+	source += "\tbool valid = true;\n" + parser + "\treturn valid;\n}\n\n";
+	source += "/**\n * Validate the ranges and time tables\n *\n";
+	source += " * @param message: Message to append all errors to\n * @return Bool whether the specification is valid\n */\n";
+	source += "bool " + structName + "::\nvalidate(std::string& message) const\n{\n";
+	source += "\tbool valid = true;\n" + validator + "\treturn valid;\n}\n";
+
+	std::ofstream headerFile(base + ".h");
+	std::ofstream sourceFile(base + ".cpp");
+	headerFile << header;
+	sourceFile << source;
+	if(!headerFile.good() || !sourceFile.good())
+	{
+		std::cerr << "Could not write " << base << ".h/.cpp" << std::endl;
+		return 1;
+	}
+	return 0;
+}
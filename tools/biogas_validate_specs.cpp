@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020:  G-CSC, Goethe University Frankfurt
+ * Author: Paul Zügel
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "../spec_vali_reader/biogas_spec_vali_reader.cpp"
+#include "../spec_vali_reader/biogas_spec_validation.cpp"
+#include "../spec_vali_reader/biogas_spec_batch.cpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+/**
+ * Batch validation of specification files
+ *
+ * Parses the validation file once and checks all specification files
+ * in parallel (see BiogasSpecValiReader::validateSpecBatch()):
+ *
+ *   biogas_validate_specs <vali.lua> [-o <report>] [-l <list>] [spec.lua ...]
+ *
+ * "-l" reads the paths of further specification files from a file
+ * (one per line). The report is written to "-o" or to stdout.
+ * Exit code: 0 if all files are valid, 1 if not, 2 for wrong arguments
+ * or an unreadable validation file.
+ */
+
+int main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <vali.lua> [-o <report>] [-l <list>] [spec.lua ...]" << std::endl;
+		return 2;
+	}
+
+	std::string reportFile = "";
+	std::vector<std::string> files;
+	for(int i=2; i<argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "-o" || arg == "-l") && i+1 == argc)
+		{
+			std::cerr << "Missing value of " << arg << std::endl;
+			return 2;
+		}
+		if(arg == "-o")
+			reportFile = argv[++i];
+		else if(arg == "-l")
+		{
+			std::ifstream list(argv[++i]);
+			if(!list.good())
+			{
+				std::cerr << "Could not read the list " << argv[i] << std::endl;
+				return 2;
+			}
+			for(std::string line; std::getline(list, line); )
+				if(!line.empty())
+					files.push_back(line);
+		}
+		else
+			files.push_back(arg);
+	}
+
+	BiogasSpecValiReader reader;
+	if(!reader.init_Vali(argv[1]))
+	{
+		std::cerr << "Could not read the validation file " << argv[1] << std::endl;
+		return 2;
+	}
+
+	bool valid = reader.validateSpecBatch(files, reportFile);
+	if(reportFile.empty())
+		std::cout << reader.batchReport;
+	return valid ? 0 : 1;
+}